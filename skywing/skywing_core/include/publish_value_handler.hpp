@@ -3,10 +3,19 @@
 
 #include "message_format.capnp.h"
 
+#include "skywing_core/internal/utility/quantize.hpp"
+#include "skywing_core/internal/wire_features.hpp"
+#include "skywing_core/types.hpp"
+
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <optional>
+#include <string>
+#include <type_traits>
 #include <vector>
+
 namespace skywing::internal::detail {
 // For recursing below, I feel like there's a better way of doing this, but I can't think of it.
 template<typename T>
@@ -30,28 +39,269 @@ std::vector<To> list_to_vector(const From& values) noexcept
   return to_ret;
 }
 
+// Numeric types whose vectors can be sent as a raw array
+template<typename T>
+struct RawArrayElement : std::false_type {};
+
+#define SKYNET_MAKE_RAW_ARRAY_ELEMENT(cpp_type, capn_enum)                 \
+  template<>                                                               \
+  struct RawArrayElement<cpp_type> : std::true_type {                      \
+    static constexpr auto type = cpnpro::RawArrayType::capn_enum;          \
+  }
+
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(double, F64);
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(float, F32);
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(std::int8_t, I8);
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(std::int16_t, I16);
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(std::int32_t, I32);
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(std::int64_t, I64);
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(std::uint8_t, U8);
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(std::uint16_t, U16);
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(std::uint32_t, U32);
+SKYNET_MAKE_RAW_ARRAY_ELEMENT(std::uint64_t, U64);
+
+#undef SKYNET_MAKE_RAW_ARRAY_ELEMENT
+
+// The largest raw array that fits in a Cap'n Proto Data field; anything larger has to go as a list
+inline constexpr std::size_t max_raw_array_bytes = (std::size_t{1} << 29) - 1;
+
+// Returns true if the values should be sent as a raw array
+template<typename T>
+bool can_send_as_raw_array(const std::vector<T>& values) noexcept
+{
+  if constexpr (RawArrayElement<T>::value) { return values.size() <= max_raw_array_bytes / sizeof(T); }
+  else {
+    return false;
+  }
+}
+
+// Writes numeric elements as a single block of memory
+// The bytes are sent as they are in memory, so this must only be used on little-endian machines
+template<typename T>
+void set_raw_array(cpnpro::PublishValue::Builder& b, const T* const values, const std::size_t size) noexcept
+{
+  static_assert(RawArrayElement<T>::value, "Type can't be sent as a raw array");
+  auto raw = b.initRawArray();
+  raw.setElementType(RawArrayElement<T>::type);
+  auto data = raw.initData(size * sizeof(T));
+  std::memcpy(data.begin(), values, data.size());
+}
+
+template<typename T>
+void set_raw_array(cpnpro::PublishValue::Builder& b, const std::vector<T>& values) noexcept
+{
+  set_raw_array(b, values.data(), values.size());
+}
+
+// Reads a raw array into a vector, returning false if it holds a different type
+template<typename T>
+bool raw_array_into(const cpnpro::RawArray::Reader& r, std::vector<T>& out) noexcept
+{
+  if constexpr (RawArrayElement<T>::value) {
+    const auto data = r.getData();
+    if (r.getElementType() != RawArrayElement<T>::type || data.size() % sizeof(T) != 0) { return false; }
+    out.resize(data.size() / sizeof(T));
+    std::memcpy(out.data(), data.begin(), data.size());
+    return true;
+  }
+  else {
+    (void)r;
+    (void)out;
+    return false;
+  }
+}
+
+// Writes the elements of a numeric vector that differ from the previous value
+// Returns false without writing anything if sending the whole vector would be as small
+template<typename T>
+bool set_vector_delta(
+  cpnpro::PublishValue::Builder& b, const std::vector<T>& values, const std::vector<T>& previous) noexcept
+{
+  if constexpr (RawArrayElement<T>::value) {
+    if (values.size() != previous.size() || !can_send_as_raw_array(values)) { return false; }
+    // Compared bitwise so that the receiver ends up with exactly the same value
+    std::vector<std::uint32_t> changed;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      if (std::memcmp(&values[i], &previous[i], sizeof(T)) != 0) { changed.push_back(static_cast<std::uint32_t>(i)); }
+    }
+    if (changed.size() * (sizeof(T) + sizeof(std::uint32_t)) >= values.size() * sizeof(T)) { return false; }
+    auto delta = b.initVectorDelta();
+    delta.setElementType(RawArrayElement<T>::type);
+    delta.setSize(static_cast<std::uint32_t>(values.size()));
+    auto indices = delta.initIndices(changed.size());
+    auto data = delta.initData(changed.size() * sizeof(T));
+    for (std::size_t i = 0; i < changed.size(); ++i) {
+      indices.set(i, changed[i]);
+      std::memcpy(data.begin() + i * sizeof(T), &values[changed[i]], sizeof(T));
+    }
+    return true;
+  }
+  else {
+    (void)b;
+    (void)values;
+    (void)previous;
+    return false;
+  }
+}
+
+// Applies the changed elements to the previous value, returning false if they don't fit it
+template<typename T>
+bool apply_vector_delta(const cpnpro::VectorDelta::Reader& r, std::vector<T>& value) noexcept
+{
+  if constexpr (RawArrayElement<T>::value) {
+    const auto indices = r.getIndices();
+    const auto data = r.getData();
+    if (
+      r.getElementType() != RawArrayElement<T>::type || r.getSize() != value.size()
+      || data.size() != indices.size() * sizeof(T)) {
+      return false;
+    }
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+      const auto index = indices[i];
+      if (index >= value.size()) { return false; }
+      std::memcpy(&value[index], data.begin() + i * sizeof(T), sizeof(T));
+    }
+    return true;
+  }
+  else {
+    (void)r;
+    (void)value;
+    return false;
+  }
+}
+
+// Maps the lossy encodings to their wire values; none is never sent
+constexpr cpnpro::QuantizedEncoding to_wire_encoding(const Quantization quantization) noexcept
+{
+  switch (quantization) {
+  case Quantization::bfloat16:
+    return cpnpro::QuantizedEncoding::BFLOAT16;
+  case Quantization::scaled_int8:
+    return cpnpro::QuantizedEncoding::SCALED_INT8;
+  case Quantization::scaled_int16:
+    return cpnpro::QuantizedEncoding::SCALED_INT16;
+  case Quantization::none:
+  case Quantization::float16:
+    break;
+  }
+  return cpnpro::QuantizedEncoding::FLOAT16;
+}
+
+inline std::optional<Quantization> from_wire_encoding(const cpnpro::QuantizedEncoding encoding) noexcept
+{
+  switch (encoding) {
+  case cpnpro::QuantizedEncoding::FLOAT16:
+    return Quantization::float16;
+  case cpnpro::QuantizedEncoding::BFLOAT16:
+    return Quantization::bfloat16;
+  case cpnpro::QuantizedEncoding::SCALED_INT8:
+    return Quantization::scaled_int8;
+  case cpnpro::QuantizedEncoding::SCALED_INT16:
+    return Quantization::scaled_int16;
+  }
+  return std::nullopt;
+}
+
+// Writes a floating point vector with a lossy encoding
+// Returns false without writing anything if the encoding can't represent the values
+template<typename T>
+bool set_quantized_array(
+  cpnpro::PublishValue::Builder& b, const std::vector<T>& values, const Quantization quantization) noexcept
+{
+  if constexpr (std::is_floating_point_v<T> && RawArrayElement<T>::value) {
+    if (!can_send_as_raw_array(values)) { return false; }
+    const auto encoded = quantize(values, quantization);
+    if (!encoded) { return false; }
+    auto quantized = b.initQuantizedArray();
+    quantized.setElementType(RawArrayElement<T>::type);
+    quantized.setEncoding(to_wire_encoding(quantization));
+    quantized.setScale(encoded->scale);
+    quantized.setOffset(encoded->offset);
+    auto data = quantized.initData(encoded->data.size());
+    std::memcpy(data.begin(), encoded->data.data(), data.size());
+    return true;
+  }
+  else {
+    (void)b;
+    (void)values;
+    (void)quantization;
+    return false;
+  }
+}
+
+// Expands a vector sent with a lossy encoding, returning false if it holds a different type
+template<typename T>
+bool quantized_array_into(const cpnpro::QuantizedArray::Reader& r, std::vector<T>& out) noexcept
+{
+  if constexpr (std::is_floating_point_v<T> && RawArrayElement<T>::value) {
+    const auto quantization = from_wire_encoding(r.getEncoding());
+    if (r.getElementType() != RawArrayElement<T>::type || !quantization) { return false; }
+    const auto data = r.getData();
+    const gsl::span<const std::byte> bytes{
+      reinterpret_cast<const std::byte*>(data.begin()), static_cast<gsl::index>(data.size())};
+    return dequantize(bytes, *quantization, r.getScale(), r.getOffset(), out);
+  }
+  else {
+    (void)r;
+    (void)out;
+    return false;
+  }
+}
+
 // Mapping for the publish data to retrieve things from it as a template
 template<typename T>
 struct PublishValueHandler;
 
 // Create a mapping for a type and a vector of that type
-#define SKYNET_MAKE_PUBLISH_VALUE_HANDLER(cpp_type, capn_suffix)                                                     \
+// Each handler also provides the union tag that it corresponds to on the wire, and
+// get_into for decoding into existing storage so that a vector's capacity can be reused
+#define SKYNET_MAKE_PUBLISH_VALUE_HANDLER(cpp_type, capn_suffix, capn_which)                                         \
   template<>                                                                                                         \
   struct PublishValueHandler<cpp_type> {                                                                             \
+    static constexpr auto which = cpnpro::PublishValue::Which::capn_which;                                           \
     static std::optional<cpp_type> get(const cpnpro::PublishValue::Reader& r) noexcept                               \
     {                                                                                                                \
       if (!r.is##capn_suffix()) { return {}; }                                                                       \
       return r.get##capn_suffix();                                                                                   \
     }                                                                                                                \
+    static bool get_into(const cpnpro::PublishValue::Reader& r, cpp_type& out) noexcept                              \
+    {                                                                                                                \
+      if (!r.is##capn_suffix()) { return false; }                                                                    \
+      out = r.get##capn_suffix();                                                                                    \
+      return true;                                                                                                   \
+    }                                                                                                                \
     static void set(cpnpro::PublishValue::Builder& b, const cpp_type& value) noexcept { b.set##capn_suffix(value); } \
   };                                                                                                                 \
   template<>                                                                                                         \
   struct PublishValueHandler<std::vector<cpp_type>> {                                                                \
+    static constexpr auto which = cpnpro::PublishValue::Which::R_##capn_which;                                       \
     static std::optional<std::vector<cpp_type>> get(const cpnpro::PublishValue::Reader& r) noexcept                  \
     {                                                                                                                \
+      if (r.isRawArray()) {                                                                                          \
+        std::vector<cpp_type> to_ret;                                                                                \
+        if (!raw_array_into(r.getRawArray(), to_ret)) { return {}; }                                                 \
+        return to_ret;                                                                                               \
+      }                                                                                                              \
+      if (r.isQuantizedArray()) {                                                                                    \
+        std::vector<cpp_type> to_ret;                                                                                \
+        if (!quantized_array_into(r.getQuantizedArray(), to_ret)) { return {}; }                                     \
+        return to_ret;                                                                                               \
+      }                                                                                                              \
       if (!r.isR##capn_suffix()) { return {}; }                                                                      \
       return list_to_vector<cpp_type>(r.getR##capn_suffix());                                                        \
     }                                                                                                                \
+    static bool get_into(const cpnpro::PublishValue::Reader& r, std::vector<cpp_type>& out) noexcept                 \
+    {                                                                                                                \
+      if (r.isRawArray()) { return raw_array_into(r.getRawArray(), out); }                                           \
+      if (r.isQuantizedArray()) { return quantized_array_into(r.getQuantizedArray(), out); }                         \
+      if (!r.isR##capn_suffix()) { return false; }                                                                   \
+      const auto values = r.getR##capn_suffix();                                                                     \
+      out.resize(values.size());                                                                                     \
+      for (std::size_t i = 0; i < values.size(); ++i) {                                                              \
+        out[i] = values[i];                                                                                          \
+      }                                                                                                              \
+      return true;                                                                                                   \
+    }                                                                                                                \
     static void set(cpnpro::PublishValue::Builder& b, const std::vector<cpp_type>& values) noexcept                  \
     {                                                                                                                \
       auto serialized_data = b.initR##capn_suffix(values.size());                                                    \
@@ -61,39 +311,59 @@ struct PublishValueHandler;
     }                                                                                                                \
   }
 
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(double, D);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(float, F);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::int8_t, I8);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::int16_t, I16);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::int32_t, I32);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::int64_t, I64);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::uint8_t, U8);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::uint16_t, U16);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::uint32_t, U32);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::uint64_t, U64);
-SKYNET_MAKE_PUBLISH_VALUE_HANDLER(bool, Bool);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(double, D, D);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(float, F, F);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::int8_t, I8, I8);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::int16_t, I16, I16);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::int32_t, I32, I32);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::int64_t, I64, I64);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::uint8_t, U8, U8);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::uint16_t, U16, U16);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::uint32_t, U32, U32);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(std::uint64_t, U64, U64);
+SKYNET_MAKE_PUBLISH_VALUE_HANDLER(bool, Bool, BOOL);
 
 #undef SKYNET_MAKE_PUBLISH_VALUE_HANDLER
 
 // String is a little bit different
 template<>
 struct PublishValueHandler<std::string> {
+  static constexpr auto which = cpnpro::PublishValue::Which::STR;
   static std::optional<std::string> get(const cpnpro::PublishValue::Reader& r) noexcept
   {
     if (!r.isStr()) { return {}; }
     return r.getStr();
   }
+  static bool get_into(const cpnpro::PublishValue::Reader& r, std::string& out) noexcept
+  {
+    if (!r.isStr()) { return false; }
+    const auto str = r.getStr();
+    out.assign(str.cStr(), str.size());
+    return true;
+  }
   static void set(cpnpro::PublishValue::Builder& b, const std::string& value) noexcept { b.setStr(value); }
 };
 
 template<>
 struct PublishValueHandler<std::vector<std::string>> {
+  static constexpr auto which = cpnpro::PublishValue::Which::R_STR;
   static std::optional<std::vector<std::string>> get(const cpnpro::PublishValue::Reader& r) noexcept
   {
     if (!r.isRStr()) { return {}; }
     return list_to_vector<std::string>(r.getRStr());
   }
 
+  static bool get_into(const cpnpro::PublishValue::Reader& r, std::vector<std::string>& out) noexcept
+  {
+    if (!r.isRStr()) { return false; }
+    const auto values = r.getRStr();
+    out.resize(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      out[i].assign(values[i].cStr(), values[i].size());
+    }
+    return true;
+  }
+
   static void set(cpnpro::PublishValue::Builder& b, const std::vector<std::string>& values) noexcept
   {
     auto serialized_data = b.initRStr(values.size());
@@ -106,6 +376,7 @@ struct PublishValueHandler<std::vector<std::string>> {
 // Bytes are different as well
 template<>
 struct PublishValueHandler<std::vector<std::byte>> {
+  static constexpr auto which = cpnpro::PublishValue::Which::BYTES;
   static std::optional<std::vector<std::byte>> get(const cpnpro::PublishValue::Reader& r) noexcept
   {
     if (!r.isBytes()) { return {}; }
@@ -114,12 +385,87 @@ struct PublishValueHandler<std::vector<std::byte>> {
       reinterpret_cast<const std::byte*>(bytes.begin()), reinterpret_cast<const std::byte*>(bytes.end())};
   }
 
+  static bool get_into(const cpnpro::PublishValue::Reader& r, std::vector<std::byte>& out) noexcept
+  {
+    if (!r.isBytes()) { return false; }
+    const auto bytes = r.getBytes();
+    out.resize(bytes.size());
+    std::memcpy(out.data(), bytes.begin(), bytes.size());
+    return true;
+  }
+
   static void set(cpnpro::PublishValue::Builder& b, const std::vector<std::byte>& values) noexcept
   {
     auto serialized_data = b.initBytes(values.size());
     std::memcpy(serialized_data.begin(), values.data(), values.size());
   }
 };
+
+// Writes a value with the most compact encoding the receiver supports, short
+// of sending the changes from a previous value
+template<typename T>
+void set_value(
+  cpnpro::PublishValue::Builder& b, const T& value, const WireFeatures features, const Quantization quantization) noexcept
+{
+  if constexpr (IsVector<T>::value) {
+    if (
+      (features & wire_feature::quantized_arrays) && quantization != Quantization::none
+      && set_quantized_array(b, value, quantization)) {
+      return;
+    }
+    if ((features & wire_feature::raw_arrays) && can_send_as_raw_array(value)) {
+      set_raw_array(b, value);
+      return;
+    }
+  }
+  PublishValueHandler<T>::set(b, value);
+}
+
+// A rough upper bound on the bytes a value's contents take when encoded,
+// not counting the fixed size part of the value
+template<typename T>
+std::size_t encoded_data_size_guess(const T& value) noexcept
+{
+  if constexpr (std::is_same_v<T, std::string>) { return value.size(); }
+  else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+    std::size_t to_ret = 0;
+    for (const auto& str : value) {
+      to_ret += 2 * sizeof(capnp::word) + str.size();
+    }
+    return to_ret;
+  }
+  else if constexpr (std::is_same_v<T, std::vector<bool>>) { return value.size() / 8; }
+  else if constexpr (IsVector<T>::value) { return value.size() * sizeof(typename T::value_type); }
+  else {
+    (void)value;
+    return 0;
+  }
+}
+
+// The union tag on the wire for each index of PublishValueTypeList
+template<typename... Ts>
+constexpr std::array<cpnpro::PublishValue::Which, sizeof...(Ts)> make_wire_tags(TypeList<Ts...>) noexcept
+{
+  return {PublishValueHandler<Ts>::which...};
+}
+inline constexpr auto wire_tag_for_type_index = make_wire_tags(PublishValueTypeList{});
+
+// The raw array element type that can stand in for each index of PublishValueTypeList, if any
+template<typename T>
+constexpr std::optional<cpnpro::RawArrayType> raw_array_type_for() noexcept
+{
+  if constexpr (IsVector<T>::value) {
+    using Element = typename T::value_type;
+    if constexpr (RawArrayElement<Element>::value) { return RawArrayElement<Element>::type; }
+  }
+  return std::nullopt;
+}
+template<typename... Ts>
+constexpr std::array<std::optional<cpnpro::RawArrayType>, sizeof...(Ts)> make_raw_array_types(TypeList<Ts...>) noexcept
+{
+  return {raw_array_type_for<Ts>()...};
+}
+inline constexpr auto raw_array_type_for_type_index = make_raw_array_types(PublishValueTypeList{});
 } // namespace skywing::internal::detail
 
 #endif // SKYNET_SRC_PUBLISH_VALUE_HANDLER_HPP
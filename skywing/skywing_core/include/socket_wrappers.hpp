@@ -12,9 +12,9 @@
 #include <unistd.h>
 
 namespace skywing::internal {
-/** \brief Creates a socket in non-blocking mode
+/** \brief Creates a stream socket of the given domain in non-blocking mode
  */
-int create_non_blocking() noexcept;
+int create_non_blocking(int domain) noexcept;
 
 /** \brief Accepts on a socket and puts the connection in non-blocking mode
  */
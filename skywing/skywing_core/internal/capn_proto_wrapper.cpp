@@ -3,6 +3,8 @@
 #include "publish_value_handler.hpp"
 #include "skywing_core/internal/utility/logging.hpp"
 
+#include <new>
+
 namespace skywing::internal {
 namespace detail {
 /** \brief Class that supresses Cap'n Proto's exceptions so that they
@@ -37,6 +39,128 @@ template<typename T>
 using pvh = PublishValueHandler<T>;
 template<typename T>
 using pvh_v = PublishValueHandler<std::vector<T>>;
+
+template<typename T>
+std::optional<PublishValueVariant> raw_array_to_variant(const cpnpro::RawArray::Reader& reader) noexcept
+{
+  std::vector<T> to_ret;
+  if (!raw_array_into(reader, to_ret)) { return std::nullopt; }
+  return to_ret;
+}
+
+std::optional<PublishValueVariant> decode_raw_array(const cpnpro::RawArray::Reader& reader) noexcept
+{
+  using types = cpnpro::RawArrayType;
+  switch (reader.getElementType()) {
+  case types::F64:
+    return raw_array_to_variant<double>(reader);
+  case types::F32:
+    return raw_array_to_variant<float>(reader);
+  case types::I8:
+    return raw_array_to_variant<std::int8_t>(reader);
+  case types::I16:
+    return raw_array_to_variant<std::int16_t>(reader);
+  case types::I32:
+    return raw_array_to_variant<std::int32_t>(reader);
+  case types::I64:
+    return raw_array_to_variant<std::int64_t>(reader);
+  case types::U8:
+    return raw_array_to_variant<std::uint8_t>(reader);
+  case types::U16:
+    return raw_array_to_variant<std::uint16_t>(reader);
+  case types::U32:
+    return raw_array_to_variant<std::uint32_t>(reader);
+  case types::U64:
+    return raw_array_to_variant<std::uint64_t>(reader);
+  }
+  return std::nullopt;
+}
+
+template<typename T>
+std::optional<PublishValueVariant> quantized_array_to_variant(const cpnpro::QuantizedArray::Reader& reader) noexcept
+{
+  std::vector<T> to_ret;
+  if (!quantized_array_into(reader, to_ret)) { return std::nullopt; }
+  return to_ret;
+}
+
+std::optional<PublishValueVariant> decode_quantized_array(const cpnpro::QuantizedArray::Reader& reader) noexcept
+{
+  switch (reader.getElementType()) {
+  case cpnpro::RawArrayType::F64:
+    return quantized_array_to_variant<double>(reader);
+  case cpnpro::RawArrayType::F32:
+    return quantized_array_to_variant<float>(reader);
+  default:
+    return std::nullopt;
+  }
+}
+
+std::optional<PublishValueVariant> decode_value(cpnpro::PublishValue::Reader reader) noexcept
+{
+  // This is gross and I hate it, but...
+  using vals = cpnpro::PublishValue::Which;
+  switch (reader.which()) {
+  case vals::D:
+    return pvh<double>::get(reader);
+  case vals::R_D:
+    return pvh_v<double>::get(reader);
+  case vals::F:
+    return pvh<float>::get(reader);
+  case vals::R_F:
+    return pvh_v<float>::get(reader);
+  case vals::STR:
+    return pvh<std::string>::get(reader);
+  case vals::R_STR:
+    return pvh_v<std::string>::get(reader);
+  case vals::I8:
+    return pvh<std::int8_t>::get(reader);
+  case vals::I16:
+    return pvh<std::int16_t>::get(reader);
+  case vals::I32:
+    return pvh<std::int32_t>::get(reader);
+  case vals::I64:
+    return pvh<std::int64_t>::get(reader);
+  case vals::U8:
+    return pvh<std::uint8_t>::get(reader);
+  case vals::U16:
+    return pvh<std::uint16_t>::get(reader);
+  case vals::U32:
+    return pvh<std::uint32_t>::get(reader);
+  case vals::U64:
+    return pvh<std::uint64_t>::get(reader);
+  case vals::R_I8:
+    return pvh_v<std::int8_t>::get(reader);
+  case vals::R_I16:
+    return pvh_v<std::int16_t>::get(reader);
+  case vals::R_I32:
+    return pvh_v<std::int32_t>::get(reader);
+  case vals::R_I64:
+    return pvh_v<std::int64_t>::get(reader);
+  case vals::R_U8:
+    return pvh_v<std::uint8_t>::get(reader);
+  case vals::R_U16:
+    return pvh_v<std::uint16_t>::get(reader);
+  case vals::R_U32:
+    return pvh_v<std::uint32_t>::get(reader);
+  case vals::R_U64:
+    return pvh_v<std::uint64_t>::get(reader);
+  case vals::BYTES:
+    return pvh_v<std::byte>::get(reader);
+  case vals::BOOL:
+    return pvh<bool>::get(reader);
+  case vals::R_BOOL:
+    return pvh_v<bool>::get(reader);
+  case vals::RAW_ARRAY:
+    return decode_raw_array(reader.getRawArray());
+  case vals::VECTOR_DELTA:
+    // Can only be decoded against the previous value
+    return std::nullopt;
+  case vals::QUANTIZED_ARRAY:
+    return decode_quantized_array(reader.getQuantizedArray());
+  }
+  return std::nullopt;
+}
 } // namespace detail
 
 /////////////////////////////////////////////////////
@@ -45,68 +169,10 @@ using pvh_v = PublishValueHandler<std::vector<T>>;
 
 std::optional<std::vector<PublishValueVariant>> PublishData::value() const noexcept
 {
-  using namespace detail;
-  const auto decode_value = [](cpnpro::PublishValue::Reader reader) -> std::optional<PublishValueVariant> {
-    // This is gross and I hate it, but...
-    using vals = cpnpro::PublishValue::Which;
-    switch (reader.which()) {
-    case vals::D:
-      return pvh<double>::get(reader);
-    case vals::R_D:
-      return pvh_v<double>::get(reader);
-    case vals::F:
-      return pvh<float>::get(reader);
-    case vals::R_F:
-      return pvh_v<float>::get(reader);
-    case vals::STR:
-      return pvh<std::string>::get(reader);
-    case vals::R_STR:
-      return pvh_v<std::string>::get(reader);
-    case vals::I8:
-      return pvh<std::int8_t>::get(reader);
-    case vals::I16:
-      return pvh<std::int16_t>::get(reader);
-    case vals::I32:
-      return pvh<std::int32_t>::get(reader);
-    case vals::I64:
-      return pvh<std::int64_t>::get(reader);
-    case vals::U8:
-      return pvh<std::uint8_t>::get(reader);
-    case vals::U16:
-      return pvh<std::uint16_t>::get(reader);
-    case vals::U32:
-      return pvh<std::uint32_t>::get(reader);
-    case vals::U64:
-      return pvh<std::uint64_t>::get(reader);
-    case vals::R_I8:
-      return pvh_v<std::int8_t>::get(reader);
-    case vals::R_I16:
-      return pvh_v<std::int16_t>::get(reader);
-    case vals::R_I32:
-      return pvh_v<std::int32_t>::get(reader);
-    case vals::R_I64:
-      return pvh_v<std::int64_t>::get(reader);
-    case vals::R_U8:
-      return pvh_v<std::uint8_t>::get(reader);
-    case vals::R_U16:
-      return pvh_v<std::uint16_t>::get(reader);
-    case vals::R_U32:
-      return pvh_v<std::uint32_t>::get(reader);
-    case vals::R_U64:
-      return pvh_v<std::uint64_t>::get(reader);
-    case vals::BYTES:
-      return pvh_v<std::byte>::get(reader);
-    case vals::BOOL:
-      return pvh<bool>::get(reader);
-    case vals::R_BOOL:
-      return pvh_v<bool>::get(reader);
-    }
-    return std::nullopt;
-  };
   const auto& value = r.getValue();
   std::vector<PublishValueVariant> to_ret(value.size());
   for (std::size_t i = 0; i < value.size(); ++i) {
-    if (const auto add = decode_value(value[i])) { to_ret[i] = *add; }
+    if (const auto add = detail::decode_value(value[i])) { to_ret[i] = *add; }
     else {
       return std::nullopt;
     }
@@ -114,8 +180,71 @@ std::optional<std::vector<PublishValueVariant>> PublishData::value() const noexc
   return to_ret;
 }
 
+bool PublishData::types_match(const gsl::span<const std::uint8_t> expected_types) const noexcept
+{
+  const auto values = r.getValue();
+  if (values.size() != static_cast<std::size_t>(expected_types.size())) { return false; }
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    const auto type_index = expected_types[static_cast<gsl::index>(i)];
+    if (type_index >= detail::wire_tag_for_type_index.size()) { return false; }
+    if (values[i].isRawArray()) {
+      // Raw arrays can stand in for numeric vectors of the same element type
+      const auto raw_type = detail::raw_array_type_for_type_index[type_index];
+      if (!raw_type || values[i].getRawArray().getElementType() != *raw_type) { return false; }
+    }
+    else if (values[i].isQuantizedArray()) {
+      // As can quantized ones for floating point vectors
+      const auto raw_type = detail::raw_array_type_for_type_index[type_index];
+      const auto element_type = values[i].getQuantizedArray().getElementType();
+      if (
+        !raw_type || element_type != *raw_type
+        || (element_type != cpnpro::RawArrayType::F64 && element_type != cpnpro::RawArrayType::F32)) {
+        return false;
+      }
+    }
+    else if (values[i].which() != detail::wire_tag_for_type_index[type_index]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PublishData::is_delta_base() const noexcept { return r.getDeltaBase(); }
+
+bool PublishData::apply_to(std::vector<PublishValueVariant>& value) const noexcept
+{
+  const auto values = r.getValue();
+  value.resize(values.size());
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    if (!values[i].isVectorDelta()) {
+      auto decoded = detail::decode_value(values[i]);
+      if (!decoded) { return false; }
+      value[i] = std::move(*decoded);
+      continue;
+    }
+    const auto delta = values[i].getVectorDelta();
+    const bool applied = std::visit(
+      [&](auto& previous) {
+        using ValueType = std::remove_reference_t<decltype(previous)>;
+        if constexpr (detail::IsVector<ValueType>::value) { return detail::apply_vector_delta(delta, previous); }
+        else {
+          return false;
+        }
+      },
+      value[i]);
+    if (!applied) { return false; }
+  }
+  return true;
+}
+
 VersionID PublishData::version() const noexcept { return r.getVersion(); }
 TagID PublishData::tag_id() const noexcept { return r.getTagID(); }
+std::string_view PublishData::tag_id_view() const noexcept
+{
+  const auto tag_id = r.getTagID();
+  return {tag_id.cStr(), tag_id.size()};
+}
+std::uint32_t PublishData::tag_index() const noexcept { return r.getTagIndex(); }
 PublishData::PublishData(cpnpro::PublishData::Reader reader) noexcept : r{std::move(reader)} {}
 
 /////////////////////////////////////////////////////
@@ -128,6 +257,8 @@ std::vector<MachineID> Greeting::neighbors() const noexcept
   return detail::list_to_vector<MachineID>(r.getNeighbors());
 }
 std::uint16_t Greeting::port() const noexcept { return r.getPort(); }
+WireFeatures Greeting::features() const noexcept { return r.getFeatures(); }
+std::string Greeting::local_socket() const noexcept { return r.getLocalSocket(); }
 Greeting::Greeting(cpnpro::Greeting::Reader reader) noexcept : r{std::move(reader)} {}
 
 /////////////////////////////////////////////////////
@@ -173,6 +304,22 @@ std::vector<std::uint8_t> GetPublishers::publishers_needed() const noexcept
 {
   return detail::list_to_vector<std::uint8_t>(r.getPublishersNeeded());
 }
+std::pmr::vector<std::string_view> GetPublishers::tags(std::pmr::memory_resource* const resource) const noexcept
+{
+  const auto tags = r.getTags();
+  std::pmr::vector<std::string_view> to_ret{resource};
+  to_ret.reserve(tags.size());
+  for (const auto tag : tags) {
+    to_ret.emplace_back(tag.cStr(), tag.size());
+  }
+  return to_ret;
+}
+std::pmr::vector<std::uint8_t> GetPublishers::publishers_needed(std::pmr::memory_resource* const resource) const
+  noexcept
+{
+  const auto publishers_needed = r.getPublishersNeeded();
+  return std::pmr::vector<std::uint8_t>(publishers_needed.begin(), publishers_needed.end(), resource);
+}
 bool GetPublishers::ignore_cache() const noexcept { return r.getIgnoreCache(); }
 GetPublishers::GetPublishers(cpnpro::GetPublishers::Reader reader) noexcept : r{std::move(reader)} {}
 
@@ -213,22 +360,62 @@ bool SubscriptionNotice::is_unsubscribe() const noexcept { return r.getIsUnsubsc
 
 SubscriptionNotice::SubscriptionNotice(cpnpro::SubscriptionNotice::Reader reader) noexcept : r{std::move(reader)} {}
 
+/////////////////////////////////////////////////////
+// ShmAttach
+/////////////////////////////////////////////////////
+
+std::string ShmAttach::name() const noexcept { return r.getName(); }
+std::size_t ShmAttach::capacity() const noexcept { return static_cast<std::size_t>(r.getCapacity()); }
+
+ShmAttach::ShmAttach(cpnpro::ShmAttach::Reader reader) noexcept : r{std::move(reader)} {}
+
+/////////////////////////////////////////////////////
+// ShmAttachReply
+/////////////////////////////////////////////////////
+
+std::string ShmAttachReply::name() const noexcept { return r.getName(); }
+bool ShmAttachReply::success() const noexcept { return r.getSuccess(); }
+
+ShmAttachReply::ShmAttachReply(cpnpro::ShmAttachReply::Reader reader) noexcept : r{std::move(reader)} {}
+
+/////////////////////////////////////////////////////
+// GrantCredits
+/////////////////////////////////////////////////////
+
+std::uint32_t GrantCredits::credits() const noexcept { return r.getCredits(); }
+
+GrantCredits::GrantCredits(cpnpro::GrantCredits::Reader reader) noexcept : r{std::move(reader)} {}
+
+/////////////////////////////////////////////////////
+// BindTag
+/////////////////////////////////////////////////////
+
+TagID BindTag::tag_id() const noexcept { return r.getTagID(); }
+std::uint32_t BindTag::index() const noexcept { return r.getIndex(); }
+
+BindTag::BindTag(cpnpro::BindTag::Reader reader) noexcept : r{std::move(reader)} {}
+
 /////////////////////////////////////////////////////
 // MessageHandler
 /////////////////////////////////////////////////////
 
-MessageHandler::MessageHandler() noexcept : impl_{std::make_unique<Impl>()} {}
+MessageHandler::MessageHandler() noexcept : MessageHandler{std::pmr::new_delete_resource()} {}
+
+MessageHandler::MessageHandler(std::pmr::memory_resource* const resource) noexcept
+  : impl_{new (resource->allocate(sizeof(Impl), alignof(Impl))) Impl{}, ImplDeleter{resource}}
+{}
 
 MessageHandler::MessageHandler(MessageHandler&&) noexcept = default;
 MessageHandler& MessageHandler::operator=(MessageHandler&&) noexcept = default;
 
-std::optional<MessageHandler> MessageHandler::try_to_create(const std::vector<std::byte>& data) noexcept
+std::optional<MessageHandler> MessageHandler::try_to_create(
+  const gsl::span<const std::byte> data, std::pmr::memory_resource* const resource) noexcept
 {
   detail::ExceptionSuppressor suppressor;
   // Read the message from the passed bytes
-  MessageHandler to_ret;
+  MessageHandler to_ret{resource};
   kj::Array<const kj::byte> buffer{
-    reinterpret_cast<const kj::byte*>(data.data()), data.size(), to_ret.impl_->null_disposer};
+    reinterpret_cast<const kj::byte*>(data.data()), static_cast<std::size_t>(data.size()), to_ret.impl_->null_disposer};
   kj::ArrayInputStream in_s{buffer};
   capnp::readMessageCopy(in_s, to_ret.impl_->message);
   to_ret.impl_->root = to_ret.impl_->message.getRoot<cpnpro::StatusMessage>();
@@ -241,6 +428,28 @@ std::optional<MessageHandler> MessageHandler::try_to_create(const std::vector<st
   }
 }
 
+std::optional<MessageHandler> MessageHandler::try_to_view(
+  const gsl::span<const std::byte> data, std::pmr::memory_resource* const resource) noexcept
+{
+  // Cap'n Proto can only read messages in place if they are a whole number of aligned words
+  const bool is_aligned = reinterpret_cast<std::uintptr_t>(data.data()) % alignof(capnp::word) == 0
+                       && data.size() % sizeof(capnp::word) == 0;
+  if (!is_aligned) { return try_to_create(data, resource); }
+  detail::ExceptionSuppressor suppressor;
+  MessageHandler to_ret{resource};
+  const kj::ArrayPtr<const capnp::word> words{
+    reinterpret_cast<const capnp::word*>(data.data()), data.size() / sizeof(capnp::word)};
+  auto& view = to_ret.impl_->view.emplace(words);
+  to_ret.impl_->root = view.getRoot<cpnpro::StatusMessage>();
+  if (suppressor.failed()) {
+    SKYNET_WARN_LOG("Failed to decode message in MessageHandler::try_to_view.");
+    return {};
+  }
+  else {
+    return std::optional<MessageHandler>{std::move(to_ret)};
+  }
+}
+
 auto MessageHandler::extract_message() const noexcept -> std::optional<MessageVariant>
 {
   using vals = cpnpro::StatusMessage::Which;
@@ -273,6 +482,16 @@ auto MessageHandler::extract_message() const noexcept -> std::optional<MessageVa
       return PublishData{impl_->root.getPublishData()};
     case vals::SUBSCRIPTION_NOTICE:
       return SubscriptionNotice{impl_->root.getSubscriptionNotice()};
+    case vals::SHM_ATTACH:
+      return ShmAttach{impl_->root.getShmAttach()};
+    case vals::SHM_ATTACH_REPLY:
+      return ShmAttachReply{impl_->root.getShmAttachReply()};
+    case vals::SHM_SWITCH:
+      return ShmSwitch{};
+    case vals::GRANT_CREDITS:
+      return GrantCredits{impl_->root.getGrantCredits()};
+    case vals::BIND_TAG:
+      return BindTag{impl_->root.getBindTag()};
     }
     return {};
   }();
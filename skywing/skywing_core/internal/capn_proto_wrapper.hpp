@@ -8,15 +8,22 @@
 
 #include <capnp/serialize.h>
 
+#include "skywing_core/include/publish_value_handler.hpp"
 #include "skywing_core/internal/utility/overload_set.hpp"
+#include "skywing_core/internal/wire_features.hpp"
 #include "skywing_core/types.hpp"
 
+#include "gsl/span"
+
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -30,7 +37,66 @@ public:
   TagID tag_id() const noexcept;
   std::optional<std::vector<PublishValueVariant>> value() const noexcept;
 
+  /** \brief Returns the tag without copying it out of the message
+   */
+  std::string_view tag_id_view() const noexcept;
+
+  /** \brief Returns the index the tag was bound to on the connection, or 0
+   * if it is named by tag_id instead
+   */
+  std::uint32_t tag_index() const noexcept;
+
+  /** \brief Returns true if the receiver has to keep the value, as the next
+   * one on the tag may be sent as the changes from it
+   */
+  bool is_delta_base() const noexcept;
+
+  /** \brief Replaces the previous value on the tag with this one, applying
+   * any values that were sent as changes
+   *
+   * \return false if the values couldn't be decoded or the changes don't fit
+   * the previous value, in which case \p value may have been partially
+   * overwritten
+   */
+  bool apply_to(std::vector<PublishValueVariant>& value) const noexcept;
+
+  /** \brief Returns true if the values have exactly the expected types
+   *
+   * \param expected_types The indices into PublishValueTypeList of each value
+   *
+   * Only the union tags on the wire are checked, nothing is decoded.
+   */
+  bool types_match(gsl::span<const std::uint8_t> expected_types) const noexcept;
+
+  /** \brief Decodes the values directly into typed storage
+   *
+   * This skips converting to PublishValueVariant, and reuses the storage
+   * already in \p out where possible.
+   *
+   * \return false if the values aren't of types Ts, in which case \p out may
+   * have been partially overwritten
+   */
+  template<typename... Ts>
+  bool value_into(ValueOrTuple<Ts...>& out) const noexcept
+  {
+    const auto values = r.getValue();
+    if (values.size() != sizeof...(Ts)) { return false; }
+    if constexpr (sizeof...(Ts) == 1) { return detail::PublishValueHandler<Ts...>::get_into(values[0], out); }
+    else {
+      return value_into_tuple(values, out, std::index_sequence_for<Ts...>{});
+    }
+  }
+
 private:
+  template<typename... Ts, std::size_t... Is>
+  static bool value_into_tuple(
+    const capnp::List<cpnpro::PublishValue>::Reader& values,
+    std::tuple<Ts...>& out,
+    std::index_sequence<Is...>) noexcept
+  {
+    return (... && detail::PublishValueHandler<Ts>::get_into(values[Is], std::get<Is>(out)));
+  }
+
   cpnpro::PublishData::Reader r;
 
   friend class MessageHandler;
@@ -46,6 +112,8 @@ public:
   MachineID from() const noexcept;
   std::vector<MachineID> neighbors() const noexcept;
   std::uint16_t port() const noexcept;
+  WireFeatures features() const noexcept;
+  std::string local_socket() const noexcept;
 
 private:
   cpnpro::Greeting::Reader r;
@@ -114,6 +182,13 @@ class GetPublishers {
 public:
   std::vector<TagID> tags() const noexcept;
   std::vector<std::uint8_t> publishers_needed() const noexcept;
+
+  /** \brief Returns the tags without copying them out of the message
+   *
+   * The views are only valid while the message is.
+   */
+  std::pmr::vector<std::string_view> tags(std::pmr::memory_resource* resource) const noexcept;
+  std::pmr::vector<std::uint8_t> publishers_needed(std::pmr::memory_resource* resource) const noexcept;
   bool ignore_cache() const noexcept;
 
 private:
@@ -180,13 +255,96 @@ private:
   explicit SubscriptionNotice(cpnpro::SubscriptionNotice::Reader reader) noexcept;
 };
 
+/** \brief Request to read messages from a shared memory ring
+ */
+class ShmAttach {
+public:
+  std::string name() const noexcept;
+  std::size_t capacity() const noexcept;
+
+private:
+  cpnpro::ShmAttach::Reader r;
+
+  friend class MessageHandler;
+  explicit ShmAttach(cpnpro::ShmAttach::Reader reader) noexcept;
+};
+
+/** \brief Response to a ShmAttach
+ */
+class ShmAttachReply {
+public:
+  std::string name() const noexcept;
+  bool success() const noexcept;
+
+private:
+  cpnpro::ShmAttachReply::Reader r;
+
+  friend class MessageHandler;
+  explicit ShmAttachReply(cpnpro::ShmAttachReply::Reader reader) noexcept;
+};
+
+/** \brief Marks that all further messages will be sent through the shared
+ * memory ring
+ */
+class ShmSwitch {
+  // Intentionally empty
+};
+
+/** \brief Allows the receiver to be sent more published values
+ */
+class GrantCredits {
+public:
+  std::uint32_t credits() const noexcept;
+
+private:
+  cpnpro::GrantCredits::Reader r;
+
+  friend class MessageHandler;
+  explicit GrantCredits(cpnpro::GrantCredits::Reader reader) noexcept;
+};
+
+/** \brief Binds a tag to an index that later publishes can name it by
+ */
+class BindTag {
+public:
+  TagID tag_id() const noexcept;
+  std::uint32_t index() const noexcept;
+
+private:
+  cpnpro::BindTag::Reader r;
+
+  friend class MessageHandler;
+  explicit BindTag(cpnpro::BindTag::Reader reader) noexcept;
+};
+
 /** \brief Class for converting the raw bytes of a message into a useable format
  */
 class MessageHandler {
 public:
   /** \brief Construct a message handler from a raw set of bytes
+   *
+   * The message is copied, so the bytes don't need to outlive the handler.
+   *
+   * \param resource Where the handler's own state is allocated; it must
+   * outlive the handler
    */
-  static std::optional<MessageHandler> try_to_create(const std::vector<std::byte>& data) noexcept;
+  static std::optional<MessageHandler> try_to_create(
+    gsl::span<const std::byte> data,
+    std::pmr::memory_resource* resource = std::pmr::new_delete_resource()) noexcept;
+
+  /** \brief Construct a message handler that reads the message in place
+   *
+   * No copy of the message is made, so the bytes must stay valid and unchanged
+   * for as long as the handler or anything extracted from it (such as a
+   * PublishData) is in use.  If the bytes aren't word-aligned this falls back
+   * to making a copy as try_to_create does.
+   *
+   * \param resource As for try_to_create; handlers that only live while a
+   * message is handled can come from the manager's per-pass arena
+   */
+  static std::optional<MessageHandler> try_to_view(
+    gsl::span<const std::byte> data,
+    std::pmr::memory_resource* resource = std::pmr::new_delete_resource()) noexcept;
 
   // Moveable only
   MessageHandler() noexcept;
@@ -222,7 +380,14 @@ private:
     SubmitReduceValue,
     ReportReduceDisconnection,
     SubscriptionNotice,
-    PublishData>;
+    PublishData,
+    ShmAttach,
+    ShmAttachReply,
+    ShmSwitch,
+    GrantCredits,
+    BindTag>;
+
+  explicit MessageHandler(std::pmr::memory_resource* resource) noexcept;
 
   // Process the stored message and return its internal type
   std::optional<MessageVariant> extract_message() const noexcept;
@@ -233,10 +398,23 @@ private:
   // an optional, which requires it to be complete
   struct Impl {
     kj::NullArrayDisposer null_disposer;
+    // Holds a copy of the message
     capnp::MallocMessageBuilder message;
+    // Reads the message from the bytes it was created from instead
+    std::optional<capnp::FlatArrayMessageReader> view;
     cpnpro::StatusMessage::Reader root;
   };
-  std::unique_ptr<Impl> impl_;
+  // Gives Impl back to the resource it was allocated from
+  struct ImplDeleter {
+    std::pmr::memory_resource* resource;
+
+    void operator()(Impl* impl) const noexcept
+    {
+      impl->~Impl();
+      resource->deallocate(impl, sizeof(Impl), alignof(Impl));
+    }
+  };
+  std::unique_ptr<Impl, ImplDeleter> impl_;
 };
 } // namespace skywing::internal
 
@@ -0,0 +1,137 @@
+#include "skywing_core/internal/devices/address_resolver.hpp"
+
+#include "skywing_core/internal/utility/logging.hpp"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+// Converts an IPv4 address to dotted form
+std::string to_dotted(const in_addr& addr) noexcept
+{
+  char buffer[INET_ADDRSTRLEN];
+  if (inet_ntop(AF_INET, &addr, buffer, sizeof(buffer)) == nullptr) { return {}; }
+  return buffer;
+}
+
+// Blocks until the host is looked up; returns an empty string on failure, with
+// the reason in error
+std::string lookup(const std::string& host, std::string& error) noexcept
+{
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_IP;
+  addrinfo* result = nullptr;
+  const auto err = getaddrinfo(host.c_str(), nullptr, &hints, &result);
+  if (err != 0 || result == nullptr) {
+    error = err != 0 ? gai_strerror(err) : "no IPv4 address found";
+    SKYNET_WARN_LOG("Couldn't resolve \"{}\": {}", host, error);
+    return {};
+  }
+  auto to_ret = to_dotted(reinterpret_cast<const sockaddr_in*>(result->ai_addr)->sin_addr);
+  freeaddrinfo(result);
+  return to_ret;
+}
+} // namespace
+
+namespace skywing::internal {
+struct AddressResolver::State {
+  std::mutex mutex;
+  std::condition_variable work_cv;
+  // Hosts waiting to be looked up
+  std::deque<std::string> queue;
+  std::unordered_map<std::string, Resolution> results;
+  // Null once the resolver is gone
+  Reactor* reactor = nullptr;
+  bool worker_started = false;
+};
+
+AddressResolver::AddressResolver(Reactor& reactor) noexcept : state_{std::make_shared<State>()}
+{
+  state_->reactor = &reactor;
+}
+
+AddressResolver::~AddressResolver()
+{
+  std::lock_guard lock{state_->mutex};
+  state_->reactor = nullptr;
+  state_->queue.clear();
+  state_->work_cv.notify_all();
+}
+
+Resolution AddressResolver::resolve(const std::string& host) noexcept
+{
+  if (auto address = resolve_numeric(host)) { return {Resolution::Status::resolved, std::move(*address), {}}; }
+  std::lock_guard lock{state_->mutex};
+  const auto [iter, inserted] = state_->results.try_emplace(host, Resolution{Resolution::Status::pending, {}, {}});
+  if (!inserted) {
+    const auto to_ret = iter->second;
+    if (to_ret.status == Resolution::Status::failed) { state_->results.erase(iter); }
+    return to_ret;
+  }
+  state_->queue.push_back(host);
+  if (!state_->worker_started) {
+    state_->worker_started = true;
+    // Detached so that destroying the resolver never waits on a slow lookup
+    std::thread{run_worker, state_}.detach();
+  }
+  state_->work_cv.notify_one();
+  return iter->second;
+}
+
+std::optional<std::string> AddressResolver::cached(const std::string& host) const noexcept
+{
+  if (auto address = resolve_numeric(host)) { return address; }
+  std::lock_guard lock{state_->mutex};
+  const auto iter = state_->results.find(host);
+  if (iter == state_->results.cend() || iter->second.status != Resolution::Status::resolved) { return std::nullopt; }
+  return iter->second.address;
+}
+
+std::optional<std::string> AddressResolver::resolve_numeric(const std::string& host) noexcept
+{
+  if (host == "localhost") { return "127.0.0.1"; }
+  in_addr addr;
+  if (inet_pton(AF_INET, host.c_str(), &addr) != 1) { return std::nullopt; }
+  return to_dotted(addr);
+}
+
+void AddressResolver::run_worker(const std::shared_ptr<State> state) noexcept
+{
+  std::unique_lock lock{state->mutex};
+  while (true) {
+    state->work_cv.wait(lock, [&]() { return !state->queue.empty() || state->reactor == nullptr; });
+    if (state->reactor == nullptr) { return; }
+    const auto host = std::move(state->queue.front());
+    state->queue.pop_front();
+    lock.unlock();
+    [[maybe_unused]] const auto start = std::chrono::steady_clock::now();
+    std::string error;
+    auto address = lookup(host, error);
+    SKYNET_DEBUG_LOG(
+      "Resolving \"{}\" took {}ms",
+      host,
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+    lock.lock();
+    if (state->reactor == nullptr) { return; }
+    auto& result = state->results[host];
+    result.status = address.empty() ? Resolution::Status::failed : Resolution::Status::resolved;
+    result.address = std::move(address);
+    result.error = std::move(error);
+    state->reactor->wake();
+  }
+}
+} // namespace skywing::internal
@@ -0,0 +1,82 @@
+#ifndef SKYNET_INTERNAL_DEVICES_ADDRESS_RESOLVER_HPP
+#define SKYNET_INTERNAL_DEVICES_ADDRESS_RESOLVER_HPP
+
+#include "skywing_core/internal/devices/reactor.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace skywing::internal {
+/** \brief The state of looking up a host name
+ */
+struct Resolution {
+  enum class Status {
+    /// The lookup hasn't finished yet
+    pending,
+
+    /// The host was found; the address is in dotted IPv4 form
+    resolved,
+
+    /// The host couldn't be found
+    failed
+  };
+
+  Status status;
+  std::string address;
+  /// Why the lookup failed, if it did
+  std::string error;
+}; // struct Resolution
+
+/** \brief Looks up host names without blocking the manager thread
+ *
+ * Dotted IPv4 addresses and "localhost" are converted immediately.  Anything
+ * else is looked up on a worker thread, which is only started once a name
+ * needs it, and the reactor is woken when a lookup finishes.  Found addresses
+ * are cached for the life of the resolver; failures are reported once and then
+ * forgotten so that asking again retries the lookup.
+ */
+class AddressResolver {
+public:
+  /** \brief Creates the resolver
+   *
+   * \param reactor The reactor to wake when a lookup finishes
+   */
+  explicit AddressResolver(Reactor& reactor) noexcept;
+
+  // Can not be copied or moved; the worker refers to it
+  AddressResolver(const AddressResolver&) = delete;
+  AddressResolver& operator=(const AddressResolver&) = delete;
+
+  /** \brief Stops the worker; a lookup in progress is left to finish in the
+   * background and its result discarded
+   */
+  ~AddressResolver();
+
+  /** \brief Returns the state of a host, starting a lookup if needed
+   */
+  Resolution resolve(const std::string& host) noexcept;
+
+  /** \brief Returns the address for a host if it is already known
+   *
+   * Never starts a lookup.
+   */
+  std::optional<std::string> cached(const std::string& host) const noexcept;
+
+  /** \brief Converts a host without looking it up, if it is a dotted IPv4
+   * address or "localhost"
+   */
+  static std::optional<std::string> resolve_numeric(const std::string& host) noexcept;
+
+private:
+  // Shared with the worker, which may outlive the resolver while a lookup finishes
+  struct State;
+
+  // Looks up names until stopped
+  static void run_worker(std::shared_ptr<State> state) noexcept;
+
+  std::shared_ptr<State> state_;
+}; // class AddressResolver
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_DEVICES_ADDRESS_RESOLVER_HPP
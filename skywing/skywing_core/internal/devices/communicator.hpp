@@ -0,0 +1,107 @@
+#ifndef SKYNET_INTERNAL_DEVICES_COMMUNICATOR_HPP
+#define SKYNET_INTERNAL_DEVICES_COMMUNICATOR_HPP
+
+#include "skywing_core/types.hpp"
+
+#include "gsl/span"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace skywing::internal {
+/** \brief Enum returned from communication functions for connection status
+ */
+enum class [[nodiscard]] ConnectionError{/// The call has fully succeeded, no more work needs to be done
+                                         no_error,
+
+                                         /// The call would block
+                                         would_block,
+
+                                         /// Non-blocking connected has been initiated
+                                         connection_in_progress = would_block,
+
+                                         /// An error occurred with communication that has left the connection
+                                         /// in an unusable state
+                                         unrecoverable,
+
+                                         /// The connection has closed
+                                         closed}; // enum class ConnectionError
+
+/** \brief A framed message ready to be written; shared so that sending the
+ * same message to many neighbors doesn't copy it for each one
+ */
+using SharedFrame = std::shared_ptr<const std::vector<std::byte>>;
+
+/** \brief A connection to another instance
+ *
+ * The manager only talks to its neighbors through this, so that connections
+ * can go over something other than a socket.  All of the operations are
+ * non-blocking, and behave as they do on a non-blocking socket.
+ */
+class Communicator {
+public:
+  virtual ~Communicator() = default;
+
+  /** \brief Returns status on a pending connection
+   */
+  virtual ConnectionError connection_progress_status() noexcept = 0;
+
+  /** \brief Sends a whole message
+   */
+  virtual ConnectionError send_message(const std::byte* message, std::size_t size) noexcept = 0;
+
+  /** \brief Sends as much of several buffers as the connection will take
+   *
+   * \param buffers The buffers to send, in order
+   * \param bytes_sent Set to the total number of bytes written
+   */
+  virtual ConnectionError
+    send_buffers(gsl::span<const gsl::span<const std::byte>> buffers, std::size_t& bytes_sent) noexcept = 0;
+
+  /** \brief Hands over a whole frame without copying it
+   *
+   * \return false if the connection can't take frames this way, in which
+   * case it has to be sent as bytes
+   */
+  virtual bool send_shared_frame(const SharedFrame& frame) noexcept
+  {
+    (void)frame;
+    return false;
+  }
+
+  /** \brief Reads whatever is available, up to size bytes
+   */
+  virtual ConnectionError read_available(std::byte* buffer, std::size_t size, std::size_t& bytes_read) noexcept = 0;
+
+  /** \brief Returns the IP address and port of the peer
+   */
+  virtual AddrPortPair ip_address_and_port() const noexcept = 0;
+
+  /** \brief Returns the IP address and port of this end
+   */
+  virtual AddrPortPair host_ip_address_and_port() const noexcept = 0;
+
+  /** \brief Returns the OS handle to register with a Reactor, or -1 if the
+   * connection wakes the reactor itself
+   */
+  virtual int native_handle() const noexcept = 0;
+
+  /** \brief Returns true if the peer is known to be on the same host
+   */
+  virtual bool is_local() const noexcept = 0;
+
+  /** \brief Returns true if the peer is in the same process
+   */
+  virtual bool is_in_process() const noexcept { return false; }
+
+protected:
+  Communicator() = default;
+  Communicator(const Communicator&) = default;
+  Communicator& operator=(const Communicator&) = default;
+  Communicator(Communicator&&) = default;
+  Communicator& operator=(Communicator&&) = default;
+}; // class Communicator
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_DEVICES_COMMUNICATOR_HPP
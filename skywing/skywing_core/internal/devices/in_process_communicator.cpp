@@ -0,0 +1,227 @@
+#include "skywing_core/internal/devices/in_process_communicator.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace skywing::internal {
+struct InProcessCommunicator::Pipe {
+  struct Queued {
+    SharedFrame frame;
+    Clock::time_point delivery;
+  };
+
+  std::mutex mutex;
+  std::deque<Queued> frames;
+  // Bytes of the front frame that have already been read
+  std::size_t front_offset = 0;
+  // Woken when frames are added; null once the reading end is gone
+  Reactor* reader = nullptr;
+  bool writer_closed = false;
+  bool reader_closed = false;
+  // Only set in simulations
+  SimulatedLinks* links = nullptr;
+  std::uint16_t from_port = 0;
+  std::uint16_t to_port = 0;
+  Clock::time_point last_delivery{};
+};
+
+struct InProcessListener::State {
+  std::mutex mutex;
+  std::deque<std::unique_ptr<InProcessCommunicator>> pending;
+  Reactor* reactor = nullptr;
+  SimulatedLinks* links = nullptr;
+  bool listening = false;
+};
+
+struct InProcessListener::Registry {
+  std::mutex mutex;
+  std::unordered_map<std::uint16_t, std::shared_ptr<State>> listeners;
+};
+
+std::unique_ptr<InProcessCommunicator>
+  InProcessCommunicator::connect(const std::uint16_t port, Reactor& reactor, const std::uint16_t local_port) noexcept
+{
+  const auto failed = [] {
+    return std::unique_ptr<InProcessCommunicator>{new InProcessCommunicator{nullptr, nullptr}};
+  };
+  const auto listener = [&]() -> std::shared_ptr<InProcessListener::State> {
+    auto& registry = InProcessListener::registry();
+    std::lock_guard lock{registry.mutex};
+    const auto iter = registry.listeners.find(port);
+    return iter == registry.listeners.cend() ? nullptr : iter->second;
+  }();
+  if (!listener) { return failed(); }
+  const auto to_listener = std::make_shared<Pipe>();
+  const auto to_connector = std::make_shared<Pipe>();
+  to_connector->reader = &reactor;
+  std::unique_ptr<InProcessCommunicator> to_ret{new InProcessCommunicator{to_connector, to_listener}};
+  std::unique_ptr<InProcessCommunicator> accepted{new InProcessCommunicator{to_listener, to_connector}};
+  std::lock_guard lock{listener->mutex};
+  // It may have stopped listening after being looked up
+  if (!listener->listening) { return failed(); }
+  to_listener->reader = listener->reactor;
+  for (auto* const pipe : {to_listener.get(), to_connector.get()}) {
+    pipe->links = listener->links;
+  }
+  to_listener->from_port = local_port;
+  to_listener->to_port = port;
+  to_connector->from_port = port;
+  to_connector->to_port = local_port;
+  listener->pending.push_back(std::move(accepted));
+  listener->reactor->wake();
+  return to_ret;
+}
+
+InProcessCommunicator::InProcessCommunicator(std::shared_ptr<Pipe> in, std::shared_ptr<Pipe> out) noexcept
+  : in_{std::move(in)}, out_{std::move(out)}
+{}
+
+InProcessCommunicator::~InProcessCommunicator()
+{
+  if (out_) {
+    std::lock_guard lock{out_->mutex};
+    out_->writer_closed = true;
+    if (out_->reader) { out_->reader->wake(); }
+  }
+  if (in_) {
+    std::lock_guard lock{in_->mutex};
+    in_->reader_closed = true;
+    in_->reader = nullptr;
+    in_->frames.clear();
+  }
+}
+
+ConnectionError InProcessCommunicator::connection_progress_status() noexcept
+{
+  return out_ ? ConnectionError::no_error : ConnectionError::unrecoverable;
+}
+
+ConnectionError InProcessCommunicator::send_message(const std::byte* const message, const std::size_t size) noexcept
+{
+  return push(std::make_shared<const std::vector<std::byte>>(message, message + size));
+}
+
+ConnectionError InProcessCommunicator::send_buffers(
+  const gsl::span<const gsl::span<const std::byte>> buffers, std::size_t& bytes_sent) noexcept
+{
+  bytes_sent = 0;
+  std::vector<std::byte> joined;
+  for (const auto& buffer : buffers) {
+    joined.insert(joined.end(), buffer.begin(), buffer.end());
+  }
+  const auto size = joined.size();
+  const auto err = push(std::make_shared<const std::vector<std::byte>>(std::move(joined)));
+  if (err == ConnectionError::no_error) { bytes_sent = size; }
+  return err;
+}
+
+bool InProcessCommunicator::send_shared_frame(const SharedFrame& frame) noexcept
+{
+  return push(frame) == ConnectionError::no_error;
+}
+
+ConnectionError InProcessCommunicator::read_available(
+  std::byte* const buffer, const std::size_t size, std::size_t& bytes_read) noexcept
+{
+  bytes_read = 0;
+  if (!in_) { return ConnectionError::unrecoverable; }
+  std::lock_guard lock{in_->mutex};
+  auto& frames = in_->frames;
+  const auto now = in_->links ? in_->links->clock().now() : Clock::time_point{};
+  while (!frames.empty() && bytes_read < size && frames.front().delivery <= now) {
+    const auto& frame = *frames.front().frame;
+    const auto amount = std::min(frame.size() - in_->front_offset, size - bytes_read);
+    std::memcpy(buffer + bytes_read, frame.data() + in_->front_offset, amount);
+    bytes_read += amount;
+    in_->front_offset += amount;
+    if (in_->front_offset == frame.size()) {
+      frames.pop_front();
+      in_->front_offset = 0;
+    }
+  }
+  if (bytes_read != 0) { return ConnectionError::no_error; }
+  return in_->writer_closed && frames.empty() ? ConnectionError::closed : ConnectionError::would_block;
+}
+
+AddrPortPair InProcessCommunicator::ip_address_and_port() const noexcept { return {"127.0.0.1", 0}; }
+
+AddrPortPair InProcessCommunicator::host_ip_address_and_port() const noexcept { return {"127.0.0.1", 0}; }
+
+int InProcessCommunicator::native_handle() const noexcept { return -1; }
+
+bool InProcessCommunicator::is_local() const noexcept { return true; }
+
+bool InProcessCommunicator::is_in_process() const noexcept { return true; }
+
+ConnectionError InProcessCommunicator::push(SharedFrame frame) noexcept
+{
+  if (!out_) { return ConnectionError::unrecoverable; }
+  std::lock_guard lock{out_->mutex};
+  if (out_->reader_closed) { return ConnectionError::closed; }
+  if (frame->empty()) { return ConnectionError::no_error; }
+  if (out_->links) {
+    // Whatever runs the simulation reads it once it is delivered
+    out_->last_delivery = out_->links->schedule(out_->from_port, out_->to_port, frame->size(), out_->last_delivery);
+    out_->frames.push_back(Pipe::Queued{std::move(frame), out_->last_delivery});
+    return ConnectionError::no_error;
+  }
+  out_->frames.push_back(Pipe::Queued{std::move(frame), Clock::time_point{}});
+  if (out_->reader) { out_->reader->wake(); }
+  return ConnectionError::no_error;
+}
+
+InProcessListener::InProcessListener() noexcept : state_{std::make_shared<State>()} {}
+
+InProcessListener::~InProcessListener()
+{
+  {
+    auto& reg = registry();
+    std::lock_guard lock{reg.mutex};
+    const auto iter = std::find_if(
+      reg.listeners.begin(), reg.listeners.end(), [&](const auto& entry) { return entry.second == state_; });
+    if (iter != reg.listeners.end()) { reg.listeners.erase(iter); }
+  }
+  decltype(state_->pending) pending;
+  {
+    std::lock_guard lock{state_->mutex};
+    state_->listening = false;
+    pending.swap(state_->pending);
+  }
+  // Closed outside of the lock as that wakes the connecting ends
+}
+
+ConnectionError
+  InProcessListener::listen(const std::uint16_t port, Reactor& reactor, SimulatedLinks* const links) noexcept
+{
+  auto& reg = registry();
+  std::lock_guard lock{reg.mutex};
+  const auto [iter, inserted] = reg.listeners.try_emplace(port, state_);
+  (void)iter;
+  if (!inserted) { return ConnectionError::unrecoverable; }
+  std::lock_guard state_lock{state_->mutex};
+  state_->reactor = &reactor;
+  state_->links = links;
+  state_->listening = true;
+  return ConnectionError::no_error;
+}
+
+std::unique_ptr<InProcessCommunicator> InProcessListener::accept() noexcept
+{
+  std::lock_guard lock{state_->mutex};
+  if (state_->pending.empty()) { return nullptr; }
+  auto to_ret = std::move(state_->pending.front());
+  state_->pending.pop_front();
+  return to_ret;
+}
+
+auto InProcessListener::registry() noexcept -> Registry&
+{
+  static Registry instance;
+  return instance;
+}
+} // namespace skywing::internal
@@ -0,0 +1,123 @@
+#ifndef SKYNET_INTERNAL_DEVICES_IN_PROCESS_COMMUNICATOR_HPP
+#define SKYNET_INTERNAL_DEVICES_IN_PROCESS_COMMUNICATOR_HPP
+
+#include "skywing_core/internal/devices/communicator.hpp"
+#include "skywing_core/internal/devices/reactor.hpp"
+#include "skywing_core/internal/devices/simulated_links.hpp"
+
+#include <cstdint>
+#include <memory>
+
+namespace skywing::internal {
+/** \brief Connection to another instance in the same process
+ *
+ * Frames are handed over by reference instead of being copied, and the only
+ * copy made is when the receiver reads them into its ReceiveBuffer.  Sending
+ * wakes the receiver's Reactor directly, so no file descriptors are used.
+ *
+ * Instances are addressed by the port they listen on, through an
+ * InProcessListener.  If the listener was given SimulatedLinks, frames in both
+ * directions only become readable once their delivery time has been reached.
+ */
+class InProcessCommunicator : public Communicator {
+public:
+  /** \brief Connects to the listener on a port
+   *
+   * Always returns a communicator; if nothing is listening on the port its
+   * connection_progress_status() is unrecoverable.
+   *
+   * \param port The port the listener is on
+   * \param reactor The reactor to wake when data arrives
+   * \param local_port The port of the connecting instance, which is only used
+   * for simulated latencies
+   */
+  static std::unique_ptr<InProcessCommunicator>
+    connect(std::uint16_t port, Reactor& reactor, std::uint16_t local_port = 0) noexcept;
+
+  // Can not be copied or moved; shared with the other end
+  InProcessCommunicator(const InProcessCommunicator&) = delete;
+  InProcessCommunicator& operator=(const InProcessCommunicator&) = delete;
+
+  /** \brief Closes the connection, waking the other end
+   */
+  ~InProcessCommunicator() override;
+
+  ConnectionError connection_progress_status() noexcept override;
+  ConnectionError send_message(const std::byte* message, std::size_t size) noexcept override;
+  ConnectionError
+    send_buffers(gsl::span<const gsl::span<const std::byte>> buffers, std::size_t& bytes_sent) noexcept override;
+  bool send_shared_frame(const SharedFrame& frame) noexcept override;
+  ConnectionError read_available(std::byte* buffer, std::size_t size, std::size_t& bytes_read) noexcept override;
+
+  /** \brief Instances in the process all report the loopback address
+   */
+  AddrPortPair ip_address_and_port() const noexcept override;
+  AddrPortPair host_ip_address_and_port() const noexcept override;
+
+  int native_handle() const noexcept override;
+  bool is_local() const noexcept override;
+  bool is_in_process() const noexcept override;
+
+private:
+  friend class InProcessListener;
+
+  // Frames going in one direction
+  struct Pipe;
+
+  InProcessCommunicator(std::shared_ptr<Pipe> in, std::shared_ptr<Pipe> out) noexcept;
+
+  // Queues a frame for the other end
+  ConnectionError push(SharedFrame frame) noexcept;
+
+  // Null if the connection was never made
+  std::shared_ptr<Pipe> in_;
+  std::shared_ptr<Pipe> out_;
+}; // class InProcessCommunicator
+
+/** \brief Accepts in-process connections on a port
+ *
+ * Ports are shared by every instance in the process but are separate from
+ * the operating system's, so they don't need to be free for sockets.
+ */
+class InProcessListener {
+public:
+  InProcessListener() noexcept;
+
+  // Can not be copied or moved; connecting ends refer to it
+  InProcessListener(const InProcessListener&) = delete;
+  InProcessListener& operator=(const InProcessListener&) = delete;
+
+  /** \brief Stops listening; anything not yet accepted is closed
+   */
+  ~InProcessListener();
+
+  /** \brief Listens for connections on a port
+   *
+   * \param port The port to listen on
+   * \param reactor The reactor to wake when a connection arrives, which
+   * also becomes the one woken when data arrives on accepted connections
+   * \param links If not null, delays every frame on connections made to this
+   * listener; must outlive them
+   * \return unrecoverable if something in the process is already listening
+   * on the port
+   */
+  ConnectionError listen(std::uint16_t port, Reactor& reactor, SimulatedLinks* links = nullptr) noexcept;
+
+  /** \brief Accepts a connection if one is pending
+   */
+  std::unique_ptr<InProcessCommunicator> accept() noexcept;
+
+private:
+  friend class InProcessCommunicator;
+
+  struct State;
+
+  // The listeners in the process by port
+  struct Registry;
+  static Registry& registry() noexcept;
+
+  std::shared_ptr<State> state_;
+}; // class InProcessListener
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_DEVICES_IN_PROCESS_COMMUNICATOR_HPP
@@ -0,0 +1,63 @@
+#ifndef SKYNET_INTERNAL_DEVICES_REACTOR_HPP
+#define SKYNET_INTERNAL_DEVICES_REACTOR_HPP
+
+#include <chrono>
+#include <memory>
+
+namespace skywing::internal {
+/** \brief Readiness notification for the manager thread
+ *
+ * Handles are registered with the interest they have (readable, or readable and
+ * writable) and the manager thread blocks in wait() until one of them is ready,
+ * the timeout expires, or another thread calls wake().  Uses epoll on Linux and
+ * poll on other platforms.
+ *
+ * Closing a handle implicitly removes it, so callers only need to call watch()
+ * when a handle is created or its interest changes.
+ */
+class Reactor {
+public:
+  /** \brief Creates the reactor; exits the program if this fails
+   */
+  Reactor() noexcept;
+
+  // Can not be copied or moved; other threads hold references to wake it
+  Reactor(const Reactor&) = delete;
+  Reactor& operator=(const Reactor&) = delete;
+
+  ~Reactor();
+
+  /** \brief Registers a handle, or updates the interest of an already registered one
+   *
+   * Safe to call from any thread.  Negative handles are used by connections
+   * that wake the reactor themselves; they are always writable, so watching one
+   * for writing just wakes the next wait().
+   *
+   * \param handle The handle to watch
+   * \param want_write If writability should also wake the reactor
+   */
+  void watch(int handle, bool want_write) noexcept;
+
+  /** \brief Blocks until a watched handle is ready, wake() is called, or the
+   * timeout expires
+   *
+   * Only one thread may wait at a time.
+   *
+   * \return True if anything woke the reactor before the timeout
+   */
+  bool wait(std::chrono::milliseconds timeout) noexcept;
+
+  /** \brief Wakes a thread blocked in wait(), or causes the next wait() to
+   * return immediately
+   *
+   * Safe to call from any thread; repeated calls before the next wait() are coalesced.
+   */
+  void wake() noexcept;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+}; // class Reactor
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_DEVICES_REACTOR_HPP
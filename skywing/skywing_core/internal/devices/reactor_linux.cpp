@@ -0,0 +1,87 @@
+#include "skywing_core/internal/devices/reactor.hpp"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace skywing::internal {
+struct Reactor::Impl {
+  int epoll_handle;
+  int wake_handle;
+  // Set while a wake-up is sitting in the eventfd so repeated wakes don't each
+  // need a system call
+  std::atomic<bool> wake_pending{false};
+};
+
+Reactor::Reactor() noexcept : impl_{std::make_unique<Impl>()}
+{
+  impl_->epoll_handle = epoll_create1(EPOLL_CLOEXEC);
+  if (impl_->epoll_handle == -1) {
+    std::perror("Reactor::Reactor - epoll_create1");
+    std::exit(4);
+  }
+  impl_->wake_handle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (impl_->wake_handle == -1) {
+    std::perror("Reactor::Reactor - eventfd");
+    std::exit(4);
+  }
+  watch(impl_->wake_handle, false);
+}
+
+Reactor::~Reactor()
+{
+  close(impl_->wake_handle);
+  close(impl_->epoll_handle);
+}
+
+void Reactor::watch(const int handle, const bool want_write) noexcept
+{
+  if (handle < 0) {
+    // Nothing to wait on, but always writable
+    if (want_write) { wake(); }
+    return;
+  }
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLRDHUP | (want_write ? EPOLLOUT : 0u);
+  event.data.fd = handle;
+  if (epoll_ctl(impl_->epoll_handle, EPOLL_CTL_MOD, handle, &event) == -1 && errno == ENOENT) {
+    // Not registered yet (or the handle number was closed and re-used)
+    epoll_ctl(impl_->epoll_handle, EPOLL_CTL_ADD, handle, &event);
+  }
+}
+
+bool Reactor::wait(const std::chrono::milliseconds timeout) noexcept
+{
+  // Events only have to wake the thread; the manager looks at every connection
+  // after waking, so the ready list itself isn't needed beyond the wake handle
+  constexpr int max_events = 64;
+  std::array<epoll_event, max_events> events;
+  const int timeout_ms = timeout.count() < 0 ? 0 : static_cast<int>(timeout.count());
+  const int num_ready = epoll_wait(impl_->epoll_handle, events.data(), max_events, timeout_ms);
+  for (int i = 0; i < num_ready; ++i) {
+    if (events[i].data.fd == impl_->wake_handle) {
+      // Drain before clearing the flag; clearing first would let a wake() write
+      // in between, be drained here, and leave the flag set with nothing to
+      // read, which would make every later wake() a no-op
+      std::uint64_t count;
+      (void)!read(impl_->wake_handle, &count, sizeof(count));
+      impl_->wake_pending.store(false, std::memory_order_release);
+    }
+  }
+  return num_ready > 0;
+}
+
+void Reactor::wake() noexcept
+{
+  if (impl_->wake_pending.exchange(true, std::memory_order_acq_rel)) { return; }
+  const std::uint64_t count = 1;
+  (void)!write(impl_->wake_handle, &count, sizeof(count));
+}
+} // namespace skywing::internal
@@ -0,0 +1,113 @@
+#include "skywing_core/internal/devices/reactor.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace skywing::internal {
+namespace {
+void set_non_blocking(const int handle) noexcept
+{
+  fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+  fcntl(handle, F_SETFD, FD_CLOEXEC);
+}
+} // namespace
+
+// There is no epoll, so keep the list of handles and hand it to poll on each wait
+struct Reactor::Impl {
+  std::mutex handles_mutex;
+  std::vector<pollfd> handles;
+  // Self-pipe for waking up the waiting thread
+  int wake_read;
+  int wake_write;
+  std::atomic<bool> wake_pending{false};
+};
+
+Reactor::Reactor() noexcept : impl_{std::make_unique<Impl>()}
+{
+  int pipe_handles[2];
+  if (pipe(pipe_handles) == -1) {
+    std::perror("Reactor::Reactor - pipe");
+    std::exit(4);
+  }
+  impl_->wake_read = pipe_handles[0];
+  impl_->wake_write = pipe_handles[1];
+  set_non_blocking(impl_->wake_read);
+  set_non_blocking(impl_->wake_write);
+}
+
+Reactor::~Reactor()
+{
+  close(impl_->wake_read);
+  close(impl_->wake_write);
+}
+
+void Reactor::watch(const int handle, const bool want_write) noexcept
+{
+  if (handle < 0) {
+    // Nothing to wait on, but always writable
+    if (want_write) { wake(); }
+    return;
+  }
+  {
+    std::lock_guard lock{impl_->handles_mutex};
+    const short events = POLLIN | (want_write ? POLLOUT : 0);
+    auto& handles = impl_->handles;
+    const auto iter
+      = std::find_if(handles.begin(), handles.end(), [&](const pollfd& p) noexcept { return p.fd == handle; });
+    if (iter == handles.end()) { handles.push_back(pollfd{handle, events, 0}); }
+    else {
+      iter->events = events;
+    }
+  }
+  // The change only takes effect on the next call to poll
+  wake();
+}
+
+bool Reactor::wait(const std::chrono::milliseconds timeout) noexcept
+{
+  std::vector<pollfd> to_poll;
+  {
+    std::lock_guard lock{impl_->handles_mutex};
+    to_poll = impl_->handles;
+  }
+  to_poll.push_back(pollfd{impl_->wake_read, POLLIN, 0});
+  const int timeout_ms = timeout.count() < 0 ? 0 : static_cast<int>(timeout.count());
+  const int num_ready = poll(to_poll.data(), static_cast<nfds_t>(to_poll.size()), timeout_ms);
+  if (num_ready <= 0) { return false; }
+  if ((to_poll.back().revents & POLLIN) != 0) {
+    // Drain before clearing the flag; clearing first would let a wake() write
+    // in between, be drained here, and leave the flag set with nothing to read,
+    // which would make every later wake() a no-op
+    char drain[64];
+    while (read(impl_->wake_read, drain, sizeof(drain)) > 0) {}
+    impl_->wake_pending.store(false, std::memory_order_release);
+  }
+  // Closed handles report POLLNVAL forever, so forget about them
+  std::lock_guard lock{impl_->handles_mutex};
+  for (const auto& p : to_poll) {
+    if ((p.revents & POLLNVAL) != 0) {
+      auto& handles = impl_->handles;
+      handles.erase(
+        std::remove_if(handles.begin(), handles.end(), [&](const pollfd& h) noexcept { return h.fd == p.fd; }),
+        handles.end());
+    }
+  }
+  return true;
+}
+
+void Reactor::wake() noexcept
+{
+  if (impl_->wake_pending.exchange(true, std::memory_order_acq_rel)) { return; }
+  const char byte = 0;
+  (void)!write(impl_->wake_write, &byte, 1);
+}
+} // namespace skywing::internal
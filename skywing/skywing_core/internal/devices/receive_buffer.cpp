@@ -0,0 +1,89 @@
+#include "skywing_core/internal/devices/receive_buffer.hpp"
+
+#include "skywing_core/internal/utility/logging.hpp"
+#include "skywing_core/internal/utility/network_conv.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace skywing::internal {
+namespace {
+// Size the buffer starts out at; most messages are much smaller than this
+constexpr std::size_t initial_capacity = 0x1'0000;
+
+// Compact once less than this much space is left at the end
+constexpr std::size_t min_read_size = 0x1000;
+
+constexpr std::size_t header_size = frame_header_size;
+} // namespace
+
+ConnectionError ReceiveBuffer::fill(Communicator& conn) noexcept { return fill_from(conn); }
+
+ConnectionError ReceiveBuffer::fill(SharedMemoryRing& ring) noexcept { return fill_from(ring); }
+
+template<typename Connection>
+ConnectionError ReceiveBuffer::fill_from(Connection& conn) noexcept
+{
+  may_have_more_ = false;
+  if (!make_room()) { return ConnectionError::unrecoverable; }
+  const auto space = data_.size() - end_;
+  std::size_t bytes_read = 0;
+  const auto err = conn.read_available(data_.data() + end_, space, bytes_read);
+  end_ += bytes_read;
+  may_have_more_ = err == ConnectionError::no_error && bytes_read == space;
+  return err;
+}
+
+std::optional<gsl::span<const std::byte>> ReceiveBuffer::next_frame() noexcept
+{
+  const auto available = end_ - begin_;
+  const auto frame_size = next_frame_size();
+  if (available < header_size || available < frame_size) { return {}; }
+  const gsl::span<const std::byte> to_ret{
+    data_.data() + begin_ + header_size, static_cast<gsl::index>(frame_size - header_size)};
+  last_frame_flags_ = std::to_integer<std::uint8_t>(data_[begin_ + frame_flags_offset]);
+  begin_ += frame_size;
+  return to_ret;
+}
+
+std::uint8_t ReceiveBuffer::last_frame_flags() const noexcept { return last_frame_flags_; }
+
+bool ReceiveBuffer::may_have_more() const noexcept { return may_have_more_; }
+
+std::size_t ReceiveBuffer::size() const noexcept { return end_ - begin_; }
+
+bool ReceiveBuffer::make_room() noexcept
+{
+  if (begin_ == end_) {
+    begin_ = 0;
+    end_ = 0;
+  }
+  const auto frame_size = next_frame_size();
+  if (frame_size > max_frame_size + header_size) {
+    SKYNET_WARN_LOG("Peer announced a frame of {} bytes, which is over the limit of {}", frame_size, max_frame_size);
+    return false;
+  }
+  const auto required = std::max(frame_size, min_read_size);
+  if (data_.size() - begin_ < required || data_.size() - end_ < min_read_size) {
+    // Shift the unparsed data to the front
+    if (begin_ != 0) {
+      std::memmove(data_.data(), data_.data() + begin_, end_ - begin_);
+      end_ -= begin_;
+      begin_ = 0;
+    }
+    if (data_.size() < required || data_.size() - end_ < min_read_size) {
+      data_.resize(std::max({required, initial_capacity, data_.size() * 2}));
+    }
+  }
+  return true;
+}
+
+std::size_t ReceiveBuffer::next_frame_size() const noexcept
+{
+  if (end_ - begin_ < header_size) { return header_size; }
+  std::array<std::byte, sizeof(NetworkSizeType)> size_bytes;
+  std::memcpy(size_bytes.data(), data_.data() + begin_, size_bytes.size());
+  return header_size + from_network_bytes(size_bytes);
+}
+} // namespace skywing::internal
@@ -0,0 +1,85 @@
+#ifndef SKYNET_INTERNAL_DEVICES_RECEIVE_BUFFER_HPP
+#define SKYNET_INTERNAL_DEVICES_RECEIVE_BUFFER_HPP
+
+#include "skywing_core/internal/devices/communicator.hpp"
+#include "skywing_core/internal/devices/shared_memory_ring.hpp"
+
+#include "gsl/span"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace skywing::internal {
+/** \brief Reusable buffer for the data received on a connection
+ *
+ * Each fill() reads as much as the socket has available into the free space
+ * of the buffer with a single call, and next_frame() then hands out every
+ * complete size-prefixed frame as a view into the buffer.  A frame that has
+ * only partially arrived is kept and completed by later fills.
+ *
+ * The storage is linear rather than circular so that every frame is
+ * contiguous; unparsed bytes are moved to the front when space runs low.
+ * Frames sent by this library are a whole number of words, so the views are
+ * word-aligned and can be decoded in place.  Views returned by next_frame()
+ * are invalidated by the next call to fill(), but stay valid if the buffer is
+ * moved.
+ */
+class ReceiveBuffer {
+public:
+  /** \brief Reads available data from the connection into the buffer
+   *
+   * \return no_error if anything was read, otherwise the error from the
+   * connection.  Also returns unrecoverable if the peer announced a frame
+   * larger than max_frame_size.
+   */
+  ConnectionError fill(Communicator& conn) noexcept;
+
+  /** \brief Reads available data from a shared memory ring into the buffer
+   */
+  ConnectionError fill(SharedMemoryRing& ring) noexcept;
+
+  /** \brief Returns the contents of the next complete frame, if there is one
+   */
+  std::optional<gsl::span<const std::byte>> next_frame() noexcept;
+
+  /** \brief Returns the flags from the header of the frame last returned by
+   * next_frame()
+   */
+  std::uint8_t last_frame_flags() const noexcept;
+
+  /** \brief Returns true if the last fill used up all of the free space, so
+   * there may be more data waiting on the connection
+   */
+  bool may_have_more() const noexcept;
+
+  /** \brief Returns the number of bytes received but not yet handed out
+   */
+  std::size_t size() const noexcept;
+
+  /// The largest frame that will be accepted from a peer
+  static constexpr std::size_t max_frame_size = std::size_t{1} << 30;
+
+private:
+  template<typename Connection>
+  ConnectionError fill_from(Connection& conn) noexcept;
+
+  // Makes sure there is space to read into, and that the frame currently
+  // being received will fit in the buffer once it has fully arrived
+  bool make_room() noexcept;
+
+  // Returns the total size of the next frame including the size prefix, or
+  // just the size of the prefix if it hasn't arrived yet
+  std::size_t next_frame_size() const noexcept;
+
+  std::vector<std::byte> data_;
+  // Unparsed data is in [begin_, end_)
+  std::size_t begin_ = 0;
+  std::size_t end_ = 0;
+  bool may_have_more_ = false;
+  std::uint8_t last_frame_flags_ = 0;
+}; // class ReceiveBuffer
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_DEVICES_RECEIVE_BUFFER_HPP
@@ -0,0 +1,195 @@
+#include "skywing_core/internal/devices/send_queue.hpp"
+
+#include <array>
+
+namespace skywing::internal {
+void SendQueue::push(
+  SharedFrame frame, const std::chrono::steady_clock::time_point now, const bool rate_limited) noexcept
+{
+  std::lock_guard lock{mutex_};
+  if (frames_.empty()) { oldest_queued_time_ = now; }
+  bytes_ += frame->size();
+  if (rate_limited) { ++unadmitted_frames_; }
+  frames_.push_back(QueuedFrame{std::move(frame), nullptr, rate_limited});
+}
+
+bool SendQueue::push_replacing(
+  const std::string& key, SharedFrame frame, const std::chrono::steady_clock::time_point now) noexcept
+{
+  std::lock_guard lock{mutex_};
+  const auto found = replaceable_.find(key);
+  if (found != replaceable_.end() && (found->second != frames_.begin() || front_offset_ == 0)) {
+    auto& queued = *found->second;
+    bytes_ = bytes_ - queued.frame->size() + frame->size();
+    queued.frame = std::move(frame);
+    ++replaced_frames_;
+    return true;
+  }
+  // A partly written frame is left to finish, with the new one replacing it as the latest
+  if (frames_.empty()) { oldest_queued_time_ = now; }
+  bytes_ += frame->size();
+  ++unadmitted_frames_;
+  const auto iter = frames_.insert(frames_.end(), QueuedFrame{std::move(frame), nullptr, true});
+  // The partly written frame keeps pointing at the key, which outlives it as
+  // the new frame can't be sent first
+  iter->key = &replaceable_.insert_or_assign(key, iter).first->first;
+  return false;
+}
+
+SendQueue::FrameList::iterator SendQueue::erase(const FrameList::iterator iter) noexcept
+{
+  if (iter->key != nullptr) {
+    // The key may have moved on to a later frame
+    const auto found = replaceable_.find(*iter->key);
+    if (found->second == iter) { replaceable_.erase(found); }
+  }
+  return frames_.erase(iter);
+}
+
+std::size_t SendQueue::admit_frames(const AdmitFrame& admit) noexcept
+{
+  std::size_t held = 0;
+  for (auto& queued : frames_) {
+    if (can_write(queued)) { continue; }
+    // Once one is refused the rest wait too, which keeps them in order
+    if (held == 0 && (!admit || admit(queued.frame->size()))) {
+      queued.admitted = true;
+      --unadmitted_frames_;
+    }
+    else {
+      ++held;
+    }
+  }
+  return held;
+}
+
+ConnectionError SendQueue::flush(Communicator& conn, Reactor& reactor, const AdmitFrame& admit) noexcept
+{
+  std::lock_guard lock{mutex_};
+  held_frames_ = admit_frames(admit);
+  // Connections within the process take the frames themselves rather than a copy
+  for (auto iter = frames_.begin(); iter != frames_.end() && front_offset_ == 0;) {
+    if (!can_write(*iter)) {
+      ++iter;
+      continue;
+    }
+    if (!conn.send_shared_frame(iter->frame)) { break; }
+    bytes_ -= iter->frame->size();
+    iter = erase(iter);
+  }
+  const auto err = write_frames(conn);
+  const bool wants_write = err == ConnectionError::would_block;
+  if (wants_write != wants_write_) {
+    wants_write_ = wants_write;
+    reactor.watch(conn.native_handle(), wants_write);
+  }
+  return err;
+}
+
+ConnectionError SendQueue::flush(SharedMemoryRing& ring, const AdmitFrame& admit) noexcept
+{
+  std::lock_guard lock{mutex_};
+  held_frames_ = admit_frames(admit);
+  const auto err = write_frames(ring);
+  // There's nothing to watch for a ring having space; the owner has to retry
+  wants_write_ = err == ConnectionError::would_block;
+  return err;
+}
+
+template<typename Connection>
+ConnectionError SendQueue::write_frames(Connection& conn) noexcept
+{
+  // Number of frames handed to the connection per call
+  constexpr std::size_t frames_per_send = 32;
+  auto err = ConnectionError::no_error;
+  while (true) {
+    std::array<gsl::span<const std::byte>, frames_per_send> buffers;
+    std::array<FrameList::iterator, frames_per_send> written;
+    std::size_t num_buffers = 0;
+    std::size_t bytes_attempted = 0;
+    for (auto iter = frames_.begin(); iter != frames_.end() && num_buffers < frames_per_send; ++iter) {
+      if (!can_write(*iter)) { continue; }
+      // Only the front frame can have been partly written
+      const auto offset = iter == frames_.begin() ? front_offset_ : 0;
+      const auto& frame = *iter->frame;
+      buffers[num_buffers] = gsl::span<const std::byte>{
+        frame.data() + offset, static_cast<gsl::index>(frame.size() - offset)};
+      written[num_buffers] = iter;
+      bytes_attempted += frame.size() - offset;
+      ++num_buffers;
+    }
+    if (num_buffers == 0) { break; }
+    std::size_t bytes_sent = 0;
+    err = conn.send_buffers(
+      gsl::span<const gsl::span<const std::byte>>{buffers.data(), static_cast<gsl::index>(num_buffers)}, bytes_sent);
+    if (err != ConnectionError::no_error) { break; }
+    const bool short_write = bytes_sent < bytes_attempted;
+    // Drop everything that was fully sent, remembering how far into the next frame it got
+    bytes_ -= bytes_sent;
+    auto consumed = front_offset_ + bytes_sent;
+    std::size_t num_sent = 0;
+    while (num_sent < num_buffers && consumed >= written[num_sent]->frame->size()) {
+      consumed -= written[num_sent]->frame->size();
+      erase(written[num_sent]);
+      ++num_sent;
+    }
+    front_offset_ = consumed;
+    // Moved in front of anything held back so that it is resumed first
+    if (consumed != 0) { frames_.splice(frames_.begin(), frames_, written[num_sent]); }
+    // The connection is full; wait for it to drain
+    if (short_write) {
+      err = ConnectionError::would_block;
+      break;
+    }
+  }
+  return err;
+}
+
+bool SendQueue::empty() const noexcept
+{
+  std::lock_guard lock{mutex_};
+  return frames_.empty();
+}
+
+std::size_t SendQueue::size() const noexcept
+{
+  std::lock_guard lock{mutex_};
+  return frames_.size();
+}
+
+std::size_t SendQueue::bytes() const noexcept
+{
+  std::lock_guard lock{mutex_};
+  return bytes_;
+}
+
+std::chrono::steady_clock::time_point SendQueue::oldest_queued_time() const noexcept
+{
+  std::lock_guard lock{mutex_};
+  return oldest_queued_time_;
+}
+
+bool SendQueue::is_blocked() const noexcept
+{
+  std::lock_guard lock{mutex_};
+  return wants_write_;
+}
+
+std::size_t SendQueue::held_frames() const noexcept
+{
+  std::lock_guard lock{mutex_};
+  return held_frames_;
+}
+
+std::size_t SendQueue::unadmitted_frames() const noexcept
+{
+  std::lock_guard lock{mutex_};
+  return unadmitted_frames_;
+}
+
+std::size_t SendQueue::replaced_frames() const noexcept
+{
+  std::lock_guard lock{mutex_};
+  return replaced_frames_;
+}
+} // namespace skywing::internal
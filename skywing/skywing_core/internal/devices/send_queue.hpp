@@ -0,0 +1,177 @@
+#ifndef SKYNET_INTERNAL_DEVICES_SEND_QUEUE_HPP
+#define SKYNET_INTERNAL_DEVICES_SEND_QUEUE_HPP
+
+#include "skywing_core/internal/devices/communicator.hpp"
+#include "skywing_core/internal/devices/reactor.hpp"
+#include "skywing_core/internal/devices/shared_memory_ring.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace skywing::internal {
+/** \brief Decides whether a rate limited frame of the given size can be sent
+ * now, taking its cost if it can
+ *
+ * Besides the rate limits this is where frames wait for the receiver to grant
+ * credits for them.
+ */
+using AdmitFrame = std::function<bool(std::size_t)>;
+
+/** \brief Outbound queue of framed messages for a single connection
+ *
+ * Messages are written with gathered sends, and a partially written message is
+ * resumed from where it left off on the next flush.  While data is left over
+ * the connection is registered for writability with the reactor so the manager
+ * wakes up once the socket can take more.
+ *
+ * Frames pushed with a key replace the frame with the same key that is still
+ * waiting to be sent, so that only the latest value published on a tag is
+ * queued however far behind the connection is.
+ *
+ * Frames can be rate limited, in which case a flush holds them back until it
+ * is allowed to send them.  Frames that aren't limited are sent past any that
+ * are held back, while the limited ones stay in order among themselves.
+ *
+ * Guarded by its own mutex so that it is safe to use on its own.  The state
+ * around it in the manager, such as the rate limiters and credits a flush
+ * consults, is not, so the manager only pushes and flushes with its job lock
+ * held or from its own thread.
+ */
+class SendQueue {
+public:
+  /** \brief Adds a frame to the back of the queue
+   *
+   * \param frame The frame to send
+   * \param now The current time, for when the queue was last empty
+   * \param rate_limited If the frame is held back while over the rate limit
+   */
+  void push(
+    SharedFrame frame,
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now(),
+    bool rate_limited = false) noexcept;
+
+  /** \brief Replaces the unsent frame pushed with the same key, or adds the
+   * frame to the back of the queue if there isn't one
+   *
+   * A replaced frame keeps its place in the queue.  A frame that has been
+   * partly written can't be replaced, so the new one goes to the back instead.
+   * Frames pushed this way are rate limited.
+   *
+   * \param key What the frame replaces; frames with different keys are independent
+   * \param frame The frame to send
+   * \param now The current time, for when the queue was last empty
+   * \return true if a queued frame was replaced
+   */
+  bool push_replacing(
+    const std::string& key,
+    SharedFrame frame,
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now()) noexcept;
+
+  /** \brief Writes as much of the queue as the connection will accept
+   *
+   * \param admit Called for each rate limited frame before it is first
+   * written; once it refuses one the rest wait for a later flush.  Everything
+   * is sent if it is empty.
+   * \return no_error if everything that could be sent was fully written,
+   * would_block if data remains, or the error that occurred on the connection
+   */
+  ConnectionError flush(Communicator& conn, Reactor& reactor, const AdmitFrame& admit = {}) noexcept;
+
+  /** \brief Writes as much of the queue as the ring has space for
+   *
+   * \param admit As for sockets
+   */
+  ConnectionError flush(SharedMemoryRing& ring, const AdmitFrame& admit = {}) noexcept;
+
+  /** \brief Returns true if there is nothing waiting to be sent
+   */
+  bool empty() const noexcept;
+
+  /** \brief Returns the number of messages that haven't been completely sent
+   */
+  std::size_t size() const noexcept;
+
+  /** \brief Returns the number of bytes that haven't been sent
+   */
+  std::size_t bytes() const noexcept;
+
+  /** \brief Returns the time at which the queue last went from empty to
+   * having something in it
+   *
+   * \pre The queue isn't empty
+   */
+  std::chrono::steady_clock::time_point oldest_queued_time() const noexcept;
+
+  /** \brief Returns true if the last flush was stopped by the connection
+   * not accepting any more data
+   */
+  bool is_blocked() const noexcept;
+
+  /** \brief Returns the number of frames the last flush held back for the rate
+   * limit; they are included in size()
+   */
+  std::size_t held_frames() const noexcept;
+
+  /** \brief Returns the number of rate limited frames that haven't been let
+   * through yet, whether the last flush held them back or they were pushed
+   * since
+   *
+   * Unlike held_frames() this is up to date between flushes.
+   */
+  std::size_t unadmitted_frames() const noexcept;
+
+  /** \brief Returns the number of frames that have been replaced before being sent
+   */
+  std::size_t replaced_frames() const noexcept;
+
+private:
+  struct QueuedFrame {
+    SharedFrame frame;
+    // The key in replaceable_ if the frame can be replaced
+    const std::string* key = nullptr;
+    bool rate_limited = false;
+    // Limited frames are only admitted once, even if they take several flushes to write
+    bool admitted = false;
+  };
+  using FrameList = std::list<QueuedFrame>;
+
+  // Admits limited frames until one is refused, returning the number left waiting
+  // Must be called with mutex_ held
+  std::size_t admit_frames(const AdmitFrame& admit) noexcept;
+
+  // Writes frames until the queue is empty or the connection is full
+  // Must be called with mutex_ held
+  template<typename Connection>
+  ConnectionError write_frames(Connection& conn) noexcept;
+
+  // Removes a frame once it has been sent
+  // Must be called with mutex_ held
+  FrameList::iterator erase(FrameList::iterator iter) noexcept;
+
+  static bool can_write(const QueuedFrame& queued) noexcept { return !queued.rate_limited || queued.admitted; }
+
+  mutable std::mutex mutex_;
+  // A list so that frames can be sent past ones being held back
+  FrameList frames_;
+  // Bytes of the front frame that have already been sent
+  std::size_t front_offset_ = 0;
+  std::size_t bytes_ = 0;
+  // The latest frame pushed with each key that is still queued
+  std::unordered_map<std::string, FrameList::iterator> replaceable_;
+  std::size_t replaced_frames_ = 0;
+  std::size_t held_frames_ = 0;
+  std::size_t unadmitted_frames_ = 0;
+  std::chrono::steady_clock::time_point oldest_queued_time_;
+  // If the connection is currently registered for writability
+  bool wants_write_ = false;
+}; // class SendQueue
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_DEVICES_SEND_QUEUE_HPP
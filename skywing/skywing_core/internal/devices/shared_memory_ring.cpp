@@ -0,0 +1,250 @@
+#include "skywing_core/internal/devices/shared_memory_ring.hpp"
+
+#include "skywing_core/internal/utility/logging.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace skywing::internal {
+namespace {
+// Written at the start of the segment to catch opening something that isn't a ring
+constexpr std::uint64_t ring_magic = 0x534b'5957'5249'4e47;
+
+// Keep the producer and consumer positions on separate cache lines
+constexpr std::size_t cache_line_size = 64;
+
+constexpr std::size_t min_capacity = 0x1000;
+constexpr std::size_t max_capacity = std::size_t{1} << 30;
+
+std::string make_ring_name() noexcept
+{
+  // Names have to be unique on the host; kept short as some systems limit them to 31 characters
+  static std::atomic<std::uint32_t> counter{0};
+  return "/skywing." + std::to_string(::getpid()) + '.' + std::to_string(counter++);
+}
+
+std::size_t round_up_capacity(const std::size_t capacity) noexcept
+{
+  std::size_t to_ret = min_capacity;
+  while (to_ret < capacity && to_ret < max_capacity) {
+    to_ret *= 2;
+  }
+  return to_ret;
+}
+} // namespace
+
+struct SharedMemoryRing::Header {
+  std::uint64_t magic;
+  std::uint64_t capacity;
+  // Total number of bytes ever written; only modified by the writer
+  alignas(cache_line_size) std::atomic<std::uint64_t> head;
+  // Total number of bytes ever read; only modified by the reader
+  alignas(cache_line_size) std::atomic<std::uint64_t> tail;
+  alignas(cache_line_size) std::atomic<std::uint32_t> reader_sleeping;
+  std::atomic<std::uint32_t> writer_closed;
+  std::atomic<std::uint32_t> reader_closed;
+};
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Rings require lock-free atomics");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Rings require lock-free atomics");
+
+std::optional<SharedMemoryRing> SharedMemoryRing::create(const std::size_t capacity) noexcept
+{
+  const auto actual_capacity = round_up_capacity(capacity);
+  const auto total_size = sizeof(Header) + actual_capacity;
+  auto name = make_ring_name();
+  const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    const int error = errno;
+    SKYNET_WARN_LOG("Failed to create shared memory segment \"{}\": {}", name, std::strerror(error));
+    return {};
+  }
+  if (::ftruncate(fd, static_cast<off_t>(total_size)) != 0) {
+    const int error = errno;
+    SKYNET_WARN_LOG("Failed to size shared memory segment \"{}\": {}", name, std::strerror(error));
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    return {};
+  }
+  void* const memory = ::mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    const int error = errno;
+    SKYNET_WARN_LOG("Failed to map shared memory segment \"{}\": {}", name, std::strerror(error));
+    ::shm_unlink(name.c_str());
+    return {};
+  }
+  auto* const header = new (memory) Header;
+  header->capacity = actual_capacity;
+  header->head.store(0, std::memory_order_relaxed);
+  header->tail.store(0, std::memory_order_relaxed);
+  header->reader_sleeping.store(0, std::memory_order_relaxed);
+  header->writer_closed.store(0, std::memory_order_relaxed);
+  header->reader_closed.store(0, std::memory_order_relaxed);
+  header->magic = ring_magic;
+  return SharedMemoryRing{Mapped{}, std::move(name), header, actual_capacity, true};
+}
+
+std::optional<SharedMemoryRing> SharedMemoryRing::open(const std::string& name, const std::size_t capacity) noexcept
+{
+  if (capacity < min_capacity || capacity > max_capacity || (capacity & (capacity - 1)) != 0) {
+    SKYNET_WARN_LOG("Refusing to open shared memory segment \"{}\" with invalid capacity {}", name, capacity);
+    return {};
+  }
+  const auto total_size = sizeof(Header) + capacity;
+  const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    const int error = errno;
+    SKYNET_WARN_LOG("Failed to open shared memory segment \"{}\": {}", name, std::strerror(error));
+    return {};
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) != total_size) {
+    SKYNET_WARN_LOG("Shared memory segment \"{}\" is not the expected size", name);
+    ::close(fd);
+    return {};
+  }
+  void* const memory = ::mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    const int error = errno;
+    SKYNET_WARN_LOG("Failed to map shared memory segment \"{}\": {}", name, std::strerror(error));
+    return {};
+  }
+  auto* const header = static_cast<Header*>(memory);
+  if (header->magic != ring_magic || header->capacity != capacity) {
+    SKYNET_WARN_LOG("Shared memory segment \"{}\" is not a ring", name);
+    ::munmap(memory, total_size);
+    return {};
+  }
+  return SharedMemoryRing{Mapped{}, name, header, capacity, false};
+}
+
+SharedMemoryRing::SharedMemoryRing(
+  Mapped, std::string name, Header* const header, const std::size_t capacity, const bool is_writer) noexcept
+  : name_{std::move(name)}, header_{header}, capacity_{capacity}, is_writer_{is_writer}, owns_name_{is_writer}
+{}
+
+SharedMemoryRing::SharedMemoryRing(SharedMemoryRing&& other) noexcept
+  : name_{std::move(other.name_)}
+  , header_{std::exchange(other.header_, nullptr)}
+  , capacity_{other.capacity_}
+  , is_writer_{other.is_writer_}
+  , owns_name_{std::exchange(other.owns_name_, false)}
+{}
+
+SharedMemoryRing& SharedMemoryRing::operator=(SharedMemoryRing&& other) noexcept
+{
+  using std::swap;
+  swap(name_, other.name_);
+  swap(header_, other.header_);
+  swap(capacity_, other.capacity_);
+  swap(is_writer_, other.is_writer_);
+  swap(owns_name_, other.owns_name_);
+  return *this;
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+  if (!header_) { return; }
+  (is_writer_ ? header_->writer_closed : header_->reader_closed).store(1, std::memory_order_release);
+  ::munmap(header_, sizeof(Header) + capacity_);
+  unlink();
+}
+
+const std::string& SharedMemoryRing::name() const noexcept { return name_; }
+
+std::size_t SharedMemoryRing::capacity() const noexcept { return capacity_; }
+
+void SharedMemoryRing::unlink() noexcept
+{
+  if (owns_name_) {
+    ::shm_unlink(name_.c_str());
+    owns_name_ = false;
+  }
+}
+
+ConnectionError SharedMemoryRing::send_buffers(
+  const gsl::span<const gsl::span<const std::byte>> buffers, std::size_t& bytes_sent) noexcept
+{
+  bytes_sent = 0;
+  if (header_->reader_closed.load(std::memory_order_acquire)) { return ConnectionError::closed; }
+  const auto head = header_->head.load(std::memory_order_relaxed);
+  const auto tail = header_->tail.load(std::memory_order_acquire);
+  const auto used = static_cast<std::size_t>(head - tail);
+  // The reader is the other process, so don't trust it to keep its tail in range
+  if (used > capacity_) {
+    SKYNET_WARN_LOG("Shared memory ring \"{}\" has a tail outside of it; treating it as broken", name_);
+    return ConnectionError::closed;
+  }
+  const std::size_t space = capacity_ - used;
+  if (space == 0) { return ConnectionError::would_block; }
+  for (const auto& buffer : buffers) {
+    const auto to_write = std::min(static_cast<std::size_t>(buffer.size()), space - bytes_sent);
+    // Copy in up to two pieces in case it wraps around the end
+    const auto offset = static_cast<std::size_t>(head + bytes_sent) & (capacity_ - 1);
+    const auto first_part = std::min(to_write, capacity_ - offset);
+    std::memcpy(data() + offset, buffer.data(), first_part);
+    std::memcpy(data(), buffer.data() + first_part, to_write - first_part);
+    bytes_sent += to_write;
+    if (bytes_sent == space) { break; }
+  }
+  // Sequentially consistent so the reader's sleep flag is checked after the data is visible
+  header_->head.store(head + bytes_sent, std::memory_order_seq_cst);
+  return ConnectionError::no_error;
+}
+
+ConnectionError
+  SharedMemoryRing::read_available(std::byte* const buffer, const std::size_t size, std::size_t& bytes_read) noexcept
+{
+  bytes_read = 0;
+  // Clearly awake, so no need to be notified
+  header_->reader_sleeping.store(0, std::memory_order_relaxed);
+  // Check for closing first so that anything written before closing is still read
+  const bool writer_closed = header_->writer_closed.load(std::memory_order_acquire);
+  const auto tail = header_->tail.load(std::memory_order_relaxed);
+  const auto head = header_->head.load(std::memory_order_acquire);
+  if (head == tail) { return writer_closed ? ConnectionError::closed : ConnectionError::would_block; }
+  const auto available = static_cast<std::size_t>(head - tail);
+  // A head more than a full ring ahead can only come from a broken or hostile
+  // writer, and reading it would copy from past the end of the data
+  if (available > capacity_) {
+    SKYNET_WARN_LOG("Shared memory ring \"{}\" has a head outside of it; treating it as broken", name_);
+    return ConnectionError::closed;
+  }
+  bytes_read = std::min(size, available);
+  const auto offset = static_cast<std::size_t>(tail) & (capacity_ - 1);
+  const auto first_part = std::min(bytes_read, capacity_ - offset);
+  std::memcpy(buffer, data() + offset, first_part);
+  std::memcpy(buffer + first_part, data(), bytes_read - first_part);
+  header_->tail.store(tail + bytes_read, std::memory_order_release);
+  return ConnectionError::no_error;
+}
+
+bool SharedMemoryRing::has_data() const noexcept
+{
+  return header_->head.load(std::memory_order_seq_cst) != header_->tail.load(std::memory_order_relaxed);
+}
+
+bool SharedMemoryRing::prepare_to_sleep() noexcept
+{
+  header_->reader_sleeping.store(1, std::memory_order_seq_cst);
+  return !has_data();
+}
+
+bool SharedMemoryRing::take_wakeup_request() noexcept
+{
+  if (header_->reader_sleeping.load(std::memory_order_seq_cst) == 0) { return false; }
+  return header_->reader_sleeping.exchange(0, std::memory_order_seq_cst) == 1;
+}
+
+std::byte* SharedMemoryRing::data() const noexcept { return reinterpret_cast<std::byte*>(header_ + 1); }
+} // namespace skywing::internal
@@ -0,0 +1,118 @@
+#ifndef SKYNET_INTERNAL_DEVICES_SHARED_MEMORY_RING_HPP
+#define SKYNET_INTERNAL_DEVICES_SHARED_MEMORY_RING_HPP
+
+#include "skywing_core/internal/devices/communicator.hpp"
+
+#include "gsl/span"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace skywing::internal {
+/** \brief Single-producer single-consumer byte stream through POSIX shared memory
+ *
+ * Used in place of a loopback socket between agents on the same host so that
+ * messages don't have to go through the kernel.  One side creates the ring and
+ * writes to it, and the other opens it by name and reads from it.  Reads and
+ * writes behave like they do on a non-blocking socket: as much as fits is
+ * transferred and would_block is returned if nothing could be.
+ *
+ * The ring has no way to wake a reader that is blocked on something else, so
+ * the reader calls prepare_to_sleep() before blocking, and the writer checks
+ * take_wakeup_request() after writing and notifies the reader by other means
+ * if it returns true.
+ */
+class SharedMemoryRing {
+public:
+  /** \brief Creates a new ring for writing to
+   *
+   * \param capacity The number of bytes the ring can hold; rounded up to a power of two
+   */
+  static std::optional<SharedMemoryRing> create(std::size_t capacity) noexcept;
+
+  /** \brief Opens a ring created by another process for reading from
+   */
+  static std::optional<SharedMemoryRing> open(const std::string& name, std::size_t capacity) noexcept;
+
+  // Can not be copied
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+  // Can be moved
+  SharedMemoryRing(SharedMemoryRing&&) noexcept;
+  SharedMemoryRing& operator=(SharedMemoryRing&&) noexcept;
+
+  /** \brief Unmaps the ring, marking it as closed for the other side
+   */
+  ~SharedMemoryRing();
+
+  /** \brief The name the ring can be opened with
+   */
+  const std::string& name() const noexcept;
+
+  /** \brief The number of bytes the ring can hold
+   */
+  std::size_t capacity() const noexcept;
+
+  /** \brief Removes the name of the ring so nothing else can open it
+   *
+   * The memory stays around until both sides have closed it, so this should
+   * be called once the other side has opened it.
+   */
+  void unlink() noexcept;
+
+  /** \brief Writes as much of several buffers as will fit
+   *
+   * \param buffers The buffers to write, in order
+   * \param bytes_sent Set to the total number of bytes written
+   * \return no_error if anything was written, would_block if the ring is
+   * full, or closed if the reader has gone away
+   */
+  ConnectionError
+    send_buffers(gsl::span<const gsl::span<const std::byte>> buffers, std::size_t& bytes_sent) noexcept;
+
+  /** \brief Reads whatever is in the ring, up to size bytes
+   *
+   * \return no_error if anything was read, would_block if the ring is empty,
+   * or closed if it is empty and the writer has gone away
+   */
+  ConnectionError read_available(std::byte* buffer, std::size_t size, std::size_t& bytes_read) noexcept;
+
+  /** \brief Returns true if there is data waiting to be read
+   */
+  bool has_data() const noexcept;
+
+  /** \brief Called by the reader before blocking; asks the writer to notify it
+   * when more data is written
+   *
+   * \return false if there is already data to read, in which case the reader
+   * shouldn't block
+   */
+  bool prepare_to_sleep() noexcept;
+
+  /** \brief Called by the writer after writing; returns true if the reader
+   * asked to be notified, clearing the request
+   */
+  bool take_wakeup_request() noexcept;
+
+private:
+  struct Header;
+
+  // Tag for the constructor that takes an already mapped segment
+  struct Mapped {};
+  SharedMemoryRing(Mapped, std::string name, Header* header, std::size_t capacity, bool is_writer) noexcept;
+
+  std::byte* data() const noexcept;
+
+  std::string name_;
+  Header* header_ = nullptr;
+  std::size_t capacity_ = 0;
+  bool is_writer_ = false;
+  // If the name still needs to be unlinked by this side
+  bool owns_name_ = false;
+}; // class SharedMemoryRing
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_DEVICES_SHARED_MEMORY_RING_HPP
@@ -0,0 +1,36 @@
+#include "skywing_core/internal/devices/simulated_links.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace skywing::internal {
+SimulatedLinks::SimulatedLinks(const Clock& clock, LatencyModel latency) noexcept
+  : clock_{&clock}, latency_{std::move(latency)}
+{}
+
+const Clock& SimulatedLinks::clock() const noexcept { return *clock_; }
+
+Clock::time_point SimulatedLinks::schedule(
+  const std::uint16_t from,
+  const std::uint16_t to,
+  const std::size_t bytes,
+  const Clock::time_point not_before) noexcept
+{
+  const auto delivery = std::max(
+    clock_->now() + std::chrono::duration_cast<Clock::time_point::duration>(latency_(from, to, bytes)), not_before);
+  std::lock_guard lock{mutex_};
+  deliveries_.push(delivery);
+  return delivery;
+}
+
+std::optional<Clock::time_point> SimulatedLinks::next_delivery() noexcept
+{
+  const auto now = clock_->now();
+  std::lock_guard lock{mutex_};
+  while (!deliveries_.empty() && deliveries_.top() <= now) {
+    deliveries_.pop();
+  }
+  if (deliveries_.empty()) { return std::nullopt; }
+  return deliveries_.top();
+}
+} // namespace skywing::internal
@@ -0,0 +1,70 @@
+#ifndef SKYNET_INTERNAL_DEVICES_SIMULATED_LINKS_HPP
+#define SKYNET_INTERNAL_DEVICES_SIMULATED_LINKS_HPP
+
+#include "skywing_core/internal/utility/clock.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace skywing::internal {
+/** \brief How long a frame takes to get from one port to another
+ *
+ * Called with the port of the sending and receiving instance and the size of
+ * the frame in bytes.  May be called from any thread.
+ */
+using LatencyModel = std::function<std::chrono::nanoseconds(std::uint16_t, std::uint16_t, std::size_t)>;
+
+/** \brief Delays in-process frames according to a virtual clock
+ *
+ * Shared by every connection of a simulation.  Frames become readable once the
+ * clock reaches their delivery time, and the times that are still to come are
+ * kept so the simulation knows how far it can move the clock.
+ */
+class SimulatedLinks {
+public:
+  /** \brief Creates the links
+   *
+   * \param clock The clock that frames are delivered by
+   * \param latency The delay for each frame
+   */
+  SimulatedLinks(const Clock& clock, LatencyModel latency) noexcept;
+
+  // Can not be copied or moved; connections refer to it
+  SimulatedLinks(const SimulatedLinks&) = delete;
+  SimulatedLinks& operator=(const SimulatedLinks&) = delete;
+
+  /** \brief Returns the clock frames are delivered by
+   */
+  const Clock& clock() const noexcept;
+
+  /** \brief Returns when a frame sent now will be delivered and records it
+   *
+   * \param from The port of the sender
+   * \param to The port of the receiver
+   * \param bytes The size of the frame
+   * \param not_before The delivery time of the previous frame on the connection,
+   * as connections don't reorder frames
+   */
+  Clock::time_point
+    schedule(std::uint16_t from, std::uint16_t to, std::size_t bytes, Clock::time_point not_before) noexcept;
+
+  /** \brief Returns the earliest delivery time that is still in the future
+   */
+  std::optional<Clock::time_point> next_delivery() noexcept;
+
+private:
+  const Clock* clock_;
+  LatencyModel latency_;
+
+  std::mutex mutex_;
+  std::priority_queue<Clock::time_point, std::vector<Clock::time_point>, std::greater<>> deliveries_;
+}; // class SimulatedLinks
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_DEVICES_SIMULATED_LINKS_HPP
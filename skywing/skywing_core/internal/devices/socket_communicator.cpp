@@ -8,64 +8,62 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <netdb.h>
 #include <netinet/in.h>
 #include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <utility>
 
 namespace {
 constexpr int invalid_handle = -1;
 
-struct addrinfo_deleter {
-  void operator()(addrinfo* info) const noexcept { freeaddrinfo(info); }
-};
-
-using addrinfo_ptr = std::unique_ptr<addrinfo, addrinfo_deleter>;
-
-addrinfo_ptr resolve_addr(const char* const address, const std::uint16_t port) noexcept
-{
-  addrinfo* result;
-  addrinfo hints;
-  std::memset(&hints, 0, sizeof(hints));
-  hints.ai_family = AF_INET;
-  hints.ai_socktype = SOCK_STREAM;
-  hints.ai_protocol = IPPROTO_IP;
-  const auto port_str = std::to_string(port);
-  const auto resaddr = getaddrinfo(address, port_str.c_str(), &hints, &result);
-  if (resaddr != 0) {
-    std::perror("resolve_addr - resaddr");
-    std::exit(4);
-  }
-  return {result, {}};
-}
-
+// Host names have to be looked up with an AddressResolver first, as looking
+// them up here would block
 int init_connection(const int sockfd, const char* const address, const std::uint16_t port) noexcept
 {
-  // TODO: What is the correct address-acquisition approach?
-  
-  // This isn't super robust, but I'm not sure how to handle looking up a bunch of different
-  // address in an asynchronous context
-  //const auto result = resolve_addr(address, port);
-  //return connect(sockfd, result->ai_addr, static_cast<int>(result->ai_addrlen));
   struct sockaddr_in serv_addr;
   serv_addr.sin_family = AF_INET;
   serv_addr.sin_port = htons(port);
   if (inet_pton(AF_INET, address, &serv_addr.sin_addr) <= 0)
   {
     SKYNET_ERROR_LOG("Invalid address {}", address);
-    std::exit(4);
+    errno = EINVAL;
+    return -1;
   }
   return connect(sockfd, (struct sockaddr *)&serv_addr, sizeof(serv_addr));
 }
+
+// Fills in the address for a local socket name, returning its length or 0 if the name is too long
+// Names starting with a null are in the abstract namespace and aren't null-terminated
+socklen_t make_local_address(const std::string& name, sockaddr_un& addr) noexcept
+{
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  const bool is_abstract = !name.empty() && name[0] == '\0';
+  const auto size = name.size() + (is_abstract ? 0 : 1);
+  if (name.empty() || size > sizeof(addr.sun_path)) { return 0; }
+  std::memcpy(addr.sun_path, name.data(), name.size());
+  return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + size);
+}
+
+// What local sockets report as their address
+skywing::AddrPortPair local_address() noexcept { return {"127.0.0.1", 0}; }
 } // namespace
 
 namespace skywing::internal {
-SocketCommunicator::SocketCommunicator() noexcept : handle_{create_non_blocking()}
+SocketCommunicator::SocketCommunicator() noexcept : SocketCommunicator{SocketFamily::inet} {}
+
+SocketCommunicator::SocketCommunicator(const SocketFamily family) noexcept
+  : handle_{create_non_blocking(family == SocketFamily::local ? AF_UNIX : AF_INET)}, family_{family}
 {
   if (handle_ == invalid_handle) {
     std::perror("SocketCommunicator::SocketCommunicator - socket");
@@ -73,28 +71,32 @@ SocketCommunicator::SocketCommunicator() noexcept : handle_{create_non_blocking(
   }
 }
 
-SocketCommunicator::SocketCommunicator(SocketCommunicator&& other) noexcept : handle_{other.handle_}
+SocketCommunicator::SocketCommunicator(SocketCommunicator&& other) noexcept
+  : handle_{other.handle_}, family_{other.family_}, bound_path_{std::move(other.bound_path_)}
 {
   other.handle_ = invalid_handle;
+  other.bound_path_.clear();
 }
 
 SocketCommunicator& SocketCommunicator::operator=(SocketCommunicator&& other) noexcept
 {
-  // Do this in a roundabout way to handle self-assignment
-  const auto new_handle = other.handle_;
-  other.handle_ = invalid_handle;
-  handle_ = new_handle;
+  // Swap so that the old socket is closed when other is destroyed
+  using std::swap;
+  swap(handle_, other.handle_);
+  swap(family_, other.family_);
+  swap(bound_path_, other.bound_path_);
   return *this;
 }
 
 SocketCommunicator::~SocketCommunicator()
 {
   if (handle_ != invalid_handle) { close(handle_); }
+  if (!bound_path_.empty()) { ::unlink(bound_path_.c_str()); }
 }
 
 std::optional<SocketCommunicator> SocketCommunicator::accept() noexcept
 {
-  sockaddr_in client_address_struct;
+  sockaddr_storage client_address_struct;
   // len can't be const as accept takes a non-const pointer
   socklen_t len = sizeof(client_address_struct);
 
@@ -111,7 +113,7 @@ std::optional<SocketCommunicator> SocketCommunicator::accept() noexcept
   }
 
   // Read the address
-  return SocketCommunicator(WithRawHandle{}, raw_handle);
+  return SocketCommunicator(WithRawHandle{}, raw_handle, family_);
 }
 
 ConnectionError SocketCommunicator::set_to_listen(const std::uint16_t port) noexcept
@@ -134,6 +136,21 @@ ConnectionError SocketCommunicator::set_to_listen(const std::uint16_t port) noex
   return ConnectionError::no_error;
 }
 
+ConnectionError SocketCommunicator::set_to_listen_local(const std::string& name) noexcept
+{
+  constexpr int listen_queue_size = 10;
+  sockaddr_un addr;
+  const auto len = make_local_address(name, addr);
+  if (len == 0) { return ConnectionError::unrecoverable; }
+  const bool is_abstract = name[0] == '\0';
+  // A path left behind by an instance that didn't exit cleanly would make bind fail
+  if (!is_abstract) { ::unlink(name.c_str()); }
+  if (bind(handle_, reinterpret_cast<sockaddr*>(&addr), len) < 0) { return ConnectionError::unrecoverable; }
+  if (!is_abstract) { bound_path_ = name; }
+  if (listen(handle_, listen_queue_size) < 0) { return ConnectionError::unrecoverable; }
+  return ConnectionError::no_error;
+}
+
 ConnectionError SocketCommunicator::connect_to_server(const char* const address, const std::uint16_t port) noexcept
 {
   if (init_connection(handle_, address, port) == -1) {
@@ -182,6 +199,17 @@ ConnectionError SocketCommunicator::connect_non_blocking(const std::string_view
   return connect_non_blocking(address_str.c_str(), port);
 }
 
+ConnectionError SocketCommunicator::connect_local_non_blocking(const std::string& name) noexcept
+{
+  sockaddr_un addr;
+  const auto len = make_local_address(name, addr);
+  if (len == 0) { return ConnectionError::unrecoverable; }
+  if (connect(handle_, reinterpret_cast<sockaddr*>(&addr), len) == 0) { return ConnectionError::no_error; }
+  // A full listen queue gives EAGAIN rather than a pending connection, so treat that as failing too
+  if (errno == EINPROGRESS) { return ConnectionError::connection_in_progress; }
+  return ConnectionError::unrecoverable;
+}
+
 ConnectionError SocketCommunicator::connection_progress_status() noexcept
 {
   pollfd to_poll;
@@ -214,6 +242,32 @@ ConnectionError SocketCommunicator::send_message(const std::byte* const message,
   return ConnectionError::no_error;
 }
 
+ConnectionError SocketCommunicator::send_buffers(
+  const gsl::span<const gsl::span<const std::byte>> buffers, std::size_t& bytes_sent) noexcept
+{
+  // Anything past this is picked up on the next call
+  constexpr std::size_t max_buffers = 64;
+  std::array<iovec, max_buffers> vecs;
+  const auto num_vecs = std::min(static_cast<std::size_t>(buffers.size()), max_buffers);
+  for (std::size_t i = 0; i < num_vecs; ++i) {
+    const auto& buffer = buffers[static_cast<gsl::index>(i)];
+    vecs[i].iov_base = const_cast<std::byte*>(buffer.data());
+    vecs[i].iov_len = static_cast<std::size_t>(buffer.size());
+  }
+  msghdr message{};
+  message.msg_iov = vecs.data();
+  message.msg_iovlen = static_cast<decltype(message.msg_iovlen)>(num_vecs);
+  const auto sent = sendmsg(handle_, &message, SKYNET_NO_SIGPIPE);
+  if (sent < 0) {
+    bytes_sent = 0;
+    if (errno == EAGAIN || errno == EWOULDBLOCK) { return ConnectionError::would_block; }
+    SKYNET_DEBUG_LOG("send_buffers threw error: {}", strerror(errno));
+    return ConnectionError::unrecoverable;
+  }
+  bytes_sent = static_cast<std::size_t>(sent);
+  return ConnectionError::no_error;
+}
+
 ConnectionError SocketCommunicator::read_message(std::byte* const buffer, const std::size_t size) noexcept
 {
   const auto read_bytes = read(handle_, reinterpret_cast<char*>(buffer), size);
@@ -226,8 +280,26 @@ ConnectionError SocketCommunicator::read_message(std::byte* const buffer, const
   return read_bytes == 0 ? ConnectionError::closed : ConnectionError::no_error;
 }
 
+ConnectionError
+  SocketCommunicator::read_available(std::byte* const buffer, const std::size_t size, std::size_t& bytes_read) noexcept
+{
+  bytes_read = 0;
+  const auto read_bytes = recv(handle_, reinterpret_cast<char*>(buffer), size, 0);
+  if (read_bytes < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) { return ConnectionError::would_block; }
+
+    SKYNET_DEBUG_LOG("read_available threw error: {}", strerror(errno));
+    return ConnectionError::unrecoverable;
+  }
+  bytes_read = static_cast<std::size_t>(read_bytes);
+  return read_bytes == 0 ? ConnectionError::closed : ConnectionError::no_error;
+}
+
+bool SocketCommunicator::is_local() const noexcept { return family_ == SocketFamily::local; }
+
 AddrPortPair SocketCommunicator::ip_address_and_port() const noexcept
 {
+  if (is_local()) { return local_address(); }
   sockaddr_in client_address;
   socklen_t len = sizeof(client_address);
   int err = getpeername(handle_, (struct sockaddr*)&client_address, &len);
@@ -239,45 +311,18 @@ AddrPortPair SocketCommunicator::ip_address_and_port() const noexcept
 
 AddrPortPair SocketCommunicator::host_ip_address_and_port() const noexcept
 {
+  if (is_local()) { return local_address(); }
   sockaddr_in host_address;
   socklen_t len = sizeof(host_address);
   getsockname(handle_, (struct sockaddr*)&host_address, &len);
   return {inet_ntoa(host_address.sin_addr), ntohs(host_address.sin_port)};  
 }
 
-SocketCommunicator::SocketCommunicator(WithRawHandle, const int handle) noexcept : handle_{handle} {}
+int SocketCommunicator::native_handle() const noexcept { return handle_; }
 
-std::vector<std::byte> read_chunked(SocketCommunicator& conn, const std::size_t num_bytes) noexcept
-{
-  // Size of memory to allocate/read each step
-  constexpr std::size_t read_step_size = 0x0'1000;
-  constexpr std::size_t allocate_step_size = read_step_size * 16;
-  // How often memory needs to be resized
-  constexpr std::size_t resize_every_n_steps = allocate_step_size / read_step_size;
-  // Ensure that the allocate size is evenly divisible by the read size
-  static_assert(allocate_step_size % read_step_size == 0);
-  static_assert(allocate_step_size >= read_step_size);
-  // To prevent overallocation of memory, don't allocate a ton of memory to start
-  std::vector<std::byte> read_bytes;
-  // The final bytes to read in the end
-  const int final_read_size = num_bytes % read_step_size;
-  // Read memory in 4KiB chunks
-  const int num_iters = num_bytes / read_step_size + (final_read_size == 0 ? 0 : 1);
-  for (int i = 0; i < num_iters; ++i) {
-    if (i % resize_every_n_steps == 0) {
-      // Allocate more memory
-      const std::size_t mem_left_to_read = num_bytes - read_bytes.size();
-      const std::size_t additional_size = mem_left_to_read > allocate_step_size ? allocate_step_size : mem_left_to_read;
-      read_bytes.resize(read_bytes.size() + additional_size);
-    }
-    const std::size_t num_bytes_to_read = (i == num_iters - 1 ? final_read_size : read_step_size);
-    // Allocate more memory if needed
-    if (conn.read_message(&read_bytes[i * read_step_size], num_bytes_to_read) != ConnectionError::no_error) {
-      return {};
-    }
-  }
-  return read_bytes;
-}
+SocketCommunicator::SocketCommunicator(WithRawHandle, const int handle, const SocketFamily family) noexcept
+  : handle_{handle}, family_{family}
+{}
 
 AddrPortPair split_address(const std::string_view address) noexcept
 {
@@ -295,29 +340,4 @@ AddrPortPair split_address(const std::string_view address) noexcept
   const std::string address_str{address.begin(), address.begin() + colon_loc};
   return {address_str, port};
 }
-
-std::variant<NetworkSizeType, ConnectionError> read_network_size(SocketCommunicator& conn) noexcept
-{
-  std::array<std::byte, sizeof(NetworkSizeType)> size_buffer;
-  const auto err = conn.read_message(size_buffer.data(), size_buffer.size());
-  if (err == ConnectionError::no_error) { return from_network_bytes(size_buffer); }
-  return err;
-}
-
-std::string to_ip_port(const AddrPortPair& addr) noexcept
-{
-  const auto& [name, port] = to_canonical(addr);
-  return name + ':' + std::to_string(port);
-}
-
-AddrPortPair to_canonical(const AddrPortPair& addr) noexcept
-{
-  const auto result = resolve_addr(addr.first.c_str(), addr.second);
-  sockaddr_in* info = reinterpret_cast<sockaddr_in*>(result->ai_addr);
-  const std::string to_ret = std::to_string((info->sin_addr.s_addr & 0x000000FF) >> 0) + '.'
-                           + std::to_string((info->sin_addr.s_addr & 0x0000FF00) >> 8) + '.'
-                           + std::to_string((info->sin_addr.s_addr & 0x00FF0000) >> 16) + '.'
-                           + std::to_string((info->sin_addr.s_addr & 0xFF000000) >> 24);
-  return {to_ret, addr.second};
-}
 } // namespace skywing::internal
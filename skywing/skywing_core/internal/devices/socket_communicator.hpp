@@ -1,43 +1,43 @@
 #ifndef SKYNET_INTERNAL_DEVICES_SOCKET_COMMUNICATOR_HPP
 #define SKYNET_INTERNAL_DEVICES_SOCKET_COMMUNICATOR_HPP
 
+#include "skywing_core/internal/devices/communicator.hpp"
 #include "skywing_core/internal/utility/network_conv.hpp"
 #include "skywing_core/types.hpp"
 
+#include "gsl/span"
+
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
 #include <vector>
 
 namespace skywing::internal {
-/** \brief Enum returned from communication functions for connection status
+/** \brief The kind of socket a SocketCommunicator uses
  */
-enum class [[nodiscard]] ConnectionError{/// The call has fully succeeded, no more work needs to be done
-                                         no_error,
-
-                                         /// The call would block
-                                         would_block,
-
-                                         /// Non-blocking connected has been initiated
-                                         connection_in_progress = would_block,
+enum class SocketFamily {
+  /// TCP over IPv4
+  inet,
 
-                                         /// An error occurred with communication that has left the connection
-                                         /// in an unusable state
-                                         unrecoverable,
-
-                                         /// The connection has closed
-                                         closed}; // enum class ConnectionError
+  /// Unix domain stream socket; only reaches processes on the same host
+  local
+}; // enum class SocketFamily
 
 /** \brief Socket based communicator
  */
-class SocketCommunicator {
+class SocketCommunicator : public Communicator {
 public:
   /** \brief Create a new socket-based communicator
    */
   SocketCommunicator() noexcept;
 
+  /** \brief Create a new communicator using the given kind of socket
+   */
+  explicit SocketCommunicator(SocketFamily family) noexcept;
+
   // Can not be copied
   SocketCommunicator(const SocketCommunicator&) = delete;
   SocketCommunicator& operator=(const SocketCommunicator&) = delete;
@@ -47,7 +47,7 @@ public:
   SocketCommunicator& operator=(SocketCommunicator&&) noexcept;
 
   // Destructor
-  ~SocketCommunicator();
+  ~SocketCommunicator() override;
 
   /** \brief Accepts an incoming connection if one is pending
    */
@@ -59,6 +59,13 @@ public:
    */
   ConnectionError set_to_listen(std::uint16_t port) noexcept;
 
+  /** \brief Listens for requests on a local socket
+   *
+   * \param name The name to listen on, as returned by local_socket_name
+   * \pre The communicator was created with SocketFamily::local
+   */
+  ConnectionError set_to_listen_local(const std::string& name) noexcept;
+
   /** \brief Connects to a server
    *
    * \param address The address to connect to
@@ -75,18 +82,35 @@ public:
   ConnectionError connect_non_blocking(const char* address, std::uint16_t port) noexcept;
   ConnectionError connect_non_blocking(std::string_view address) noexcept;
 
+  /** \brief Initiates a non-blocking connection to a local socket
+   *
+   * \pre The communicator was created with SocketFamily::local
+   */
+  ConnectionError connect_local_non_blocking(const std::string& name) noexcept;
+
   /** \brief Returns status on a pending connection
    *
    * \pre A connection has been initiated
    */
-  ConnectionError connection_progress_status() noexcept;
+  ConnectionError connection_progress_status() noexcept override;
 
   /** \brief Sends a message on the socket
    *
    * \param message The message to send
    * \param size The size of the message
    */
-  ConnectionError send_message(const std::byte* message, std::size_t size) noexcept;
+  ConnectionError send_message(const std::byte* message, std::size_t size) noexcept override;
+
+  /** \brief Sends as much of several buffers as the socket will take in one call
+   *
+   * Unlike send_message, a partial write is not an error; the number of bytes
+   * that were actually written is stored in bytes_sent so the caller can resume.
+   *
+   * \param buffers The buffers to send, in order
+   * \param bytes_sent Set to the total number of bytes written
+   */
+  ConnectionError
+    send_buffers(gsl::span<const gsl::span<const std::byte>> buffers, std::size_t& bytes_sent) noexcept override;
 
   /** \brief Recieve a message from the socket if one is available
    *
@@ -98,47 +122,60 @@ public:
    */
   ConnectionError read_message(std::byte* buffer, std::size_t size) noexcept;
 
+  /** \brief Reads whatever is available on the socket, up to size bytes
+   *
+   * \param buffer The buffer to write to
+   * \param size The size of the buffer
+   * \param bytes_read Set to the number of bytes that were read
+   */
+  ConnectionError read_available(std::byte* buffer, std::size_t size, std::size_t& bytes_read) noexcept override;
+
+  /** \brief Returns true if this is a local socket
+   */
+  bool is_local() const noexcept override;
+
   /** \brief Returns the IP address and port of the socket's peer
+   *
+   * Local sockets report the loopback address with a port of zero.
    */
-  AddrPortPair ip_address_and_port() const noexcept;
+  AddrPortPair ip_address_and_port() const noexcept override;
 
   /** \brief Returns the IP address and port of the host end of the socket
    */
-  AddrPortPair host_ip_address_and_port() const noexcept;
+  AddrPortPair host_ip_address_and_port() const noexcept override;
+
+  /** \brief Returns the underlying OS handle, for registering with a Reactor
+   */
+  int native_handle() const noexcept override;
 
 private:
   // Tag for using the raw handle constructor
   struct WithRawHandle {};
 
   // Construct a socket using a pre-exising handle
-  SocketCommunicator(WithRawHandle, const int handle) noexcept;
+  SocketCommunicator(WithRawHandle, const int handle, SocketFamily family) noexcept;
 
   // The handle to the raw socket
   int handle_;
+
+  SocketFamily family_;
+
+  // Filesystem path that a local socket is listening on, removed on destruction
+  std::string bound_path_;
 }; // class SocketCommunicator
 
-/** \brief Read a message in chunks from a SocketCommunicator.
+/** \brief Returns the name of the local socket an instance listening on a
+ * port also listens on
+ *
+ * This is in the abstract namespace where available, and a path under /tmp
+ * otherwise.
  */
-std::vector<std::byte> read_chunked(SocketCommunicator& conn, std::size_t num_bytes) noexcept;
+std::string local_socket_name(std::uint16_t port) noexcept;
 
 /** \brief Splits an "ip:port" address into its parts
  * The string is empty if the input was invalid
  */
 AddrPortPair split_address(const std::string_view address) noexcept;
-
-/** \brief Attempts to read a network size from a connection
- *
- * Returns either the network size or the error that occurred
- */
-std::variant<NetworkSizeType, ConnectionError> read_network_size(SocketCommunicator& conn) noexcept;
-
-/** \brief Returns an "IP:Port" string from a given address
- */
-std::string to_ip_port(const AddrPortPair& addr) noexcept;
-
-/** \brief Converts an AddrPortPair to the canonical representation
- */
-AddrPortPair to_canonical(const AddrPortPair& addr) noexcept;
 } // namespace skywing::internal
 
 #endif // SKYNET_INTERNAL_DEVICES_SOCKET_COMMUNICATOR_HPP
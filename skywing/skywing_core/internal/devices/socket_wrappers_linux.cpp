@@ -1,10 +1,20 @@
 #include "socket_wrappers.hpp"
 
+#include "skywing_core/internal/devices/socket_communicator.hpp"
+
+#include <sys/socket.h>
+
 namespace skywing::internal {
-int create_non_blocking() noexcept { return socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0); }
+int create_non_blocking(const int domain) noexcept { return socket(domain, SOCK_STREAM | SOCK_NONBLOCK, 0); }
 
 int accept_make_non_blocking(const int sockfd, sockaddr* addr, socklen_t* addrlen) noexcept
 {
   return accept4(sockfd, addr, addrlen, SOCK_NONBLOCK);
 }
+
+std::string local_socket_name(const std::uint16_t port) noexcept
+{
+  // The leading null puts it in the abstract namespace, so nothing has to be cleaned up
+  return std::string(1, '\0') + "skywing." + std::to_string(port);
+}
 } // namespace skywing::internal
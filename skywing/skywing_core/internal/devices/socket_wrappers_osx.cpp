@@ -1,5 +1,9 @@
 #include "socket_wrappers.hpp"
 
+#include "skywing_core/internal/devices/socket_communicator.hpp"
+
+#include <sys/socket.h>
+
 namespace skywing::internal {
 namespace {
 /** \brief Sets a socket to a non-blocking mode, returning the socket handle
@@ -15,10 +19,16 @@ int set_non_blocking(const int sockfd) noexcept
 }
 } // namespace
 
-int create_non_blocking() noexcept { return set_non_blocking(socket(AF_INET, SOCK_STREAM, 0)); }
+int create_non_blocking(const int domain) noexcept { return set_non_blocking(socket(domain, SOCK_STREAM, 0)); }
 
 int accept_make_non_blocking(const int sockfd, sockaddr* addr, socklen_t* addrlen) noexcept
 {
   return set_non_blocking(accept(sockfd, addr, addrlen));
 }
+
+std::string local_socket_name(const std::uint16_t port) noexcept
+{
+  // No abstract namespace, so use the filesystem
+  return "/tmp/skywing." + std::to_string(port) + ".sock";
+}
 } // namespace skywing::internal
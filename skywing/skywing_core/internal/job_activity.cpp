@@ -0,0 +1,85 @@
+#include "skywing_core/internal/job_activity.hpp"
+
+#include "skywing_core/internal/devices/reactor.hpp"
+
+#include <algorithm>
+
+namespace skywing::internal {
+namespace {
+// The activity of the job running on this thread, if it is part of a simulation
+thread_local JobActivity* current_activity = nullptr;
+} // namespace
+
+JobActivity::JobActivity(Reactor& reactor) noexcept : reactor_{&reactor} {}
+
+void JobActivity::job_started() noexcept
+{
+  std::lock_guard lock{mutex_};
+  ++running_;
+}
+
+JobActivity::JobThread::JobThread(JobActivity* const activity) noexcept : activity_{activity}
+{
+  current_activity = activity;
+}
+
+JobActivity::JobThread::~JobThread()
+{
+  current_activity = nullptr;
+  if (!activity_) { return; }
+  {
+    std::lock_guard lock{activity_->mutex_};
+    --activity_->running_;
+  }
+  activity_->reactor_->wake();
+}
+
+JobActivity::BlockedWaiter::BlockedWaiter(std::mutex& mutex, const std::function<bool()>& is_ready) noexcept
+  : activity_{current_activity}
+{
+  if (!activity_) { return; }
+  blocked_ = std::make_shared<Blocked>();
+  blocked_->mutex = &mutex;
+  blocked_->is_ready = &is_ready;
+  {
+    std::lock_guard lock{activity_->mutex_};
+    activity_->blocked_.push_back(blocked_);
+  }
+  // This may have been the last job that was running
+  activity_->reactor_->wake();
+}
+
+JobActivity::BlockedWaiter::~BlockedWaiter()
+{
+  if (!blocked_) { return; }
+  {
+    // Waits for a check of the waiter to finish, which can't block on the waiter's
+    // mutex that is held here as it is only ever tried
+    std::lock_guard guard{blocked_->guard};
+    blocked_->left = true;
+  }
+  std::lock_guard lock{activity_->mutex_};
+  auto& blocked = activity_->blocked_;
+  blocked.erase(std::find(blocked.begin(), blocked.end(), blocked_));
+}
+
+bool JobActivity::all_blocked() noexcept
+{
+  {
+    std::lock_guard lock{mutex_};
+    if (blocked_.size() != running_) { return false; }
+    checking_ = blocked_;
+  }
+  // Checked without holding mutex_ as readiness checks can take other locks,
+  // such as the manager's, that job threads hold while registering
+  const bool all_blocked = std::all_of(checking_.cbegin(), checking_.cend(), [](const auto& blocked) {
+    std::lock_guard guard{blocked->guard};
+    if (blocked->left) { return false; }
+    // Held by a job that was woken up and is about to run
+    std::unique_lock waiter_lock{*blocked->mutex, std::try_to_lock};
+    return waiter_lock.owns_lock() && !(*blocked->is_ready)();
+  });
+  checking_.clear();
+  return all_blocked;
+}
+} // namespace skywing::internal
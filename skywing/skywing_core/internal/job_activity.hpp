@@ -0,0 +1,103 @@
+#ifndef SKYNET_INTERNAL_JOB_ACTIVITY_HPP
+#define SKYNET_INTERNAL_JOB_ACTIVITY_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace skywing::internal {
+class Reactor;
+
+/** \brief Tracks when every job of a simulation is blocked in a waiter
+ *
+ * The simulator only moves its clock once no job can do anything more until
+ * an instance handles an event, so that what happens at each point in virtual
+ * time doesn't depend on how the host schedules the job threads.  Jobs are
+ * counted from just before their thread is started, and each job thread is
+ * attached to the activity so that the waiters it blocks in register
+ * themselves.  Jobs that block on anything other than a waiter keep the clock
+ * from moving until they return to one.
+ */
+class JobActivity {
+private:
+  struct Blocked;
+
+public:
+  /** \param reactor Woken whenever a job blocks or finishes
+   */
+  explicit JobActivity(Reactor& reactor) noexcept;
+
+  JobActivity(const JobActivity&) = delete;
+  JobActivity& operator=(const JobActivity&) = delete;
+
+  /** \brief Counts a job whose thread is about to be started
+   */
+  void job_started() noexcept;
+
+  /** \brief Attaches the calling thread to an activity, which may be null,
+   * for as long as it exists
+   *
+   * The job counted for the thread is counted as finished when it is destroyed.
+   */
+  class JobThread {
+  public:
+    explicit JobThread(JobActivity* activity) noexcept;
+
+    JobThread(const JobThread&) = delete;
+    JobThread& operator=(const JobThread&) = delete;
+
+    ~JobThread();
+
+  private:
+    JobActivity* activity_;
+  }; // class JobThread
+
+  /** \brief Registers a waiter as blocked for as long as it exists
+   *
+   * Does nothing on threads that aren't attached to an activity.  Must be
+   * created and destroyed with the waiter's mutex held.
+   */
+  class BlockedWaiter {
+  public:
+    BlockedWaiter(std::mutex& mutex, const std::function<bool()>& is_ready) noexcept;
+
+    BlockedWaiter(const BlockedWaiter&) = delete;
+    BlockedWaiter& operator=(const BlockedWaiter&) = delete;
+
+    ~BlockedWaiter();
+
+  private:
+    JobActivity* activity_;
+    std::shared_ptr<Blocked> blocked_;
+  }; // class BlockedWaiter
+
+  /** \brief Returns true if every job that was started is blocked in a waiter
+   * that isn't ready
+   *
+   * Only the thread handling the events of the instances may call this, and it
+   * must not hold the mutex of any waiter.
+   */
+  bool all_blocked() noexcept;
+
+private:
+  struct Blocked {
+    std::mutex* mutex;
+    const std::function<bool()>* is_ready;
+    // Held while the waiter is checked, so that its thread can't leave it until then
+    std::mutex guard;
+    bool left = false;
+  };
+
+  Reactor* reactor_;
+  // Guards running_ and blocked_
+  std::mutex mutex_;
+  std::size_t running_ = 0;
+  std::vector<std::shared_ptr<Blocked>> blocked_;
+  // Copy of blocked_ used while checking the waiters without holding mutex_
+  std::vector<std::shared_ptr<Blocked>> checking_;
+}; // class JobActivity
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_JOB_ACTIVITY_HPP
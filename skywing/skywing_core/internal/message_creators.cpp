@@ -2,90 +2,428 @@
 
 #include "publish_value_handler.hpp"
 #include "skywing_core/internal/capn_proto_wrapper.hpp"
+#include "skywing_core/internal/typed_publish_serializer.hpp"
 #include "skywing_core/internal/utility/network_conv.hpp"
 #include "skywing_core/types.hpp"
 
 #include "message_format.capnp.h"
 
+#include <capnp/message.h>
 #include <capnp/serialize.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 namespace skywing::internal {
 namespace {
 // Creates a vector of bytes with a size pre-prended ready to be sent over the network
-std::vector<std::byte> finalize_message(capnp::MallocMessageBuilder& builder) noexcept
+std::vector<std::byte> finalize_message(capnp::MessageBuilder& builder) noexcept
 {
   // Calculate the sizes
-  constexpr auto net_size = sizeof(NetworkSizeType);
-  const std::size_t msg_size = capnp::computeSerializedSizeInWords(builder) * sizeof(std::size_t);
-  const std::size_t buf_size = net_size + msg_size;
+  const std::size_t msg_size = capnp::computeSerializedSizeInWords(builder) * sizeof(capnp::word);
+  const std::size_t buf_size = frame_header_size + msg_size;
 
-  // Write the message to a buffer
+  // Write the message to a buffer; the reserved part of the header is left zeroed
   std::vector<std::byte> buffer_data(buf_size);
   kj::NullArrayDisposer null_disposer{};
   kj::Array<kj::byte> buffer{
-    reinterpret_cast<kj::byte*>(buffer_data.data()) + net_size, buffer_data.size() - net_size, null_disposer};
+    reinterpret_cast<kj::byte*>(buffer_data.data()) + frame_header_size,
+    buffer_data.size() - frame_header_size,
+    null_disposer};
   kj::ArrayOutputStream out_s{buffer};
   capnp::writeMessage(out_s, builder);
 
   // Write the size
-  const auto size_bytes = to_network_bytes(msg_size);
+  const auto size_bytes = to_network_bytes(static_cast<NetworkSizeType>(msg_size));
   std::memcpy(buffer_data.data(), &size_bytes, sizeof(size_bytes));
   return buffer_data;
 }
 
+// The size of the segment table at the start of a message with a single segment
+constexpr std::size_t single_segment_table_size = 8;
+
+// Where the first segment starts in a frame with a single segment
+constexpr std::size_t first_segment_offset = frame_header_size + single_segment_table_size;
+
+// Rough upper bounds on the encoded size of a publish, used to size the first segment
+constexpr std::size_t publish_overhead_guess = 128;
+constexpr std::size_t value_overhead_guess = 64;
+
+// The smallest segment allocated once a message outgrows its frame, the same as Cap'n Proto's default
+constexpr std::size_t overflow_segment_words = 1024;
+
+void write_little_endian(std::byte* const to, const std::uint32_t value) noexcept
+{
+  for (std::size_t i = 0; i < sizeof(value); ++i) {
+    to[i] = static_cast<std::byte>(value >> (8 * i));
+  }
+}
+
+// Builds a message straight into the frame that it is sent in, which saves
+// copying it out of the builder if it fits in the space guessed for it
+// The frame's storage is reused if it already has enough capacity
+class FrameBuilder final : public capnp::MessageBuilder {
+public:
+  FrameBuilder(std::vector<std::byte>& frame, const std::size_t size_guess) noexcept : frame_{frame}
+  {
+    // Zeroed, as Cap'n Proto requires of new segments
+    frame_.assign(
+      first_segment_offset + (size_guess + sizeof(capnp::word) - 1) / sizeof(capnp::word) * sizeof(capnp::word),
+      std::byte{0});
+  }
+
+  // Finishes the message in the frame
+  void finish() noexcept
+  {
+    const auto segments = getSegmentsForOutput();
+    const auto* const first = reinterpret_cast<const capnp::word*>(frame_.data() + first_segment_offset);
+    if (segments.size() != 1 || segments[0].begin() != first) {
+      frame_ = finalize_message(*this);
+      return;
+    }
+    // The segment table is the number of segments less one followed by the size of each in words
+    const auto words = segments[0].size();
+    write_little_endian(frame_.data() + frame_header_size, 0);
+    write_little_endian(frame_.data() + frame_header_size + 4, static_cast<std::uint32_t>(words));
+    const std::size_t msg_size = single_segment_table_size + words * sizeof(capnp::word);
+    frame_.resize(frame_header_size + msg_size);
+    const auto size_bytes = to_network_bytes(static_cast<NetworkSizeType>(msg_size));
+    std::memcpy(frame_.data(), &size_bytes, sizeof(size_bytes));
+  }
+
+private:
+  kj::ArrayPtr<capnp::word> allocateSegment(const unsigned int minimum_size) override
+  {
+    const auto frame_words = (frame_.size() - first_segment_offset) / sizeof(capnp::word);
+    if (!segment_given_ && minimum_size <= frame_words) {
+      segment_given_ = true;
+      // Allocations from operator new are aligned well enough for words
+      return {reinterpret_cast<capnp::word*>(frame_.data() + first_segment_offset), frame_words};
+    }
+    segment_given_ = true;
+    // The message didn't fit, so it is copied out by finish() like any other
+    const std::size_t words = std::max<std::size_t>({minimum_size, frame_words, overflow_segment_words});
+    overflow_.push_back(std::make_unique<capnp::word[]>(words));
+    return {overflow_.back().get(), words};
+  }
+
+  std::vector<std::byte>& frame_;
+  bool segment_given_ = false;
+  std::vector<std::unique_ptr<capnp::word[]>> overflow_;
+};
+
+// Builds a publish in the frame, setting aside the guessed size for it up front
+template<typename SetData>
+void build_publish(std::vector<std::byte>& frame, const std::size_t size_guess, const SetData& set_data) noexcept
+{
+  FrameBuilder builder{frame, size_guess};
+  set_data(builder.initRoot<cpnpro::StatusMessage>().initPublishData());
+  builder.finish();
+}
+
+template<typename SetData>
+std::vector<std::byte> build_publish(const std::size_t size_guess, const SetData& set_data) noexcept
+{
+  std::vector<std::byte> frame;
+  build_publish(frame, size_guess, set_data);
+  return frame;
+}
+
+// Builds a publish in a buffer from the tag's template, setting aside as much
+// space as the largest message built with the same features took
+template<typename SetData>
+SharedFrame build_publish(
+  PublishTemplate& tmpl, const WireFeatures features, const std::size_t size_guess, const SetData& set_data) noexcept
+{
+  auto frame = tmpl.acquire();
+  const auto hint = tmpl.size_hint(features);
+  build_publish(*frame, hint != 0 ? hint : size_guess, set_data);
+  tmpl.record_size(features, frame->size() - std::min(frame->size(), first_segment_offset));
+  return frame;
+}
+
+// A rough upper bound on the encoded size of a value
+std::size_t encoded_size_guess(const PublishValueVariant& value) noexcept
+{
+  return value_overhead_guess
+         + std::visit([](const auto& data) -> std::size_t { return detail::encoded_data_size_guess(data); }, value);
+}
+
+std::size_t encoded_size_guess(const PublishValueView& value) noexcept
+{
+  return std::visit(
+    [](const auto& data) -> std::size_t {
+      using ViewType = std::remove_cv_t<std::remove_reference_t<decltype(data)>>;
+      if constexpr (std::is_same_v<ViewType, PublishValueVariant>) { return encoded_size_guess(data); }
+      else {
+        return value_overhead_guess + static_cast<std::size_t>(data.size()) * sizeof(*data.data());
+      }
+    },
+    value);
+}
+
+template<typename Value>
+std::size_t publish_size_guess(const TagID& tag_id, gsl::span<const Value> value) noexcept
+{
+  std::size_t to_ret = publish_overhead_guess + tag_id.size();
+  for (const auto& elem : value) {
+    to_ret += encoded_size_guess(elem);
+  }
+  return to_ret;
+}
+
+std::size_t publish_size_guess(const TagID& tag_id, const PublishValueWriter& value) noexcept
+{
+  return publish_overhead_guess + tag_id.size() + value.size() * value_overhead_guess + value.encoded_data_size_guess();
+}
+
+void set_publish_value(
+  cpnpro::PublishValue::Builder to_build,
+  const PublishValueVariant& value,
+  const WireFeatures features,
+  const PublishValueVariant* const previous,
+  const Quantization quantization) noexcept
+{
+  std::visit(
+    [&](const auto& data) {
+      using ValueType = std::remove_cv_t<std::remove_reference_t<decltype(data)>>;
+      if constexpr (detail::IsVector<ValueType>::value) {
+        if (previous != nullptr && (features & wire_feature::vector_delta)) {
+          const auto* last = std::get_if<ValueType>(previous);
+          if (last != nullptr && detail::set_vector_delta(to_build, data, *last)) { return; }
+        }
+      }
+      detail::set_value(to_build, data, features, quantization);
+    },
+    value);
+}
+
+// Names the tag by its index if the receiver supports it and it has one
+void set_tag(
+  cpnpro::PublishData::Builder to_set,
+  const TagID& tag_id,
+  const std::uint32_t tag_index,
+  const WireFeatures features) noexcept
+{
+  if (tag_index != 0 && (features & wire_feature::tag_indices)) { to_set.setTagIndex(tag_index); }
+  else {
+    to_set.setTagID(tag_id);
+  }
+}
+
 void set_publish_data(
   cpnpro::PublishData::Builder to_set,
   const VersionID version,
   const TagID& tag_id,
-  gsl::span<const PublishValueVariant> value) noexcept
+  const std::uint32_t tag_index,
+  gsl::span<const PublishValueVariant> value,
+  const WireFeatures features,
+  gsl::span<const PublishValueVariant> previous = {},
+  const Quantization quantization = Quantization::none) noexcept
 {
   to_set.setVersion(version);
-  to_set.setTagID(tag_id);
+  set_tag(to_set, tag_id, tag_index, features);
+  auto publish_value = to_set.initValue(value.size());
+  const bool has_previous = previous.size() == value.size();
+  for (int i = 0; i < value.size(); ++i) {
+    set_publish_value(publish_value[i], value[i], features, has_previous ? &previous[i] : nullptr, quantization);
+  }
+}
+
+void set_publish_data(
+  cpnpro::PublishData::Builder to_set,
+  const VersionID version,
+  const TagID& tag_id,
+  const std::uint32_t tag_index,
+  const PublishValueWriter& value,
+  const WireFeatures features,
+  const Quantization quantization) noexcept
+{
+  to_set.setVersion(version);
+  set_tag(to_set, tag_id, tag_index, features);
+  value.write(to_set.initValue(static_cast<unsigned int>(value.size())), features, quantization);
+}
+
+void set_publish_data(
+  cpnpro::PublishData::Builder to_set,
+  const VersionID version,
+  const TagID& tag_id,
+  const std::uint32_t tag_index,
+  gsl::span<const PublishValueView> value,
+  const WireFeatures features) noexcept
+{
+  to_set.setVersion(version);
+  set_tag(to_set, tag_id, tag_index, features);
   auto publish_value = to_set.initValue(value.size());
   for (int i = 0; i < value.size(); ++i) {
     std::visit(
       [&](const auto& data) {
-        using ValueType = std::remove_cv_t<std::remove_reference_t<decltype(data)>>;
-        auto to_build = publish_value[i];
-        detail::PublishValueHandler<ValueType>::set(to_build, data);
+        using ViewType = std::remove_cv_t<std::remove_reference_t<decltype(data)>>;
+        if constexpr (std::is_same_v<ViewType, PublishValueVariant>) {
+          set_publish_value(publish_value[i], data, features, nullptr, Quantization::none);
+        }
+        else {
+          using Element = std::remove_const_t<typename ViewType::element_type>;
+          auto to_build = publish_value[i];
+          const auto size = static_cast<std::size_t>(data.size());
+          if ((features & wire_feature::raw_arrays) && size <= detail::max_raw_array_bytes / sizeof(Element)) {
+            detail::set_raw_array(to_build, data.data(), size);
+          }
+          else {
+            detail::PublishValueHandler<std::vector<Element>>::set(to_build, std::vector<Element>(data.begin(), data.end()));
+          }
+        }
       },
       value[i]);
   }
 }
 
-template<typename InitFunc, typename MessageType, typename VecValueType>
-void set_vector(const InitFunc& init_func, MessageType msg, const std::vector<VecValueType>& values) noexcept
+template<typename ListBuilder, typename T>
+void set_element(ListBuilder& list, const std::size_t i, const T& value) noexcept
+{
+  list.set(i, value);
+}
+
+// Text has to be copied in since views aren't null terminated
+template<typename ListBuilder>
+void set_element(ListBuilder& list, const std::size_t i, const std::string_view value) noexcept
+{
+  auto text = list.init(i, value.size());
+  std::copy(value.begin(), value.end(), text.begin());
+}
+
+template<typename InitFunc, typename MessageType, typename Values>
+void set_vector(const InitFunc& init_func, MessageType msg, const Values& values) noexcept
 {
   const std::size_t size = values.size();
   auto to_set = (msg.*init_func)(size);
   for (std::size_t i = 0; i < size; ++i) {
-    to_set.set(i, values[i]);
+    set_element(to_set, i, values[i]);
   }
 }
-} // namespace
 
+template<typename Tags, typename Needed>
 std::vector<std::byte>
-  make_publish(const VersionID version, const TagID& tag_id, gsl::span<const PublishValueVariant> value) noexcept
+  build_get_publishers(const Tags& tags, const Needed& publishers_needed, const bool ignore_cache) noexcept
 {
+  assert(tags.size() == publishers_needed.size());
   capnp::MallocMessageBuilder builder;
-  auto message = builder.initRoot<cpnpro::StatusMessage>().initPublishData();
-  set_publish_data(message, version, tag_id, value);
+  auto message = builder.initRoot<cpnpro::StatusMessage>().initGetPublishers();
+  set_vector(&decltype(message)::initTags, message, tags);
+  set_vector(&decltype(message)::initPublishersNeeded, message, publishers_needed);
+  message.setIgnoreCache(ignore_cache);
   return finalize_message(builder);
 }
+} // namespace
 
-std::vector<std::byte>
-  make_greeting(const MachineID& from, const std::vector<MachineID>& neighbors, const std::uint16_t port) noexcept
+std::vector<std::byte> make_publish(
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueVariant> value,
+  const WireFeatures features,
+  const Quantization quantization) noexcept
+{
+  return build_publish(publish_size_guess(tag_id, value), [&](cpnpro::PublishData::Builder message) {
+    set_publish_data(message, version, tag_id, 0, value, features, {}, quantization);
+  });
+}
+
+SharedFrame make_publish(
+  PublishTemplate& tmpl,
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueVariant> value,
+  const WireFeatures features,
+  const Quantization quantization) noexcept
+{
+  return build_publish(tmpl, features, publish_size_guess(tag_id, value), [&](cpnpro::PublishData::Builder message) {
+    set_publish_data(message, version, tag_id, tmpl.tag_index(), value, features, {}, quantization);
+  });
+}
+
+std::vector<std::byte> make_publish(
+  const VersionID version,
+  const TagID& tag_id,
+  const PublishValueWriter& value,
+  const WireFeatures features,
+  const Quantization quantization) noexcept
+{
+  return build_publish(publish_size_guess(tag_id, value), [&](cpnpro::PublishData::Builder message) {
+    set_publish_data(message, version, tag_id, 0, value, features, quantization);
+  });
+}
+
+SharedFrame make_publish(
+  PublishTemplate& tmpl,
+  const VersionID version,
+  const TagID& tag_id,
+  const PublishValueWriter& value,
+  const WireFeatures features,
+  const Quantization quantization) noexcept
+{
+  return build_publish(tmpl, features, publish_size_guess(tag_id, value), [&](cpnpro::PublishData::Builder message) {
+    set_publish_data(message, version, tag_id, tmpl.tag_index(), value, features, quantization);
+  });
+}
+
+std::vector<std::byte> make_publish(
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueView> value,
+  const WireFeatures features) noexcept
+{
+  return build_publish(publish_size_guess(tag_id, value), [&](cpnpro::PublishData::Builder message) {
+    set_publish_data(message, version, tag_id, 0, value, features);
+  });
+}
+
+SharedFrame make_publish(
+  PublishTemplate& tmpl,
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueView> value,
+  const WireFeatures features) noexcept
+{
+  return build_publish(tmpl, features, publish_size_guess(tag_id, value), [&](cpnpro::PublishData::Builder message) {
+    set_publish_data(message, version, tag_id, tmpl.tag_index(), value, features);
+  });
+}
+
+std::vector<std::byte> make_publish_delta(
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueVariant> value,
+  gsl::span<const PublishValueVariant> previous,
+  const WireFeatures features,
+  const Quantization quantization,
+  const std::uint32_t tag_index) noexcept
+{
+  // Changes are only sent when they're smaller, so the whole value is still an upper bound
+  return build_publish(publish_size_guess(tag_id, value), [&](cpnpro::PublishData::Builder message) {
+    set_publish_data(message, version, tag_id, tag_index, value, features, previous, quantization);
+    message.setDeltaBase(true);
+  });
+}
+
+std::vector<std::byte> make_greeting(
+  const MachineID& from,
+  const std::vector<MachineID>& neighbors,
+  const std::uint16_t port,
+  const WireFeatures features,
+  const std::string& local_socket) noexcept
 {
   capnp::MallocMessageBuilder builder;
   auto message = builder.initRoot<cpnpro::StatusMessage>().initGreeting();
   message.setFrom(from);
   set_vector(&decltype(message)::initNeighbors, message, neighbors);
   message.setPort(port);
+  message.setFeatures(features);
+  message.setLocalSocket(local_socket);
   return finalize_message(builder);
 }
 
@@ -151,13 +489,15 @@ std::vector<std::byte> make_report_publishers(
 std::vector<std::byte> make_get_publishers(
   const std::vector<TagID>& tags, const std::vector<std::uint8_t>& publishers_needed, const bool ignore_cache) noexcept
 {
-  assert(tags.size() == publishers_needed.size());
-  capnp::MallocMessageBuilder builder;
-  auto message = builder.initRoot<cpnpro::StatusMessage>().initGetPublishers();
-  set_vector(&decltype(message)::initTags, message, tags);
-  set_vector(&decltype(message)::initPublishersNeeded, message, publishers_needed);
-  message.setIgnoreCache(ignore_cache);
-  return finalize_message(builder);
+  return build_get_publishers(tags, publishers_needed, ignore_cache);
+}
+
+std::vector<std::byte> make_get_publishers(
+  gsl::span<const std::string_view> tags,
+  gsl::span<const std::uint8_t> publishers_needed,
+  const bool ignore_cache) noexcept
+{
+  return build_get_publishers(tags, publishers_needed, ignore_cache);
 }
 
 std::vector<std::byte> make_join_reduce_group(const TagID& reduce_tag, const TagID& tag_produced) noexcept
@@ -179,7 +519,7 @@ std::vector<std::byte> make_submit_reduce_value(
   auto message = builder.initRoot<cpnpro::StatusMessage>().initSubmitReduceValue();
   message.setReduceTag(reduce_tag);
   auto publish_data = message.initData();
-  set_publish_data(publish_data, version, tag_id, value);
+  set_publish_data(publish_data, version, tag_id, 0, value, 0);
   return finalize_message(builder);
 }
 
@@ -202,4 +542,45 @@ std::vector<std::byte> make_subscription_notice(const std::vector<TagID>& tags,
   message.setIsUnsubscribe(is_unsubscribe);
   return finalize_message(builder);
 }
+
+std::vector<std::byte> make_shm_attach(const std::string& name, const std::size_t capacity) noexcept
+{
+  capnp::MallocMessageBuilder builder;
+  auto message = builder.initRoot<cpnpro::StatusMessage>().initShmAttach();
+  message.setName(name);
+  message.setCapacity(capacity);
+  return finalize_message(builder);
+}
+
+std::vector<std::byte> make_shm_attach_reply(const std::string& name, const bool success) noexcept
+{
+  capnp::MallocMessageBuilder builder;
+  auto message = builder.initRoot<cpnpro::StatusMessage>().initShmAttachReply();
+  message.setName(name);
+  message.setSuccess(success);
+  return finalize_message(builder);
+}
+
+std::vector<std::byte> make_shm_switch() noexcept
+{
+  capnp::MallocMessageBuilder builder;
+  builder.initRoot<cpnpro::StatusMessage>().setShmSwitch();
+  return finalize_message(builder);
+}
+
+std::vector<std::byte> make_grant_credits(const std::uint32_t credits) noexcept
+{
+  capnp::MallocMessageBuilder builder;
+  builder.initRoot<cpnpro::StatusMessage>().initGrantCredits().setCredits(credits);
+  return finalize_message(builder);
+}
+
+std::vector<std::byte> make_bind_tag(const TagID& tag_id, const std::uint32_t index) noexcept
+{
+  capnp::MallocMessageBuilder builder;
+  auto message = builder.initRoot<cpnpro::StatusMessage>().initBindTag();
+  message.setTagID(tag_id);
+  message.setIndex(index);
+  return finalize_message(builder);
+}
 } // namespace skywing::internal
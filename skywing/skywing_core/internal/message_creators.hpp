@@ -1,23 +1,118 @@
 #ifndef SKYNET_INTERNAL_MESSAGE_CREATORS_HPP
 #define SKYNET_INTERNAL_MESSAGE_CREATORS_HPP
 
+#include "skywing_core/internal/publish_template.hpp"
+#include "skywing_core/internal/publish_value_view.hpp"
+#include "skywing_core/internal/wire_features.hpp"
 #include "skywing_core/types.hpp"
 
 #include "gsl/span"
 
 #include <cstddef>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace skywing::internal {
+class PublishValueWriter;
+
 /** \brief Create data for a publish
+ *
+ * \param features The wire features the receiver supports; numeric vectors
+ * are sent as raw arrays if it supports them
+ * \param quantization The lossy encoding for floating point vectors, used if
+ * the receiver supports quantized arrays
+ */
+std::vector<std::byte> make_publish(
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueVariant> value,
+  WireFeatures features = 0,
+  Quantization quantization = Quantization::none) noexcept;
+
+/** \brief Create data for a publish in a buffer from the tag's template
+ *
+ * Once the publishes on the tag have a steady shape, this doesn't allocate.
+ * The tag is named by the template's index if the receiver supports it.
  */
-std::vector<std::byte>
-  make_publish(const VersionID version, const TagID& tag_id, gsl::span<const PublishValueVariant> value) noexcept;
+SharedFrame make_publish(
+  PublishTemplate& tmpl,
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueVariant> value,
+  WireFeatures features = 0,
+  Quantization quantization = Quantization::none) noexcept;
+
+/** \brief Create data for a publish whose types are known at compile time
+ *
+ * Each value is written by code for its exact type, with no
+ * PublishValueVariant in between.
+ */
+std::vector<std::byte> make_publish(
+  const VersionID version,
+  const TagID& tag_id,
+  const PublishValueWriter& value,
+  WireFeatures features = 0,
+  Quantization quantization = Quantization::none) noexcept;
+
+SharedFrame make_publish(
+  PublishTemplate& tmpl,
+  const VersionID version,
+  const TagID& tag_id,
+  const PublishValueWriter& value,
+  WireFeatures features = 0,
+  Quantization quantization = Quantization::none) noexcept;
+
+/** \brief Create data for a publish whose numeric vectors may be in the caller's memory
+ *
+ * Spans are encoded straight from the memory they point to.
+ */
+std::vector<std::byte> make_publish(
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueView> value,
+  WireFeatures features = 0) noexcept;
+
+SharedFrame make_publish(
+  PublishTemplate& tmpl,
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueView> value,
+  WireFeatures features = 0) noexcept;
+
+/** \brief Create data for publishing on a tag whose values may be sent as the
+ * changes from the previous one
+ *
+ * The receiver keeps the value so that it can apply the changes in the next.
+ *
+ * \param previous The value last sent on the tag to the receiver, or empty to
+ * send the whole value
+ * \param features The wire features the receiver supports; numeric vectors are
+ * only sent as changes if it supports them
+ * \param quantization The lossy encoding for floating point vectors that are
+ * sent whole
+ * \param tag_index The index the tag was bound to with the receiver, or 0 to
+ * name it in full
+ */
+std::vector<std::byte> make_publish_delta(
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const PublishValueVariant> value,
+  gsl::span<const PublishValueVariant> previous,
+  WireFeatures features,
+  Quantization quantization = Quantization::none,
+  std::uint32_t tag_index = 0) noexcept;
 
 /** \brief Create data for a greeting
+ *
+ * \param local_socket The local socket name the sender listens on, or empty
  */
-std::vector<std::byte>
-  make_greeting(const MachineID& from, const std::vector<MachineID>& neighbors, std::uint16_t port) noexcept;
+std::vector<std::byte> make_greeting(
+  const MachineID& from,
+  const std::vector<MachineID>& neighbors,
+  std::uint16_t port,
+  WireFeatures features,
+  const std::string& local_socket) noexcept;
 
 /** \brief Create data for a goodbyte
  */
@@ -52,6 +147,11 @@ std::vector<std::byte> make_report_publishers(
 std::vector<std::byte> make_get_publishers(
   const std::vector<TagID>& tags, const std::vector<std::uint8_t>& publishers_needed, bool ignore_cache) noexcept;
 
+/** \brief Create a request for producers of tags that are viewed rather than owned
+ */
+std::vector<std::byte> make_get_publishers(
+  gsl::span<const std::string_view> tags, gsl::span<const std::uint8_t> publishers_needed, bool ignore_cache) noexcept;
+
 /** \brief Create a message to join a reduce group
  */
 std::vector<std::byte> make_join_reduce_group(const TagID& reduce_tag, const TagID& tag_produced) noexcept;
@@ -73,6 +173,26 @@ std::vector<std::byte> make_report_reduce_disconnection(
 /** \brief Create a message for subscribing/unsubscribing
  */
 std::vector<std::byte> make_subscription_notice(const std::vector<TagID>& tags, bool is_unsubscribe) noexcept;
+
+/** \brief Create a request for the receiver to read from a shared memory ring
+ */
+std::vector<std::byte> make_shm_attach(const std::string& name, std::size_t capacity) noexcept;
+
+/** \brief Create a response to a shared memory ring request
+ */
+std::vector<std::byte> make_shm_attach_reply(const std::string& name, bool success) noexcept;
+
+/** \brief Create the marker for switching to the shared memory ring
+ */
+std::vector<std::byte> make_shm_switch() noexcept;
+
+/** \brief Create a message allowing the receiver to send more published values
+ */
+std::vector<std::byte> make_grant_credits(std::uint32_t credits) noexcept;
+
+/** \brief Create a message binding a tag to the index later publishes name it by
+ */
+std::vector<std::byte> make_bind_tag(const TagID& tag_id, std::uint32_t index) noexcept;
 } // namespace skywing::internal
 
 #endif // SKYNET_INTERNAL_MESSAGE_CREATORS_HPP
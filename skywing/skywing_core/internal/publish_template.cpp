@@ -0,0 +1,41 @@
+#include "skywing_core/internal/publish_template.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace skywing::internal {
+std::shared_ptr<std::vector<std::byte>> PublishTemplate::acquire() noexcept
+{
+  for (std::size_t i = 0; i < buffers_.size(); ++i) {
+    auto& buffer = buffers_[(next_ + i) % buffers_.size()];
+    // Nothing else can get a new reference, so once it's only held here it stays that way
+    if (buffer.use_count() != 1) { continue; }
+    // Pairs with the release when the last frame was dropped, which may have been on another thread
+    std::atomic_thread_fence(std::memory_order_acquire);
+    next_ = (next_ + i + 1) % buffers_.size();
+    ++reused_buffers_;
+    return buffer;
+  }
+  auto buffer = std::make_shared<std::vector<std::byte>>();
+  if (buffers_.size() < max_buffers) { buffers_.push_back(buffer); }
+  return buffer;
+}
+
+std::size_t PublishTemplate::size_hint(const WireFeatures features) const noexcept
+{
+  const auto iter
+    = std::find_if(size_hints_.cbegin(), size_hints_.cend(), [&](const auto& hint) { return hint.first == features; });
+  return iter == size_hints_.cend() ? 0 : iter->second;
+}
+
+void PublishTemplate::record_size(const WireFeatures features, const std::size_t size) noexcept
+{
+  const auto iter
+    = std::find_if(size_hints_.begin(), size_hints_.end(), [&](const auto& hint) { return hint.first == features; });
+  if (iter == size_hints_.end()) { size_hints_.emplace_back(features, size); }
+  else {
+    // The largest, so that values that vary in size settle as well
+    iter->second = std::max(iter->second, size);
+  }
+}
+} // namespace skywing::internal
@@ -0,0 +1,74 @@
+#ifndef SKYNET_INTERNAL_PUBLISH_TEMPLATE_HPP
+#define SKYNET_INTERNAL_PUBLISH_TEMPLATE_HPP
+
+#include "skywing_core/internal/devices/communicator.hpp"
+#include "skywing_core/internal/wire_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace skywing::internal {
+/** \brief Reusable state for building the publishes on one tag
+ *
+ * Publishes on a tag usually have the same shape each time, so the size of
+ * the largest message built for each set of wire features is kept to set
+ * aside enough space for the next one up front, and the buffers of frames
+ * that have finished sending are built into again.  Once a tag has settled,
+ * building its publishes doesn't allocate.
+ *
+ * Not thread safe; the manager only uses it while holding its job lock.
+ */
+class PublishTemplate {
+public:
+  /// The most buffers kept for a tag; more are only needed while neighbors fall behind
+  static constexpr std::size_t max_buffers = 16;
+
+  PublishTemplate() noexcept = default;
+
+  /** \brief Creates the template for a tag sent as the index to neighbors
+   * that support wire_feature::tag_indices
+   */
+  explicit PublishTemplate(std::uint32_t tag_index) noexcept : tag_index_{tag_index} {}
+
+  /** \brief Returns the index the tag is sent as, or 0 if it's always named in full
+   */
+  std::uint32_t tag_index() const noexcept { return tag_index_; }
+
+  /** \brief Returns a buffer to build the next frame in
+   *
+   * Reuses a buffer whose frame nothing refers to anymore if there is one.
+   * The contents are unspecified.
+   */
+  std::shared_ptr<std::vector<std::byte>> acquire() noexcept;
+
+  /** \brief Returns the space to set aside for a message, or 0 if none has
+   * been built with the features yet
+   */
+  std::size_t size_hint(WireFeatures features) const noexcept;
+
+  /** \brief Records the space that a message built with the features took
+   */
+  void record_size(WireFeatures features, std::size_t size) noexcept;
+
+  /** \brief Returns the number of buffers kept
+   */
+  std::size_t buffers() const noexcept { return buffers_.size(); }
+
+  /** \brief Returns the number of times a buffer has been reused
+   */
+  std::size_t reused_buffers() const noexcept { return reused_buffers_; }
+
+private:
+  std::uint32_t tag_index_ = 0;
+  std::vector<std::shared_ptr<std::vector<std::byte>>> buffers_;
+  // Where to start looking for a free buffer, so that they are used in turn
+  std::size_t next_ = 0;
+  std::vector<std::pair<WireFeatures, std::size_t>> size_hints_;
+  std::size_t reused_buffers_ = 0;
+}; // class PublishTemplate
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_PUBLISH_TEMPLATE_HPP
@@ -0,0 +1,93 @@
+#ifndef SKYNET_INTERNAL_PUBLISH_VALUE_VIEW_HPP
+#define SKYNET_INTERNAL_PUBLISH_VALUE_VIEW_HPP
+
+#include "skywing_core/internal/utility/type_list.hpp"
+#include "skywing_core/types.hpp"
+
+#include "gsl/span"
+
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace skywing::internal {
+/// The element types of vectors that can be published straight from the caller's memory
+using PublishSpanTypeList = TypeList<
+  float,
+  double,
+  std::int8_t,
+  std::int16_t,
+  std::int32_t,
+  std::int64_t,
+  std::uint8_t,
+  std::uint16_t,
+  std::uint32_t,
+  std::uint64_t>;
+
+/// True if vectors of the type can be published from a span
+template<typename T>
+inline constexpr bool is_publish_span_element = index_of<T, PublishSpanTypeList> != size<PublishSpanTypeList>;
+
+namespace detail {
+template<typename T>
+using ConstSpan = gsl::span<const T>;
+
+// The element type of a published vector, or void for anything else
+template<typename T>
+struct PublishedElement {
+  using Type = void;
+};
+template<typename T>
+struct PublishedElement<std::vector<T>> {
+  using Type = T;
+};
+} // namespace detail
+
+/** \brief A value being published whose elements may still be in the caller's memory
+ *
+ * Numeric vectors can be given as a span, which is encoded straight from the
+ * memory it points to; that memory only has to stay valid until the publish
+ * returns.  Everything else is held as a PublishValueVariant.
+ */
+using PublishValueView
+  = ApplyTo<Append<TypeList<PublishValueVariant>, ApplyToEach<PublishSpanTypeList, detail::ConstSpan>>, std::variant>;
+
+/** \brief Copies the value a view refers to
+ */
+inline PublishValueVariant to_publish_value(const PublishValueView& view) noexcept
+{
+  return std::visit(
+    [](const auto& value) -> PublishValueVariant {
+      using ViewType = std::decay_t<decltype(value)>;
+      if constexpr (std::is_same_v<ViewType, PublishValueVariant>) { return value; }
+      else {
+        return std::vector<std::remove_const_t<typename ViewType::element_type>>(value.begin(), value.end());
+      }
+    },
+    view);
+}
+
+/** \brief Makes the view of an argument published as type T
+ *
+ * Arguments for numeric vectors that can be viewed as a span of their
+ * elements are, so that they aren't copied; anything else is converted to T.
+ */
+template<typename T, typename Arg>
+PublishValueView make_publish_value_view(const Arg& arg) noexcept
+{
+  using Element = typename detail::PublishedElement<T>::Type;
+  // Only asks about the span once it is known to be one that exists
+  if constexpr (std::conjunction_v<
+                  std::bool_constant<is_publish_span_element<Element>>,
+                  std::is_constructible<gsl::span<const Element>, const Arg&>>) {
+    return gsl::span<const Element>{arg};
+  }
+  else {
+    static_assert(std::is_convertible_v<const Arg&, T>, "Argument value can not be converted to the tag type!");
+    return PublishValueVariant{static_cast<T>(arg)};
+  }
+}
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_PUBLISH_VALUE_VIEW_HPP
@@ -1,6 +1,8 @@
 #ifndef SKYNET_INTERNAL_TAG_BUFFER_HPP
 #define SKYNET_INTERNAL_TAG_BUFFER_HPP
 
+#include "skywing_core/internal/capn_proto_wrapper.hpp"
+#include "skywing_core/internal/typed_publish_serializer.hpp"
 #include "skywing_core/internal/utility/type_list.hpp"
 #include "skywing_core/types.hpp"
 
@@ -128,6 +130,13 @@ public:
    */
   void* get() noexcept { return do_get(); }
 
+  /** \brief Returns how many versions have arrived since the data was last
+   * fetched, which is how far behind whatever reads the buffer is
+   *
+   * The first value counts as one however many versions came before it.
+   */
+  VersionID unread_versions() const noexcept { return do_unread_versions(); }
+
   /** \brief Adds data if the version is newer
    */
   void add(gsl::span<PublishValueVariant> value, const VersionID version) noexcept { return do_add(value, version); }
@@ -136,6 +145,13 @@ public:
     return do_add(value, version);
   }
 
+  /** \brief Adds data straight from a received message if the version is newer
+   *
+   * The message is decoded directly into the buffer's storage.  Returns false
+   * if the message couldn't be decoded as the buffer's types.
+   */
+  bool add(const PublishData& data) noexcept { return do_add(data); }
+
   /** \brief Resets the tag buffer to the default state
    */
   void reset() noexcept { do_reset(); }
@@ -145,8 +161,10 @@ public:
 private:
   virtual bool do_has_data() const noexcept = 0;
   virtual void* do_get() noexcept = 0;
+  virtual VersionID do_unread_versions() const noexcept = 0;
   virtual void do_add(gsl::span<PublishValueVariant> value, const VersionID version) noexcept = 0;
   virtual void do_add(gsl::span<const PublishValueVariant> value, const VersionID version) noexcept = 0;
+  virtual bool do_add(const PublishData& data) noexcept = 0;
   virtual void do_reset() noexcept = 0;
 }; // DiscardOldVersionTagBufferBase
 
@@ -165,6 +183,13 @@ private:
     return &value_;
   }
 
+  VersionID do_unread_versions() const noexcept override
+  {
+    if (!this->has_data()) { return 0; }
+    if (this->last_fetched_version_ == tag_no_data) { return 1; }
+    return this->stored_version_ - this->last_fetched_version_;
+  }
+
   void do_add(gsl::span<PublishValueVariant> value, const VersionID version) noexcept override
   {
     if (version > this->stored_version_ || this->stored_version_ == tag_no_data) {
@@ -181,6 +206,16 @@ private:
     }
   }
 
+  bool do_add(const PublishData& data) noexcept override
+  {
+    const auto version = data.version();
+    if (version > this->stored_version_ || this->stored_version_ == tag_no_data) {
+      if (!TypedPublishSerializer<Ts...>::read(data, value_)) { return false; }
+      this->stored_version_ = version;
+    }
+    return true;
+  }
+
   void do_reset() noexcept override
   {
     stored_version_ = tag_no_data;
@@ -0,0 +1,128 @@
+#ifndef SKYNET_INTERNAL_TYPED_PUBLISH_SERIALIZER_HPP
+#define SKYNET_INTERNAL_TYPED_PUBLISH_SERIALIZER_HPP
+
+#include "message_format.capnp.h"
+
+#include "skywing_core/include/publish_value_handler.hpp"
+#include "skywing_core/internal/capn_proto_wrapper.hpp"
+#include "skywing_core/internal/utility/type_list.hpp"
+#include "skywing_core/internal/wire_features.hpp"
+#include "skywing_core/types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace skywing::internal {
+/** \brief Values being published, which know how to write themselves into a message
+ *
+ * Lets the manager encode values for each neighbor without knowing their
+ * types, at the cost of one virtual call per message instead of a visit per
+ * value.
+ */
+class PublishValueWriter {
+public:
+  /** \brief Returns the number of values
+   */
+  virtual std::size_t size() const noexcept = 0;
+
+  /** \brief Returns a rough upper bound on the bytes the contents of the values take
+   */
+  virtual std::size_t encoded_data_size_guess() const noexcept = 0;
+
+  /** \brief Writes the values into the list for them in a publish
+   *
+   * \param features The wire features the receiver supports
+   * \param quantization The lossy encoding for floating point vectors
+   */
+  virtual void write(
+    capnp::List<cpnpro::PublishValue>::Builder values, WireFeatures features, Quantization quantization) const
+    noexcept = 0;
+
+  /** \brief Copies the values, for the paths that need them without their types
+   */
+  virtual std::vector<PublishValueVariant> to_variants() const noexcept = 0;
+
+  virtual ~PublishValueWriter() = default;
+}; // class PublishValueWriter
+
+/** \brief Writes and reads the values of a tag with types Ts
+ *
+ * Each value is handled by the code for its exact type, picked at compile
+ * time, so nothing goes through PublishValueVariant or looks up a type at
+ * run time.  The values are referred to, not copied, so the serializer must
+ * not outlive them.
+ */
+template<typename... Ts>
+class TypedPublishSerializer final : public PublishValueWriter {
+public:
+  static_assert(
+    (... && (index_of<Ts, PublishValueTypeList> != internal::size<PublishValueTypeList>)),
+    "Only the types in PublishValueTypeList can be published!");
+
+  /// The index into PublishValueTypeList of each value
+  static constexpr std::array<std::uint8_t, sizeof...(Ts)> type_indices{
+    static_cast<std::uint8_t>(index_of<Ts, PublishValueTypeList>)...};
+
+  explicit TypedPublishSerializer(const Ts&... values) noexcept : values_{values...} {}
+
+  std::size_t size() const noexcept override { return sizeof...(Ts); }
+
+  std::size_t encoded_data_size_guess() const noexcept override
+  {
+    return std::apply(
+      [](const Ts&... values) { return (std::size_t{0} + ... + detail::encoded_data_size_guess(values)); }, values_);
+  }
+
+  void write(
+    capnp::List<cpnpro::PublishValue>::Builder values,
+    const WireFeatures features,
+    const Quantization quantization) const noexcept override
+  {
+    write_each(values, features, quantization, std::index_sequence_for<Ts...>{});
+  }
+
+  std::vector<PublishValueVariant> to_variants() const noexcept override
+  {
+    return std::apply([](const Ts&... values) { return std::vector<PublishValueVariant>{values...}; }, values_);
+  }
+
+  /** \brief Decodes a publish into storage for the values
+   *
+   * \return false if the values aren't of types Ts
+   */
+  static bool read(const PublishData& data, ValueOrTuple<Ts...>& out) noexcept { return data.value_into<Ts...>(out); }
+
+private:
+  template<std::size_t... Is>
+  void write_each(
+    capnp::List<cpnpro::PublishValue>::Builder& values,
+    const WireFeatures features,
+    const Quantization quantization,
+    std::index_sequence<Is...>) const noexcept
+  {
+    // Unused if there are no values
+    (void)values;
+    (void)features;
+    (void)quantization;
+    (..., write_one(values[Is], std::get<Is>(values_), features, quantization));
+  }
+
+  template<typename T>
+  static void write_one(
+    cpnpro::PublishValue::Builder to_build,
+    const T& value,
+    const WireFeatures features,
+    const Quantization quantization) noexcept
+  {
+    detail::set_value(to_build, value, features, quantization);
+  }
+
+  std::tuple<const Ts&...> values_;
+}; // class TypedPublishSerializer
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_TYPED_PUBLISH_SERIALIZER_HPP
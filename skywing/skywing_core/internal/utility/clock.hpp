@@ -0,0 +1,73 @@
+#ifndef SKYNET_INTERNAL_UTILITY_CLOCK_HPP
+#define SKYNET_INTERNAL_UTILITY_CLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+
+namespace skywing::internal {
+/** \brief Source of the current time for timers and timestamps
+ *
+ * Time points are always steady_clock ones so that the rest of the code doesn't
+ * need to care which clock is in use.
+ */
+class Clock {
+public:
+  using time_point = std::chrono::steady_clock::time_point;
+
+  virtual ~Clock() = default;
+
+  /** \brief Returns the current time
+   *
+   * Safe to call from any thread.
+   */
+  virtual time_point now() const noexcept = 0;
+
+  /** \brief Returns the clock that follows std::chrono::steady_clock
+   */
+  static const Clock& steady() noexcept;
+
+protected:
+  Clock() = default;
+  Clock(const Clock&) = default;
+  Clock& operator=(const Clock&) = default;
+}; // class Clock
+
+/** \brief Clock that only moves when told to, for simulations
+ *
+ * Starts at the epoch of steady_clock.
+ */
+class VirtualClock : public Clock {
+public:
+  VirtualClock() noexcept = default;
+
+  // Can not be copied; everything using it holds a reference
+  VirtualClock(const VirtualClock&) = delete;
+  VirtualClock& operator=(const VirtualClock&) = delete;
+
+  time_point now() const noexcept override { return time_point{time_point::duration{ticks_.load()}}; }
+
+  /** \brief Moves the clock forward to a time; does nothing if it is already past it
+   *
+   * Only one thread may advance the clock.
+   */
+  void advance_to(const time_point time) noexcept
+  {
+    if (time > now()) { ticks_.store(time.time_since_epoch().count()); }
+  }
+
+private:
+  std::atomic<time_point::rep> ticks_{0};
+}; // class VirtualClock
+
+inline const Clock& Clock::steady() noexcept
+{
+  class SteadyClock : public Clock {
+  public:
+    time_point now() const noexcept override { return std::chrono::steady_clock::now(); }
+  };
+  static const SteadyClock instance;
+  return instance;
+}
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_UTILITY_CLOCK_HPP
@@ -0,0 +1,230 @@
+#ifndef SKYNET_INTERNAL_UTILITY_FLAT_ID_MAP_HPP
+#define SKYNET_INTERNAL_UTILITY_FLAT_ID_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace skywing::internal {
+/** \brief Hash map from small integer IDs, such as the symbols handed out by a
+ * SymbolTable, stored in a single array
+ *
+ * Uses open addressing with linear probing, so a lookup touches one or two
+ * cache lines instead of following a chain of nodes.  Erased entries are
+ * marked rather than moved, which keeps iterators to the other entries valid
+ * across an erase so that entries can be erased while iterating.  Inserting
+ * may move everything and invalidates all iterators and references.
+ *
+ * The two largest IDs are reserved; looking them up never finds anything.
+ * Values must be default constructible, and erased ones are reset to that.
+ */
+template<typename Value>
+class FlatIdMap {
+public:
+  using key_type = std::uint32_t;
+  using mapped_type = Value;
+  // The key isn't const so that entries can be moved around; it must not be changed
+  using value_type = std::pair<key_type, Value>;
+
+  /// Marks a slot that has never been used
+  static constexpr key_type empty_key = std::numeric_limits<key_type>::max();
+
+  /// Marks a slot whose entry was erased, which lookups have to probe past
+  static constexpr key_type erased_key = empty_key - 1;
+
+  template<bool IsConst>
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = FlatIdMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+    using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+
+    Iterator() noexcept = default;
+
+    // Mutable iterators convert to const ones
+    template<bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    Iterator(const Iterator<OtherConst>& other) noexcept : slot_{other.slot_}, end_{other.end_}
+    {}
+
+    reference operator*() const noexcept { return *slot_; }
+    pointer operator->() const noexcept { return slot_; }
+
+    Iterator& operator++() noexcept
+    {
+      ++slot_;
+      skip_free();
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept
+    {
+      auto to_ret = *this;
+      ++*this;
+      return to_ret;
+    }
+
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept { return lhs.slot_ == rhs.slot_; }
+    friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept { return lhs.slot_ != rhs.slot_; }
+
+  private:
+    friend class FlatIdMap;
+    template<bool>
+    friend class Iterator;
+
+    Iterator(pointer slot, pointer end) noexcept : slot_{slot}, end_{end} { skip_free(); }
+
+    void skip_free() noexcept
+    {
+      while (slot_ != end_ && !is_used(slot_->first)) {
+        ++slot_;
+      }
+    }
+
+    pointer slot_ = nullptr;
+    pointer end_ = nullptr;
+  }; // class Iterator
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  iterator begin() noexcept { return {slots_.data(), slots_.data() + slots_.size()}; }
+  iterator end() noexcept { return {slots_.data() + slots_.size(), slots_.data() + slots_.size()}; }
+  const_iterator begin() const noexcept { return cbegin(); }
+  const_iterator end() const noexcept { return cend(); }
+  const_iterator cbegin() const noexcept { return {slots_.data(), slots_.data() + slots_.size()}; }
+  const_iterator cend() const noexcept { return {slots_.data() + slots_.size(), slots_.data() + slots_.size()}; }
+
+  std::size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+
+  iterator find(const key_type key) noexcept
+  {
+    const auto index = find_index(key);
+    return index == npos ? end() : make_iterator(index);
+  }
+
+  const_iterator find(const key_type key) const noexcept
+  {
+    const auto index = find_index(key);
+    return index == npos ? cend() : const_iterator{slots_.data() + index, slots_.data() + slots_.size()};
+  }
+
+  /** \brief Inserts a value constructed from the arguments if the key isn't
+   * already present
+   *
+   * \return The entry for the key, and true if it was inserted
+   */
+  template<typename... Args>
+  std::pair<iterator, bool> try_emplace(const key_type key, Args&&... args) noexcept
+  {
+    if (const auto index = find_index(key); index != npos) { return {make_iterator(index), false}; }
+    if ((size_ + erased_ + 1) * 4 > slots_.size() * 3) { rehash(); }
+    // The key isn't anywhere along its probe sequence, so the first erased slot
+    // on it can be reused, which keeps the sequences short
+    std::size_t index = home_index(key);
+    while (is_used(slots_[index].first)) {
+      index = (index + 1) & mask();
+    }
+    if (slots_[index].first == erased_key) { --erased_; }
+    slots_[index].first = key;
+    slots_[index].second = Value(std::forward<Args>(args)...);
+    ++size_;
+    return {make_iterator(index), true};
+  }
+
+  Value& operator[](const key_type key) noexcept { return try_emplace(key).first->second; }
+
+  /** \brief Erases an entry, returning the iterator to the next one
+   */
+  iterator erase(const_iterator iter) noexcept
+  {
+    const auto index = static_cast<std::size_t>(iter.slot_ - slots_.data());
+    slots_[index] = value_type{erased_key, Value{}};
+    --size_;
+    ++erased_;
+    return make_iterator(index);
+  }
+
+  std::size_t erase(const key_type key) noexcept
+  {
+    const auto iter = find(key);
+    if (iter == end()) { return 0; }
+    erase(iter);
+    return 1;
+  }
+
+  void clear() noexcept
+  {
+    slots_.clear();
+    size_ = 0;
+    erased_ = 0;
+  }
+
+private:
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+  static bool is_used(const key_type key) noexcept { return key < erased_key; }
+
+  std::size_t mask() const noexcept { return slots_.size() - 1; }
+
+  std::size_t home_index(const key_type key) const noexcept
+  {
+    // Fibonacci hashing spreads consecutive IDs across the table
+    return static_cast<std::size_t>((std::uint64_t{key} * 0x9E3779B97F4A7C15u) >> (64 - bits_));
+  }
+
+  std::size_t find_index(const key_type key) const noexcept
+  {
+    if (slots_.empty() || !is_used(key)) { return npos; }
+    for (std::size_t index = home_index(key);; index = (index + 1) & mask()) {
+      if (slots_[index].first == key) { return index; }
+      if (slots_[index].first == empty_key) { return npos; }
+    }
+  }
+
+  iterator make_iterator(const std::size_t index) noexcept
+  {
+    return {slots_.data() + index, slots_.data() + slots_.size()};
+  }
+
+  // Grows the table if it's getting full, or just clears out the erased
+  // slots if that's what is taking up the space
+  void rehash() noexcept
+  {
+    std::size_t capacity = std::max<std::size_t>(slots_.size(), 8);
+    while ((size_ + 1) * 2 > capacity) {
+      capacity *= 2;
+    }
+    std::vector<value_type> old_slots(capacity, value_type{empty_key, Value{}});
+    old_slots.swap(slots_);
+    bits_ = 0;
+    while ((std::size_t{1} << bits_) < capacity) {
+      ++bits_;
+    }
+    erased_ = 0;
+    for (auto& slot : old_slots) {
+      if (!is_used(slot.first)) { continue; }
+      auto index = home_index(slot.first);
+      while (slots_[index].first != empty_key) {
+        index = (index + 1) & mask();
+      }
+      slots_[index] = std::move(slot);
+    }
+  }
+
+  std::vector<value_type> slots_;
+  // log2 of the number of slots
+  unsigned bits_ = 0;
+  std::size_t size_ = 0;
+  std::size_t erased_ = 0;
+}; // class FlatIdMap
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_UTILITY_FLAT_ID_MAP_HPP
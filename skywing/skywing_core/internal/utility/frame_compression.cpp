@@ -0,0 +1,227 @@
+#include "skywing_core/internal/utility/frame_compression.hpp"
+
+#include "skywing_core/internal/utility/network_conv.hpp"
+
+#include <array>
+#include <cstring>
+
+#ifdef SKYWING_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+namespace skywing::internal {
+namespace {
+constexpr std::size_t word_size = 8;
+
+// Original size, packed size, compressed size, and a reserved field
+constexpr std::size_t prefix_size = 4 * sizeof(NetworkSizeType);
+static_assert(prefix_size % word_size == 0);
+
+// The same as the largest frame a ReceiveBuffer accepts
+constexpr std::size_t max_message_size = std::size_t{1} << 30;
+
+constexpr std::size_t round_up_to_word(const std::size_t size) noexcept
+{
+  return (size + word_size - 1) / word_size * word_size;
+}
+
+void write_size(std::byte* dest, const std::size_t size) noexcept
+{
+  const auto bytes = to_network_bytes(static_cast<NetworkSizeType>(size));
+  std::memcpy(dest, bytes.data(), bytes.size());
+}
+
+std::size_t read_size(const std::byte* src) noexcept
+{
+  std::array<std::byte, sizeof(NetworkSizeType)> bytes;
+  std::memcpy(bytes.data(), src, bytes.size());
+  return from_network_bytes(bytes);
+}
+
+std::size_t count_zero_bytes(const std::byte* word) noexcept
+{
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < word_size; ++i) {
+    if (word[i] == std::byte{0}) { ++count; }
+  }
+  return count;
+}
+
+// Cap'n Proto's packing: each word becomes a byte marking which of its bytes
+// are non-zero followed by those bytes.  A word with no non-zero bytes is
+// followed by a count of further zero words, and one with no zero bytes by a
+// count of further words that are copied as is.
+std::vector<std::byte> pack(const std::byte* data, const std::size_t size) noexcept
+{
+  std::vector<std::byte> to_ret;
+  // The worst case is a tag and a count for every word
+  to_ret.reserve(size + size / 4 + 2);
+  const auto num_words = size / word_size;
+  std::size_t i = 0;
+  while (i < num_words) {
+    const std::byte* word = data + i * word_size;
+    std::uint8_t tag = 0;
+    for (std::size_t b = 0; b < word_size; ++b) {
+      if (word[b] != std::byte{0}) { tag |= static_cast<std::uint8_t>(1 << b); }
+    }
+    to_ret.push_back(std::byte{tag});
+    for (std::size_t b = 0; b < word_size; ++b) {
+      if (word[b] != std::byte{0}) { to_ret.push_back(word[b]); }
+    }
+    ++i;
+    if (tag != 0x00 && tag != 0xff) { continue; }
+    // Zero words are counted; words that would barely shrink are copied
+    const auto max_zeros = tag == 0x00 ? word_size : 1;
+    const auto min_zeros = tag == 0x00 ? word_size : 0;
+    std::size_t run = 0;
+    while (i + run < num_words && run < 0xff) {
+      const auto zeros = count_zero_bytes(data + (i + run) * word_size);
+      if (zeros < min_zeros || zeros > max_zeros) { break; }
+      ++run;
+    }
+    to_ret.push_back(static_cast<std::byte>(run));
+    if (tag == 0xff) { to_ret.insert(to_ret.end(), data + i * word_size, data + (i + run) * word_size); }
+    i += run;
+  }
+  return to_ret;
+}
+
+// Reverses pack(), failing unless the input fills the output exactly
+bool unpack(const std::byte* in, const std::size_t in_size, std::byte* out, const std::size_t out_size) noexcept
+{
+  std::size_t in_pos = 0;
+  std::size_t out_pos = 0;
+  while (out_pos < out_size) {
+    if (in_pos == in_size) { return false; }
+    const auto tag = std::to_integer<std::uint8_t>(in[in_pos++]);
+    for (std::size_t b = 0; b < word_size; ++b) {
+      if ((tag & (1 << b)) == 0) {
+        out[out_pos + b] = std::byte{0};
+        continue;
+      }
+      if (in_pos == in_size) { return false; }
+      out[out_pos + b] = in[in_pos++];
+    }
+    out_pos += word_size;
+    if (tag != 0x00 && tag != 0xff) { continue; }
+    if (in_pos == in_size) { return false; }
+    const auto run = std::to_integer<std::size_t>(in[in_pos++]) * word_size;
+    if (run > out_size - out_pos) { return false; }
+    if (tag == 0x00) { std::memset(out + out_pos, 0, run); }
+    else {
+      if (run > in_size - in_pos) { return false; }
+      std::memcpy(out + out_pos, in + in_pos, run);
+      in_pos += run;
+    }
+    out_pos += run;
+  }
+  return in_pos == in_size;
+}
+} // namespace
+
+std::uint8_t frame_flags(const gsl::span<const std::byte> frame) noexcept
+{
+  if (static_cast<std::size_t>(frame.size()) < frame_header_size) { return 0; }
+  return std::to_integer<std::uint8_t>(frame.data()[frame_flags_offset]);
+}
+
+std::optional<std::vector<std::byte>> compress_frame(
+  const gsl::span<const std::byte> frame, const WireFeatures features) noexcept
+{
+  const auto frame_size = static_cast<std::size_t>(frame.size());
+  if (frame_size <= frame_header_size || (features & compression_wire_features) == 0) { return {}; }
+  const std::byte* message = frame.data() + frame_header_size;
+  const auto message_size = frame_size - frame_header_size;
+
+  std::uint8_t flags = 0;
+  std::vector<std::byte> packed;
+  const std::byte* body = message;
+  std::size_t body_size = message_size;
+  if (features & wire_feature::packed) {
+    packed = pack(message, message_size);
+    body = packed.data();
+    body_size = packed.size();
+    flags |= frame_flag::packed;
+  }
+  const auto packed_size = body_size;
+
+  std::vector<std::byte> to_ret;
+#ifdef SKYWING_HAVE_LZ4
+  if ((features & wire_feature::lz4) && body_size <= LZ4_MAX_INPUT_SIZE) {
+    const int bound = LZ4_compressBound(static_cast<int>(body_size));
+    to_ret.resize(frame_header_size + prefix_size + round_up_to_word(static_cast<std::size_t>(bound)));
+    const int written = LZ4_compress_default(
+      reinterpret_cast<const char*>(body),
+      reinterpret_cast<char*>(to_ret.data() + frame_header_size + prefix_size),
+      static_cast<int>(body_size),
+      bound);
+    if (written > 0) {
+      body_size = static_cast<std::size_t>(written);
+      flags |= frame_flag::lz4;
+    }
+  }
+#endif
+  if (flags == 0) { return {}; }
+  if ((flags & frame_flag::lz4) == 0) {
+    to_ret.assign(frame_header_size + prefix_size + round_up_to_word(body_size), std::byte{0});
+    std::memcpy(to_ret.data() + frame_header_size + prefix_size, body, body_size);
+  }
+  // Shrinking leaves the zeroed padding after the data
+  to_ret.resize(frame_header_size + prefix_size + round_up_to_word(body_size));
+  if (to_ret.size() >= frame_size) { return {}; }
+
+  write_size(to_ret.data(), to_ret.size() - frame_header_size);
+  to_ret[frame_flags_offset] = std::byte{flags};
+  std::byte* prefix = to_ret.data() + frame_header_size;
+  write_size(prefix, message_size);
+  write_size(prefix + sizeof(NetworkSizeType), packed_size);
+  write_size(prefix + 2 * sizeof(NetworkSizeType), body_size);
+  return to_ret;
+}
+
+bool decompress_payload(
+  const gsl::span<const std::byte> payload, const std::uint8_t flags, std::vector<std::uint64_t>& out) noexcept
+{
+  static_assert(sizeof(std::uint64_t) == word_size);
+  const auto payload_size = static_cast<std::size_t>(payload.size());
+  if (payload_size < prefix_size || (flags & ~(frame_flag::packed | frame_flag::lz4)) != 0) { return false; }
+  const auto message_size = read_size(payload.data());
+  const auto packed_size = read_size(payload.data() + sizeof(NetworkSizeType));
+  const auto body_size = read_size(payload.data() + 2 * sizeof(NetworkSizeType));
+  if (
+    message_size % word_size != 0 || message_size > max_message_size || packed_size > max_message_size
+    || body_size > payload_size - prefix_size) {
+    return false;
+  }
+  // Without packing the stage before LZ4 is the message itself
+  if ((flags & frame_flag::packed) == 0 && packed_size != message_size) { return false; }
+  out.resize(message_size / word_size);
+  auto* const dest = reinterpret_cast<std::byte*>(out.data());
+  const std::byte* body = payload.data() + prefix_size;
+
+  if (flags & frame_flag::lz4) {
+#ifdef SKYWING_HAVE_LZ4
+    std::vector<std::byte> unpacked_lz4;
+    std::byte* lz4_dest = dest;
+    if (flags & frame_flag::packed) {
+      unpacked_lz4.resize(packed_size);
+      lz4_dest = unpacked_lz4.data();
+    }
+    const int read = LZ4_decompress_safe(
+      reinterpret_cast<const char*>(body),
+      reinterpret_cast<char*>(lz4_dest),
+      static_cast<int>(body_size),
+      static_cast<int>(packed_size));
+    if (read < 0 || static_cast<std::size_t>(read) != packed_size) { return false; }
+    if ((flags & frame_flag::packed) == 0) { return true; }
+    return unpack(unpacked_lz4.data(), unpacked_lz4.size(), dest, message_size);
+#else
+    return false;
+#endif
+  }
+  if (flags & frame_flag::packed) { return body_size == packed_size && unpack(body, body_size, dest, message_size); }
+  if (body_size != message_size) { return false; }
+  std::memcpy(dest, body, body_size);
+  return true;
+}
+} // namespace skywing::internal
@@ -0,0 +1,54 @@
+#ifndef SKYNET_INTERNAL_UTILITY_FRAME_COMPRESSION_HPP
+#define SKYNET_INTERNAL_UTILITY_FRAME_COMPRESSION_HPP
+
+#include "skywing_core/internal/wire_features.hpp"
+
+#include "gsl/span"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace skywing::internal {
+namespace frame_flag {
+/// The payload was packed with Cap'n Proto's packing scheme
+inline constexpr std::uint8_t packed = 1 << 0;
+
+/// The payload was compressed with LZ4, after packing if that is also set
+inline constexpr std::uint8_t lz4 = 1 << 1;
+} // namespace frame_flag
+
+/// The wire features that allow frames to be compressed
+inline constexpr WireFeatures compression_wire_features = wire_feature::packed | wire_feature::lz4;
+
+/** \brief Returns the flags in the header of a complete frame
+ */
+std::uint8_t frame_flags(gsl::span<const std::byte> frame) noexcept;
+
+/** \brief Compresses a complete frame, header included, with every method
+ * allowed by the wire features
+ *
+ * The compressed payload starts with two words holding the size of the
+ * original message, its size after packing, and the size of the compressed
+ * data that follows; it is padded to a whole number of words so that frames
+ * stay aligned.
+ *
+ * \return The compressed frame, or nothing if no method is allowed or
+ * compressing doesn't make the frame smaller
+ */
+std::optional<std::vector<std::byte>> compress_frame(gsl::span<const std::byte> frame, WireFeatures features) noexcept;
+
+/** \brief Restores the message from the payload of a compressed frame
+ *
+ * \param payload The payload of the frame, without the header
+ * \param flags The flags from the header of the frame
+ * \param out Where the message is written; its previous contents are replaced
+ * \return false if the payload is malformed or uses a method this build doesn't
+ * support
+ */
+bool decompress_payload(
+  gsl::span<const std::byte> payload, std::uint8_t flags, std::vector<std::uint64_t>& out) noexcept;
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_UTILITY_FRAME_COMPRESSION_HPP
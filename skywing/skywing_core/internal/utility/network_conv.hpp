@@ -7,6 +7,20 @@
 #include <cstddef>
 
 namespace skywing::internal {
+/** \brief Size of the header in front of every message on the wire
+ *
+ * The header holds the size of the message as a NetworkSizeType followed by a
+ * byte of flags describing how the message is encoded and reserved bytes,
+ * padding it to a whole Cap'n Proto word.  Since messages are
+ * also a whole number of words, this keeps every message in a stream of them
+ * word-aligned so that it can be read in place.
+ */
+constexpr std::size_t frame_header_size = 8;
+
+/// Offset of the flags byte within the header
+constexpr std::size_t frame_flags_offset = sizeof(NetworkSizeType);
+static_assert(frame_header_size > frame_flags_offset);
+
 /// Convert from an array of bytes from the network to a local value
 NetworkSizeType from_network_bytes(const std::array<std::byte, sizeof(NetworkSizeType)>& data) noexcept;
 
@@ -0,0 +1,213 @@
+#include "skywing_core/internal/utility/quantize.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace skywing::internal {
+namespace {
+std::uint32_t bits_of(const float value) noexcept
+{
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+float float_from_bits(const std::uint32_t bits) noexcept
+{
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// The largest stored magnitude of each scaled encoding; the most negative
+// value is left unused so that the levels are symmetric around the offset
+template<typename Stored>
+constexpr double max_level = static_cast<double>(std::numeric_limits<Stored>::max());
+
+template<typename Stored, typename T>
+std::optional<QuantizedValues> quantize_scaled(const std::vector<T>& values) noexcept
+{
+  QuantizedValues to_ret;
+  to_ret.data.resize(values.size() * sizeof(Stored));
+  if (values.empty()) { return to_ret; }
+  if (!std::all_of(values.begin(), values.end(), [](const T value) { return std::isfinite(value); })) {
+    return std::nullopt;
+  }
+  const auto [min, max] = std::minmax_element(values.begin(), values.end());
+  const double low = *min;
+  const double high = *max;
+  if (!std::isfinite(high - low)) { return std::nullopt; }
+  to_ret.offset = low + (high - low) / 2;
+  to_ret.scale = (high - low) / (2 * max_level<Stored>);
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    double level = 0.0;
+    if (to_ret.scale > 0.0) {
+      level = std::clamp(std::round((values[i] - to_ret.offset) / to_ret.scale), -max_level<Stored>, max_level<Stored>);
+    }
+    const auto stored = static_cast<Stored>(level);
+    std::memcpy(to_ret.data.data() + i * sizeof(Stored), &stored, sizeof(Stored));
+  }
+  return to_ret;
+}
+
+template<typename Stored, typename T>
+void dequantize_scaled(const std::byte* data, const double scale, const double offset, std::vector<T>& out) noexcept
+{
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    Stored stored;
+    std::memcpy(&stored, data + i * sizeof(Stored), sizeof(Stored));
+    out[i] = static_cast<T>(offset + scale * stored);
+  }
+}
+
+// Fails if a finite value would become an infinity, which is when all of the
+// bits of the stored exponent are set
+template<typename T, typename Convert>
+std::optional<QuantizedValues>
+  quantize_half(const std::vector<T>& values, const Convert& convert, const std::uint16_t exponent_mask) noexcept
+{
+  QuantizedValues to_ret;
+  to_ret.data.resize(values.size() * sizeof(std::uint16_t));
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    if (std::isfinite(values[i]) && std::abs(values[i]) > std::numeric_limits<float>::max()) { return std::nullopt; }
+    const std::uint16_t stored = convert(static_cast<float>(values[i]));
+    if (std::isfinite(values[i]) && (stored & exponent_mask) == exponent_mask) { return std::nullopt; }
+    std::memcpy(to_ret.data.data() + i * sizeof(std::uint16_t), &stored, sizeof(std::uint16_t));
+  }
+  return to_ret;
+}
+
+template<typename T, typename Convert>
+void dequantize_half(const std::byte* data, std::vector<T>& out, const Convert& convert) noexcept
+{
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    std::uint16_t stored;
+    std::memcpy(&stored, data + i * sizeof(std::uint16_t), sizeof(std::uint16_t));
+    out[i] = static_cast<T>(convert(stored));
+  }
+}
+} // namespace
+
+// The conversions follow the branch-light versions by Fabian Giesen
+std::uint16_t to_float16(const float value) noexcept
+{
+  auto bits = bits_of(value);
+  const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+  bits &= 0x7fff'ffff;
+  // Infinity or NaN, or large enough to round to infinity
+  if (bits >= 0x4780'0000) { return sign | (bits > 0x7f80'0000 ? 0x7e00 : 0x7c00); }
+  // Too small to be a normal half; adding 0.5 lines the subnormal bits up at the bottom
+  if (bits < 0x3880'0000) {
+    const auto shifted = bits_of(float_from_bits(bits) + 0.5f);
+    return sign | static_cast<std::uint16_t>(shifted - bits_of(0.5f));
+  }
+  const std::uint32_t mantissa_odd = (bits >> 13) & 1;
+  // Rebias the exponent and round the mantissa to nearest even
+  bits += 0xc800'0fff + mantissa_odd;
+  return sign | static_cast<std::uint16_t>(bits >> 13);
+}
+
+float from_float16(const std::uint16_t half) noexcept
+{
+  constexpr std::uint32_t shifted_exponent = 0x7c00 << 13;
+  std::uint32_t bits = (half & 0x7fffu) << 13;
+  const auto exponent = bits & shifted_exponent;
+  // Rebias the exponent
+  bits += (127 - 15) << 23;
+  if (exponent == shifted_exponent) {
+    // Infinity or NaN
+    bits += (128 - 16) << 23;
+  }
+  else if (exponent == 0) {
+    // Zero or subnormal; renormalize through float arithmetic
+    bits += 1 << 23;
+    bits = bits_of(float_from_bits(bits) - float_from_bits(113 << 23));
+  }
+  bits |= static_cast<std::uint32_t>(half & 0x8000) << 16;
+  return float_from_bits(bits);
+}
+
+std::uint16_t to_bfloat16(const float value) noexcept
+{
+  const auto bits = bits_of(value);
+  // Keep NaNs as NaNs instead of letting rounding carry them into infinity
+  if ((bits & 0x7fff'ffff) > 0x7f80'0000) { return static_cast<std::uint16_t>((bits >> 16) | 0x40); }
+  return static_cast<std::uint16_t>((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);
+}
+
+float from_bfloat16(const std::uint16_t bits) noexcept
+{
+  return float_from_bits(static_cast<std::uint32_t>(bits) << 16);
+}
+
+std::size_t quantized_element_size(const Quantization quantization) noexcept
+{
+  switch (quantization) {
+  case Quantization::none:
+    return 0;
+  case Quantization::float16:
+  case Quantization::bfloat16:
+  case Quantization::scaled_int16:
+    return 2;
+  case Quantization::scaled_int8:
+    return 1;
+  }
+  return 0;
+}
+
+template<typename T>
+std::optional<QuantizedValues> quantize(const std::vector<T>& values, const Quantization quantization) noexcept
+{
+  switch (quantization) {
+  case Quantization::none:
+    return std::nullopt;
+  case Quantization::float16:
+    return quantize_half(values, to_float16, 0x7c00);
+  case Quantization::bfloat16:
+    return quantize_half(values, to_bfloat16, 0x7f80);
+  case Quantization::scaled_int8:
+    return quantize_scaled<std::int8_t>(values);
+  case Quantization::scaled_int16:
+    return quantize_scaled<std::int16_t>(values);
+  }
+  return std::nullopt;
+}
+
+template<typename T>
+bool dequantize(
+  const gsl::span<const std::byte> data,
+  const Quantization quantization,
+  const double scale,
+  const double offset,
+  std::vector<T>& out) noexcept
+{
+  const auto element_size = quantized_element_size(quantization);
+  const auto size = static_cast<std::size_t>(data.size());
+  if (element_size == 0 || size % element_size != 0) { return false; }
+  out.resize(size / element_size);
+  switch (quantization) {
+  case Quantization::none:
+    return false;
+  case Quantization::float16:
+    dequantize_half(data.data(), out, from_float16);
+    return true;
+  case Quantization::bfloat16:
+    dequantize_half(data.data(), out, from_bfloat16);
+    return true;
+  case Quantization::scaled_int8:
+    dequantize_scaled<std::int8_t>(data.data(), scale, offset, out);
+    return true;
+  case Quantization::scaled_int16:
+    dequantize_scaled<std::int16_t>(data.data(), scale, offset, out);
+    return true;
+  }
+  return false;
+}
+
+template std::optional<QuantizedValues> quantize(const std::vector<float>&, Quantization) noexcept;
+template std::optional<QuantizedValues> quantize(const std::vector<double>&, Quantization) noexcept;
+template bool dequantize(gsl::span<const std::byte>, Quantization, double, double, std::vector<float>&) noexcept;
+template bool dequantize(gsl::span<const std::byte>, Quantization, double, double, std::vector<double>&) noexcept;
+} // namespace skywing::internal
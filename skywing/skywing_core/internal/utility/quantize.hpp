@@ -0,0 +1,66 @@
+#ifndef SKYNET_INTERNAL_UTILITY_QUANTIZE_HPP
+#define SKYNET_INTERNAL_UTILITY_QUANTIZE_HPP
+
+#include "skywing_core/types.hpp"
+
+#include "gsl/span"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace skywing::internal {
+/// Converts to IEEE half precision, rounding to nearest even; values too large become infinity
+std::uint16_t to_float16(float value) noexcept;
+
+/// Converts from IEEE half precision
+float from_float16(std::uint16_t bits) noexcept;
+
+/// Converts to bfloat16, rounding to nearest even
+std::uint16_t to_bfloat16(float value) noexcept;
+
+/// Converts from bfloat16
+float from_bfloat16(std::uint16_t bits) noexcept;
+
+/** \brief A vector stored with fewer bytes per element
+ *
+ * The scaled encodings store round((element - offset) / scale).
+ */
+struct QuantizedValues {
+  /// The stored elements, little-endian
+  std::vector<std::byte> data;
+  double scale = 0.0;
+  double offset = 0.0;
+}; // struct QuantizedValues
+
+/** \brief Returns the number of bytes each element takes with an encoding
+ */
+std::size_t quantized_element_size(Quantization quantization) noexcept;
+
+/** \brief Encodes a vector with a lossy encoding
+ *
+ * Only instantiated for float and double.
+ *
+ * \return The encoded values, or nothing if the encoding is none or can't
+ * represent the values
+ */
+template<typename T>
+std::optional<QuantizedValues> quantize(const std::vector<T>& values, Quantization quantization) noexcept;
+
+/** \brief Expands values encoded by quantize()
+ *
+ * Only instantiated for float and double.
+ *
+ * \return false if the data isn't a whole number of elements for the encoding
+ */
+template<typename T>
+bool dequantize(
+  gsl::span<const std::byte> data,
+  Quantization quantization,
+  double scale,
+  double offset,
+  std::vector<T>& out) noexcept;
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_UTILITY_QUANTIZE_HPP
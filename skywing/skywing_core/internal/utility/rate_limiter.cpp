@@ -0,0 +1,79 @@
+#include "skywing_core/internal/utility/rate_limiter.hpp"
+
+#include <algorithm>
+
+namespace skywing::internal {
+TokenBucket::TokenBucket(const double rate, const double capacity, const time_point now) noexcept
+  : rate_{std::max(rate, 0.0)}, capacity_{std::max(capacity, 0.0)}, tokens_{capacity_}, last_update_{now}
+{}
+
+double TokenBucket::tokens_at(const time_point now) const noexcept
+{
+  if (now <= last_update_) { return tokens_; }
+  const std::chrono::duration<double> elapsed = now - last_update_;
+  return std::min(capacity_, tokens_ + rate_ * elapsed.count());
+}
+
+bool TokenBucket::available(const time_point now) const noexcept { return rate_ == 0.0 || tokens_at(now) > 0.0; }
+
+void TokenBucket::spend(const double amount, const time_point now) noexcept
+{
+  if (rate_ == 0.0) { return; }
+  tokens_ = tokens_at(now) - amount;
+  last_update_ = std::max(last_update_, now);
+}
+
+TokenBucket::time_point TokenBucket::next_available(const time_point now) const noexcept
+{
+  if (available(now)) { return now; }
+  // Just past the point where the debt is paid off
+  const std::chrono::duration<double> wait{-tokens_at(now) / rate_};
+  return now + std::chrono::ceil<std::chrono::nanoseconds>(wait) + std::chrono::nanoseconds{1};
+}
+
+double TokenBucket::utilization(const time_point now) const noexcept
+{
+  if (rate_ == 0.0 || capacity_ == 0.0) { return 0.0; }
+  return std::clamp(1.0 - tokens_at(now) / capacity_, 0.0, 1.0);
+}
+
+RateLimiter::RateLimiter(const RateLimit& limit, const time_point now) noexcept
+{
+  const std::chrono::duration<double> burst = limit.burst;
+  if (limit.bytes_per_second > 0.0) {
+    bytes_ = TokenBucket{limit.bytes_per_second, limit.bytes_per_second * burst.count(), now};
+  }
+  if (limit.messages_per_second > 0.0) {
+    // At least one message has to fit or nothing is ever sent at full speed
+    messages_ = TokenBucket{limit.messages_per_second, std::max(1.0, limit.messages_per_second * burst.count()), now};
+  }
+}
+
+bool RateLimiter::can_send(const time_point now) const noexcept
+{
+  return bytes_.available(now) && messages_.available(now);
+}
+
+void RateLimiter::record_send(const std::size_t bytes, const time_point now) noexcept
+{
+  bytes_.spend(static_cast<double>(bytes), now);
+  messages_.spend(1.0, now);
+  ++stats_.messages_sent;
+  stats_.bytes_sent += bytes;
+}
+
+void RateLimiter::record_throttled() noexcept { ++stats_.times_throttled; }
+
+RateLimiter::time_point RateLimiter::next_available(const time_point now) const noexcept
+{
+  return std::max(bytes_.next_available(now), messages_.next_available(now));
+}
+
+RateLimitStats RateLimiter::stats(const time_point now) const noexcept
+{
+  auto to_ret = stats_;
+  to_ret.byte_utilization = bytes_.utilization(now);
+  to_ret.message_utilization = messages_.utilization(now);
+  return to_ret;
+}
+} // namespace skywing::internal
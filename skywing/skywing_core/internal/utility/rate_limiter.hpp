@@ -0,0 +1,141 @@
+#ifndef SKYNET_INTERNAL_UTILITY_RATE_LIMITER_HPP
+#define SKYNET_INTERNAL_UTILITY_RATE_LIMITER_HPP
+
+#include <chrono>
+#include <cstddef>
+
+namespace skywing {
+/** \brief Limits on how fast published values are sent
+ *
+ * Only published values are limited; everything else that keeps the network
+ * running is always sent.  A rate of zero is unlimited.
+ */
+struct RateLimit {
+  /// Bytes sent per second
+  double bytes_per_second = 0.0;
+
+  /// Messages sent per second
+  double messages_per_second = 0.0;
+
+  /// How long sending can go at full speed after being idle
+  std::chrono::milliseconds burst{100};
+}; // struct RateLimit
+
+/** \brief Counters for the values sent under a rate limit
+ */
+struct RateLimitStats {
+  /// Number of rate limited messages sent
+  std::size_t messages_sent = 0;
+
+  /// Total size of those messages
+  std::size_t bytes_sent = 0;
+
+  /// Number of times messages were held back for going over the limit
+  std::size_t times_throttled = 0;
+
+  /// How much of the burst allowance for bytes is used up, from 0 for none to 1
+  /// for all of it; always 0 without a limit
+  double byte_utilization = 0.0;
+
+  /// How much of the burst allowance for messages is used up
+  double message_utilization = 0.0;
+}; // struct RateLimitStats
+} // namespace skywing
+
+namespace skywing::internal {
+/** \brief Tokens that build up at a fixed rate to a maximum and are spent by
+ * whatever is being limited
+ *
+ * Anything may be spent while there are tokens left, going into debt if it
+ * costs more than that, so that a single item larger than the maximum can
+ * still get through.  The debt has to be paid off before anything else.
+ */
+class TokenBucket {
+public:
+  using time_point = std::chrono::steady_clock::time_point;
+
+  /** \brief Creates a bucket that never runs out
+   */
+  TokenBucket() noexcept = default;
+
+  /** \brief Creates a full bucket
+   *
+   * \param rate Tokens added per second; zero never runs out
+   * \param capacity The most tokens that can build up
+   * \param now The current time
+   */
+  TokenBucket(double rate, double capacity, time_point now) noexcept;
+
+  /** \brief Returns true if the bucket can run out
+   */
+  bool is_limited() const noexcept { return rate_ > 0.0; }
+
+  /** \brief Returns true if there are tokens to spend
+   */
+  bool available(time_point now) const noexcept;
+
+  /** \brief Spends tokens
+   */
+  void spend(double amount, time_point now) noexcept;
+
+  /** \brief Returns the earliest time at which there are tokens to spend
+   */
+  time_point next_available(time_point now) const noexcept;
+
+  /** \brief Returns the fraction of the capacity that has been spent, from 0 to 1
+   */
+  double utilization(time_point now) const noexcept;
+
+private:
+  double tokens_at(time_point now) const noexcept;
+
+  double rate_ = 0.0;
+  double capacity_ = 0.0;
+  double tokens_ = 0.0;
+  time_point last_update_;
+}; // class TokenBucket
+
+/** \brief Limits both the bytes and the messages sent per second
+ */
+class RateLimiter {
+public:
+  using time_point = std::chrono::steady_clock::time_point;
+
+  /** \brief Creates a limiter that allows everything
+   */
+  RateLimiter() noexcept = default;
+
+  RateLimiter(const RateLimit& limit, time_point now) noexcept;
+
+  /** \brief Returns true if there is any limit
+   */
+  bool is_limited() const noexcept { return bytes_.is_limited() || messages_.is_limited(); }
+
+  /** \brief Returns true if a message can be sent now
+   */
+  bool can_send(time_point now) const noexcept;
+
+  /** \brief Takes the cost of a message that is being sent
+   */
+  void record_send(std::size_t bytes, time_point now) noexcept;
+
+  /** \brief Counts a message being held back
+   */
+  void record_throttled() noexcept;
+
+  /** \brief Returns the earliest time at which a message can be sent
+   */
+  time_point next_available(time_point now) const noexcept;
+
+  /** \brief Returns the counters, with the utilization as of now
+   */
+  RateLimitStats stats(time_point now) const noexcept;
+
+private:
+  TokenBucket bytes_;
+  TokenBucket messages_;
+  RateLimitStats stats_;
+}; // class RateLimiter
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_UTILITY_RATE_LIMITER_HPP
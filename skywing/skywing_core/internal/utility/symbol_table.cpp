@@ -0,0 +1,51 @@
+#include "skywing_core/internal/utility/symbol_table.hpp"
+
+#include <cassert>
+#include <functional>
+
+namespace skywing::internal {
+SymbolTable::Symbol SymbolTable::intern(const std::string_view str) noexcept
+{
+  const auto hash = std::hash<std::string_view>{}(str);
+  if (!slots_.empty()) {
+    const auto slot = slot_for(str, hash);
+    if (slots_[slot] != no_symbol) { return slots_[slot]; }
+  }
+  // The top of the range is left for tables keyed by symbols to mark their slots with
+  assert(names_.size() < no_symbol - 1);
+  if ((names_.size() + 1) * 4 > slots_.size() * 3) { grow(); }
+  const auto symbol = static_cast<Symbol>(names_.size());
+  names_.emplace_back(str);
+  hashes_.push_back(hash);
+  slots_[slot_for(str, hash)] = symbol;
+  return symbol;
+}
+
+SymbolTable::Symbol SymbolTable::find(const std::string_view str) const noexcept
+{
+  if (slots_.empty()) { return no_symbol; }
+  return slots_[slot_for(str, std::hash<std::string_view>{}(str))];
+}
+
+std::size_t SymbolTable::slot_for(const std::string_view str, const std::size_t hash) const noexcept
+{
+  const auto mask = slots_.size() - 1;
+  for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+    const auto symbol = slots_[slot];
+    if (symbol == no_symbol || (hashes_[symbol] == hash && names_[symbol] == str)) { return slot; }
+  }
+}
+
+void SymbolTable::grow() noexcept
+{
+  slots_.assign(slots_.empty() ? 16 : slots_.size() * 2, no_symbol);
+  const auto mask = slots_.size() - 1;
+  for (Symbol symbol = 0; symbol < names_.size(); ++symbol) {
+    auto slot = hashes_[symbol] & mask;
+    while (slots_[slot] != no_symbol) {
+      slot = (slot + 1) & mask;
+    }
+    slots_[slot] = symbol;
+  }
+}
+} // namespace skywing::internal
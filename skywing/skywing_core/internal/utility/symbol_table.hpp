@@ -0,0 +1,58 @@
+#ifndef SKYNET_INTERNAL_UTILITY_SYMBOL_TABLE_HPP
+#define SKYNET_INTERNAL_UTILITY_SYMBOL_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace skywing::internal {
+/** \brief Hands out a small integer for each distinct string
+ *
+ * Lets tables that are looked up on every pass, such as the manager's routing
+ * tables, be keyed by an integer that hashes and compares in one instruction
+ * instead of by a string.  Symbols are dense, starting at zero, and are never
+ * reused or freed, so they stay valid for as long as the table does.
+ */
+class SymbolTable {
+public:
+  using Symbol = std::uint32_t;
+
+  /// Returned by find for strings that haven't been interned
+  static constexpr Symbol no_symbol = std::numeric_limits<Symbol>::max();
+
+  /** \brief Returns the symbol for a string, adding it if it isn't present
+   */
+  Symbol intern(std::string_view str) noexcept;
+
+  /** \brief Returns the symbol for a string, or no_symbol if it isn't present
+   *
+   * Doesn't allocate, so it can be used to look up strings that are only viewed.
+   */
+  Symbol find(std::string_view str) const noexcept;
+
+  /** \brief Returns the string a symbol stands for
+   */
+  const std::string& name(Symbol symbol) const noexcept { return names_[symbol]; }
+
+  /** \brief Returns the number of symbols handed out
+   */
+  std::size_t size() const noexcept { return names_.size(); }
+
+private:
+  // Returns the slot holding the string, or the empty slot it would go in
+  std::size_t slot_for(std::string_view str, std::size_t hash) const noexcept;
+
+  void grow() noexcept;
+
+  std::vector<std::string> names_;
+  // The hash of each name, so that growing doesn't rehash the strings
+  std::vector<std::size_t> hashes_;
+  // Open addressed table of symbols, with no_symbol for empty slots
+  std::vector<Symbol> slots_;
+}; // class SymbolTable
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_UTILITY_SYMBOL_TABLE_HPP
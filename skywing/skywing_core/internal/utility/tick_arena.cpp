@@ -0,0 +1,37 @@
+#include "skywing_core/internal/utility/tick_arena.hpp"
+
+#include <algorithm>
+
+namespace skywing::internal {
+TickArena::TickArena(const std::size_t capacity) noexcept
+  : capacity_{std::clamp(capacity, std::size_t{1}, max_capacity)}, buffer_{new std::byte[capacity_]}
+{
+  make_arena();
+}
+
+void TickArena::reset() noexcept
+{
+  arena_->release();
+  const auto needed = capacity_ + overflow_.bytes();
+  overflow_.clear();
+  if (needed <= capacity_ || capacity_ == max_capacity) { return; }
+  // Grow ahead of what was needed so that slowly rising use doesn't regrow every pass
+  capacity_ = std::min(std::max(needed, 2 * capacity_), max_capacity);
+  arena_.reset();
+  buffer_.reset(new std::byte[capacity_]);
+  make_arena();
+}
+
+void TickArena::make_arena() noexcept { arena_.emplace(buffer_.get(), capacity_, &overflow_); }
+
+void* TickArena::Overflow::do_allocate(const std::size_t bytes, const std::size_t alignment)
+{
+  bytes_ += bytes;
+  return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void TickArena::Overflow::do_deallocate(void* p, const std::size_t bytes, const std::size_t alignment)
+{
+  std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+} // namespace skywing::internal
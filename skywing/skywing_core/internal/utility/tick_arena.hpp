@@ -0,0 +1,76 @@
+#ifndef SKYNET_INTERNAL_UTILITY_TICK_ARENA_HPP
+#define SKYNET_INTERNAL_UTILITY_TICK_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace skywing::internal {
+/** \brief Memory for things that only live until the end of a pass through the
+ * manager's loop
+ *
+ * Allocations are bumped off a buffer that is kept between passes, and freeing
+ * does nothing until the whole arena is reset at the end of the pass.  If a
+ * pass needs more than the buffer holds the rest comes from the heap, and the
+ * buffer is grown on the next reset so that later passes fit.
+ *
+ * Not thread safe; only the thread running the manager's loop may use it.
+ */
+class TickArena {
+public:
+  /// The size of the buffer to start with
+  static constexpr std::size_t default_capacity = 16 * 1024;
+
+  /// The largest the buffer will grow to
+  static constexpr std::size_t max_capacity = 1024 * 1024;
+
+  explicit TickArena(std::size_t capacity = default_capacity) noexcept;
+
+  TickArena(const TickArena&) = delete;
+  TickArena& operator=(const TickArena&) = delete;
+
+  /** \brief Returns the resource to allocate from
+   */
+  std::pmr::memory_resource* resource() noexcept { return &*arena_; }
+
+  /** \brief Frees everything allocated since the last reset
+   *
+   * Nothing allocated from the arena may be used afterwards.
+   */
+  void reset() noexcept;
+
+  /** \brief Returns the size of the buffer
+   */
+  std::size_t capacity() const noexcept { return capacity_; }
+
+  /** \brief Returns the bytes that didn't fit in the buffer since the last reset
+   */
+  std::size_t overflow_bytes() const noexcept { return overflow_.bytes(); }
+
+private:
+  // Hands out the memory that doesn't fit in the buffer, keeping track of how much
+  class Overflow final : public std::pmr::memory_resource {
+  public:
+    std::size_t bytes() const noexcept { return bytes_; }
+    void clear() noexcept { bytes_ = 0; }
+
+  private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::size_t bytes_ = 0;
+  }; // class Overflow
+
+  void make_arena() noexcept;
+
+  std::size_t capacity_;
+  std::unique_ptr<std::byte[]> buffer_;
+  Overflow overflow_;
+  // Rebuilt when the buffer grows, as the resource can't be pointed at a new one
+  std::optional<std::pmr::monotonic_buffer_resource> arena_;
+}; // class TickArena
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_UTILITY_TICK_ARENA_HPP
@@ -0,0 +1,62 @@
+#ifndef SKYNET_INTERNAL_WIRE_FEATURES_HPP
+#define SKYNET_INTERNAL_WIRE_FEATURES_HPP
+
+#include "generated/endian.hpp"
+
+#include <cstdint>
+
+namespace skywing::internal {
+/** \brief Bitmask of optional wire encodings
+ *
+ * Each instance sends the features it understands in its greeting, and only
+ * uses a feature with a neighbor that reported support for it.
+ */
+using WireFeatures = std::uint64_t;
+
+namespace wire_feature {
+/// Numeric vectors can be sent as a raw little-endian array instead of a list
+inline constexpr WireFeatures raw_arrays = WireFeatures{1} << 0;
+
+/// Messages can be exchanged through a shared memory ring when on the same host
+inline constexpr WireFeatures shared_memory = WireFeatures{1} << 1;
+
+/// Large frames can be sent packed with Cap'n Proto's packing scheme
+inline constexpr WireFeatures packed = WireFeatures{1} << 2;
+
+/// Large frames can be sent compressed with LZ4
+inline constexpr WireFeatures lz4 = WireFeatures{1} << 3;
+
+/// Numeric vectors on tags that ask for it can be sent as the elements that changed
+inline constexpr WireFeatures vector_delta = WireFeatures{1} << 4;
+
+/// Floating point vectors on tags that ask for it can be sent with a lossy encoding
+inline constexpr WireFeatures quantized_arrays = WireFeatures{1} << 5;
+
+/// Published values are only sent while the receiver has granted credits for them
+inline constexpr WireFeatures credit_flow = WireFeatures{1} << 6;
+
+/// Published values can name their tag by an index bound to it earlier on the connection
+inline constexpr WireFeatures tag_indices = WireFeatures{1} << 7;
+} // namespace wire_feature
+
+/// The largest index a tag can be bound to; tags past it are always sent by name
+inline constexpr std::uint32_t max_tag_index = 0xFFFF;
+
+/// The compression methods understood by this build
+#ifdef SKYWING_HAVE_LZ4
+inline constexpr WireFeatures supported_compression_features = wire_feature::packed | wire_feature::lz4;
+#else
+inline constexpr WireFeatures supported_compression_features = wire_feature::packed;
+#endif
+
+/// The features that send numbers as little-endian bytes
+inline constexpr WireFeatures little_endian_wire_features
+  = wire_feature::raw_arrays | wire_feature::vector_delta | wire_feature::quantized_arrays;
+
+/// The features understood by this build
+inline constexpr WireFeatures supported_wire_features = (machine_is_little_endian ? little_endian_wire_features : 0)
+                                                      | wire_feature::shared_memory | wire_feature::credit_flow
+                                                      | wire_feature::tag_indices | supported_compression_features;
+} // namespace skywing::internal
+
+#endif // SKYNET_INTERNAL_WIRE_FEATURES_HPP
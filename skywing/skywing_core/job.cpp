@@ -8,12 +8,20 @@
 namespace skywing {
 std::thread Job::Accessor::run(Job& j) noexcept
 {
-  return std::thread{[&j]() {
+  // Counted before the thread starts so that a simulation can't move its clock before the job runs
+  auto* const activity = Manager::JobAccessor::job_activity(*j.manager_);
+  if (activity) { activity->job_started(); }
+  return std::thread{[&j, activity]() {
+    const internal::JobActivity::JobThread attached{activity};
     j.to_run_(j, ManagerHandle{*j.manager_});
-    // Re-use the buffer mutex here
-    std::lock_guard lock{j.bufs_.mutex()};
-    // Signify that the work is done
-    j.to_run_ = nullptr;
+    {
+      // Re-use the buffer mutex here
+      std::lock_guard lock{j.bufs_.mutex()};
+      // Signify that the work is done
+      j.to_run_ = nullptr;
+    }
+    // Released the lock first so the manager can remove the job when it wakes
+    Manager::JobAccessor::notify_job_finished(*j.manager_);
   }};
 }
 
@@ -73,6 +81,39 @@ bool Job::process_data(const TagID& tag_id, gsl::span<const PublishValueVariant>
   return true;
 }
 
+bool Job::process_data(const TagID& tag_id, const internal::PublishData& data) noexcept
+{
+  auto [buffers, lock] = bufs_.get();
+  (void)lock;
+  const auto version = data.version();
+  const auto loc = buffers.find(tag_id);
+  // Not subscribed; don't do anything, but not an error
+  if (loc == buffers.cend()) {
+    SKYNET_TRACE_LOG(
+      "\"{}\", job \"{}\" discarded tag \"{}\", version {}, due to not being subscribed",
+      manager_->id(),
+      id_,
+      tag_id,
+      version);
+    return true;
+  }
+  // If the types are wrong then something went wrong
+  if (!data.types_match(loc->second.expected_types) || !loc->second.buffer->add(data)) {
+    SKYNET_WARN_LOG(
+      "\"{}\", job \"{}\" discarded tag \"{}\", version {}, due to it having the wrong type index",
+      manager_->id(),
+      id_,
+      tag_id,
+      version);
+    loc->second.error_occurred = TagInfo::Error::incorrect_type;
+    data_buffer_modified_cv_.notify_all();
+    return false;
+  }
+  SKYNET_TRACE_LOG("\"{}\", job \"{}\" accepted tag \"{}\", version {}", manager_->id(), id_, tag_id, version);
+  data_buffer_modified_cv_.notify_all();
+  return true;
+}
+
 bool Job::tag_has_subscription(const internal::PublishTagBase& tag) const noexcept
 {
   auto [buffers, lock] = bufs_.get();
@@ -113,7 +154,23 @@ void Job::mark_tag_as_dead(const TagID& tag_id) noexcept
   data_buffer_modified_cv_.notify_all();
 }
 
-void Job::publish_impl(const internal::PublishTagBase& tag, const gsl::span<PublishValueVariant> to_send) noexcept
+bool Job::is_subscribed_to(const TagID& tag_id) noexcept
+{
+  const auto [buffers, lock] = bufs_.get();
+  (void)lock;
+  return buffers.find(tag_id) != buffers.cend();
+}
+
+std::size_t Job::unread_versions(const TagID& tag_id) noexcept
+{
+  auto [buffers, lock] = bufs_.get();
+  (void)lock;
+  const auto tag_loc = buffers.find(tag_id);
+  if (tag_loc == buffers.cend() || !tag_loc->second.buffer) { return 0; }
+  return tag_loc->second.buffer->unread_versions();
+}
+
+VersionID Job::next_publish_version(const internal::PublishTagBase& tag) noexcept
 {
   assert(
     tags_produced_.find(tag.id()) != tags_produced_.cend()
@@ -123,7 +180,23 @@ void Job::publish_impl(const internal::PublishTagBase& tag, const gsl::span<Publ
   // Find / create the last version and obtain a reference to it
   auto& last_version = last_published_version_.try_emplace(tag.id(), internal::tag_no_data).first->second;
   last_version = last_version + 1;
-  Manager::JobAccessor::publish(*manager_, last_version, tag.id(), to_send);
+  return last_version;
+}
+
+std::size_t Job::publish_typed_impl(
+  const internal::PublishTagBase& tag,
+  const internal::PublishValueWriter& to_send,
+  const PublishOptions& options) noexcept
+{
+  return Manager::JobAccessor::publish_typed(*manager_, next_publish_version(tag), tag.id(), to_send, options);
+}
+
+std::size_t Job::publish_view_impl(
+  const internal::PublishTagBase& tag,
+  const gsl::span<const internal::PublishValueView> to_send,
+  const PublishOptions& options) noexcept
+{
+  return Manager::JobAccessor::publish_view(*manager_, next_publish_version(tag), tag.id(), to_send, options);
 }
 
 // Private implementation of public functions
@@ -2,8 +2,10 @@
 #define SKYNET_JOB_HPP
 
 #include "skywing_core/internal/manager_waiter_callables.hpp"
+#include "skywing_core/internal/publish_value_view.hpp"
 #include "skywing_core/internal/reduce_group.hpp"
 #include "skywing_core/internal/tag_buffer.hpp"
+#include "skywing_core/internal/typed_publish_serializer.hpp"
 #include "skywing_core/internal/utility/mutex_guarded.hpp"
 #include "skywing_core/internal/utility/type_list.hpp"
 #include "skywing_core/types.hpp"
@@ -11,6 +13,7 @@
 
 #include "gsl/span"
 
+#include <array>
 #include <cassert>
 #include <chrono>
 #include <cstdint>
@@ -27,6 +30,35 @@ namespace skywing {
 class Manager;
 class ManagerHandle;
 
+/** \brief Options for sending the values of a tag as the changes from the
+ * previous value
+ *
+ * Numeric vectors are sent to each subscribed neighbor as the elements that
+ * changed since the last value sent to it on the tag, when that is smaller than
+ * the whole vector.  Other values, and values for neighbors that don't support
+ * it, are sent whole.  A neighbor that connects again starts with a whole value.
+ */
+struct DeltaEncoding {
+  /// Send the whole value to a neighbor after this many values were sent to it as changes
+  std::uint32_t full_value_interval = 16;
+}; // struct DeltaEncoding
+
+/** \brief How the values of a tag are sent to neighbors
+ */
+struct PublishOptions {
+  /// Send the values as the changes from the previous value, if set
+  std::optional<DeltaEncoding> delta;
+
+  /** \brief The lossy encoding to send floating point vectors with
+   *
+   * Only vectors of float or double are affected; they are expanded back to
+   * their declared type on receipt.  Neighbors that don't support it, and values
+   * the encoding can't represent, are sent exactly.  Local subscribers always
+   * receive the exact values.
+   */
+  Quantization quantization = Quantization::none;
+}; // struct PublishOptions
+
 /** \brief Tag for pub/sub values
  */
 template<typename... Ts>
@@ -38,6 +70,24 @@ public:
     assert(!id.empty());
   }
 
+  /** \brief Creates a tag whose values are sent to neighbors as described by the options
+   */
+  PublishTag(const TagID& id, const PublishOptions& options) noexcept : PublishTag{id} { options_ = options; }
+
+  /** \brief Creates a tag whose values are sent as the changes from the previous value
+   */
+  PublishTag(const TagID& id, const DeltaEncoding delta) noexcept : PublishTag{id, PublishOptions{delta}} {}
+
+  /** \brief Creates a tag whose floating point vectors are sent with a lossy encoding
+   */
+  PublishTag(const TagID& id, const Quantization quantization) noexcept
+    : PublishTag{id, PublishOptions{std::nullopt, quantization}}
+  {}
+
+  /** \brief Returns how values are sent to neighbors
+   */
+  const PublishOptions& options() const noexcept { return options_; }
+
   using ValueType = ValueOrTuple<Ts...>;
   using BufferType = internal::DiscardOldVersionTagBuffer<Ts...>;
 
@@ -47,8 +97,41 @@ protected:
   PublishTag(OverridePrefix, const TagID& id)
     : internal::PublishTagBase{OverridePrefix{}, id, internal::expected_type_for<Ts...>}
   {}
+
+private:
+  PublishOptions options_;
 }; // class PublishTag
 
+/** \brief Storage lent by a job to fill in a vector to publish on a tag
+ *
+ * Obtained from Job::loan() and handed back with Job::commit(), which encodes
+ * the elements for neighbors straight from it.  The storage is kept for the
+ * next loan on the same tag, so publishing repeatedly doesn't allocate.
+ */
+template<typename T>
+class PublishLoan {
+public:
+  /** \brief Returns the elements to fill in
+   */
+  gsl::span<T> span() noexcept { return gsl::span<T>{values_}; }
+
+  T* data() noexcept { return values_.data(); }
+  std::size_t size() const noexcept { return values_.size(); }
+  T& operator[](const std::size_t i) noexcept { return values_[i]; }
+  T* begin() noexcept { return values_.data(); }
+  T* end() noexcept { return values_.data() + values_.size(); }
+
+private:
+  friend class Job;
+
+  PublishLoan(const PublishTag<std::vector<T>>& tag, std::vector<T> values) noexcept
+    : tag_{&tag}, values_{std::move(values)}
+  {}
+
+  const PublishTag<std::vector<T>>* tag_;
+  std::vector<T> values_;
+}; // class PublishLoan
+
 /** \brief Tag for reduce values
  */
 template<typename... Ts>
@@ -120,12 +203,21 @@ public:
       return j.process_data(tag, data, version);
     }
 
+    static bool process_data(Job& j, const TagID& tag, const internal::PublishData& data) noexcept
+    {
+      return j.process_data(tag, data);
+    }
+
     static std::thread run(Job& j) noexcept;
 
     static std::mutex& get_mutex(Job& j) noexcept { return j.bufs_.mutex(); }
 
     static void report_dead_tag(Job& j, const TagID& tag) noexcept { j.mark_tag_as_dead(tag); }
 
+    static std::size_t unread_versions(Job& j, const TagID& tag) noexcept { return j.unread_versions(tag); }
+
+    static bool is_subscribed_to(Job& j, const TagID& tag) noexcept { return j.is_subscribed_to(tag); }
+
     // Work around to disallow construction of Jobs outside of the manager
     // A public constructor is needed due to it being emplaced into a map
     struct AllowConstruction {
@@ -300,13 +392,86 @@ public:
    */
   template<typename... PublishTagTypes, typename... ArgTypes>
   void publish(const PublishTag<PublishTagTypes...>& tag, ArgTypes&&... values) noexcept
+  {
+    publish_with_backpressure(tag, std::forward<ArgTypes>(values)...);
+  }
+
+  /** \brief Publish data on the passed tag, reporting if subscribers can't keep up
+   *
+   * A neighbor is behind when it hasn't granted credits for more values, the
+   * rate limits are holding values back, or its connection isn't taking any
+   * more data.  Values that are held back are replaced by newer ones on the
+   * same tag, so publishing faster than that only drops values.
+   *
+   * \return The number of subscribed neighbors that are behind
+   */
+  template<typename... PublishTagTypes, typename... ArgTypes>
+  std::size_t publish_with_backpressure(const PublishTag<PublishTagTypes...>& tag, ArgTypes&&... values) noexcept
   {
     static_assert(
       sizeof...(PublishTagTypes) == sizeof...(ArgTypes) && (... && std::is_convertible_v<ArgTypes, PublishTagTypes>),
       "Argument values can not be converted to tag types!");
-    std::array<PublishValueVariant, sizeof...(ArgTypes)> variants{
-      static_cast<PublishTagTypes>(std::forward<ArgTypes>(values))...};
-    publish_impl(tag, gsl::span<PublishValueVariant>{variants});
+    // Values that have to be converted to the tag's types live until the publish returns
+    return publish_typed_impl(
+      tag, internal::TypedPublishSerializer<PublishTagTypes...>(std::forward<ArgTypes>(values)...), tag.options());
+  }
+
+  /** \brief Publish data on the passed tag without copying numeric vectors
+   *
+   * Vectors of numbers can be given as anything that a span of their elements
+   * can be made from, such as a gsl::span or a std::vector, and are encoded for
+   * neighbors straight from that memory.  They are only copied if a job on this
+   * instance is subscribed to the tag or the tag sends changes or uses a lossy
+   * encoding.  Other values are converted to the tag's types as with publish().
+   *
+   * \return The number of subscribed neighbors that are behind, as with
+   * publish_with_backpressure()
+   */
+  template<typename... PublishTagTypes, typename... ArgTypes>
+  std::size_t publish_view(const PublishTag<PublishTagTypes...>& tag, const ArgTypes&... values) noexcept
+  {
+    static_assert(sizeof...(PublishTagTypes) == sizeof...(ArgTypes), "Wrong number of values for the tag!");
+    const std::array<internal::PublishValueView, sizeof...(ArgTypes)> views{
+      internal::make_publish_value_view<PublishTagTypes>(values)...};
+    return publish_view_impl(tag, gsl::span<const internal::PublishValueView>{views}, tag.options());
+  }
+
+  /** \brief Lends storage for a vector to publish on a tag
+   *
+   * The elements start out as the last value committed on the tag, as far as
+   * the sizes overlap, and as zero otherwise.
+   *
+   * \param size The number of elements to publish
+   */
+  template<typename T>
+  PublishLoan<T> loan(const PublishTag<std::vector<T>>& tag, const std::size_t size) noexcept
+  {
+    static_assert(internal::is_publish_span_element<T>, "Only vectors of numbers can be loaned!");
+    std::vector<T> values;
+    const auto spare = loan_spares_.find(tag.id());
+    if (spare != loan_spares_.end()) {
+      if (auto* kept = std::get_if<std::vector<T>>(&spare->second)) { values = std::move(*kept); }
+    }
+    values.resize(size);
+    return PublishLoan<T>{tag, std::move(values)};
+  }
+
+  /** \brief Publishes the elements of a loan on the tag it was made for
+   *
+   * The loan is left empty, and its storage is kept for the next loan on the tag.
+   *
+   * \return The number of subscribed neighbors that are behind, as with
+   * publish_with_backpressure()
+   */
+  template<typename T>
+  std::size_t commit(PublishLoan<T>& loan) noexcept
+  {
+    const std::array<internal::PublishValueView, 1> views{gsl::span<const T>{loan.values_}};
+    const auto behind
+      = publish_view_impl(*loan.tag_, gsl::span<const internal::PublishValueView>{views}, loan.tag_->options());
+    loan_spares_[loan.tag_->id()] = std::move(loan.values_);
+    loan.values_.clear();
+    return behind;
   }
 
   template<typename... PublishTagTypes, typename... TupleTypes>
@@ -434,13 +599,45 @@ private:
    */
   bool process_data(const TagID& tag_id, gsl::span<const PublishValueVariant> data, VersionID version) noexcept;
 
+  /** \brief Processes a publish message received from another instance
+   *
+   * Same as the above, but the type check is done against the message itself
+   * and the values are decoded directly into the tag's buffer.
+   *
+   * \param tag_id The id of the tag, already read from the message
+   * \param data The received message
+   * \return True if processing went fine, false if there was an error
+   */
+  bool process_data(const TagID& tag_id, const internal::PublishData& data) noexcept;
+
   /** \brief Marks a tag as dead due to connection issues
    *
    * \param tag The id of the tag to mark as dead
    */
   void mark_tag_as_dead(const TagID& tag_id) noexcept;
 
-  void publish_impl(const internal::PublishTagBase& tag, gsl::span<PublishValueVariant> to_send) noexcept;
+  /** \brief Returns how many versions the job has yet to read on a tag, or 0
+   * if it isn't subscribed to it
+   */
+  std::size_t unread_versions(const TagID& tag_id) noexcept;
+
+  /** \brief Returns true if the job has subscribed to the tag
+   */
+  bool is_subscribed_to(const TagID& tag_id) noexcept;
+
+  // Returns the number of subscribed neighbors that are behind
+  std::size_t publish_typed_impl(
+    const internal::PublishTagBase& tag,
+    const internal::PublishValueWriter& to_send,
+    const PublishOptions& options) noexcept;
+
+  std::size_t publish_view_impl(
+    const internal::PublishTagBase& tag,
+    gsl::span<const internal::PublishValueView> to_send,
+    const PublishOptions& options) noexcept;
+
+  // Returns the version to publish the next value on a tag with
+  VersionID next_publish_version(const internal::PublishTagBase& tag) noexcept;
 
   void init_or_update_subscribe(
     gsl::span<const internal::PublishTagBase> tags,
@@ -495,6 +692,9 @@ private:
   // The last version published on each tag
   std::unordered_map<std::string, VersionID> last_published_version_;
 
+  // Storage from committed loans, kept for the next loan on each tag
+  std::unordered_map<std::string, PublishValueVariant> loan_spares_;
+
   // The manager that this job is working with
   Manager* manager_;
 
@@ -5,6 +5,7 @@
 
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <limits>
 
 namespace skywing {
@@ -14,53 +15,444 @@ std::vector<std::uint8_t> make_need_one_pub(const std::vector<TagID>& tags) noex
 {
   return std::vector<std::uint8_t>(tags.size(), 1);
 }
+
+// Local sockets report the loopback address, so they can only stand in for connections to it;
+// using one for any other address would change what address the neighbor is known by
+bool is_loopback(const std::string& address) noexcept { return address.compare(0, 4, "127.") == 0; }
+
+// There's nothing to wait on for a full shared memory ring to have space, so poll it
+constexpr std::chrono::milliseconds shared_memory_retry_interval{1};
 } // namespace
 
 namespace internal {
 ExternalManager::ExternalManager(
-  SocketCommunicator conn,
+  std::unique_ptr<Communicator> conn,
+  ReceiveBuffer received,
   const MachineID& id,
   const std::vector<MachineID>& neighbors,
   Manager& manager,
-  const std::uint16_t port) noexcept
+  const std::uint16_t port,
+  const WireFeatures features) noexcept
   : id_{id}
-  , last_heard_{std::chrono::steady_clock::now()}
+  , last_heard_{Manager::ExternalManagerAccessor::clock(manager).now()}
   , neighbors_{neighbors}
   , manager_{&manager}
   , port_{port}
+  , features_{features & supported_wire_features}
 {
-  conns_.push_back(std::move(conn));
+  conns_.push_back(Link{std::move(conn), std::move(received)});
+  rate_limiter_ = RateLimiter{Manager::ExternalManagerAccessor::transport_options(manager).neighbor_rate_limit, now()};
 }
 
 void ExternalManager::get_and_handle_messages() noexcept
 {
   //  std::cout << "Agent " << manager_->id() << " handling neighbor messages from " << id() << " with dead status" << dead_ << std::endl;
-  if (dead_) { return; }
-  for (auto& socket_comm : conns_)
+  for (auto& link : conns_)
   {
-    //    std::cout << "Agent " << manager_->id() << " about to try to get a message from " << id() << std::endl;
-    while (auto handler = try_to_get_message(socket_comm)) {
+    if (dead_) { return; }
+    handle_messages_from(*link.conn, link.received);
+  }
+  // Read the ring after the sockets so that everything sent before the switch is handled first
+  if (shm_rx_active_ && !dead_) { handle_messages_from(*shm_rx_, shm_received_); }
+  //  std::cout << "Agent " << manager_->id() << " done handling messages from the live " << id() << std::endl;
+}
+
+template<typename Connection>
+void ExternalManager::handle_messages_from(Connection& conn, ReceiveBuffer& received) noexcept
+{
+  // Frames may already be buffered from when the connection was pending, so
+  // handle those before reading anything new
+  bool keep_reading = true;
+  while (true) {
+    while (const auto frame = received.next_frame()) {
       // Update the last time something was heard
-      last_heard_ = std::chrono::steady_clock::now();
-      // Handle the message
-      //      std::cout << "Agent " << manager_->id() << " got a message from " << id() << ", about to handle it. " << std::endl;
-      handle_message(*handler);
-      //      std::cout << "Agent " << manager_->id() << " finished handling message from " << id() << std::endl;
+      last_heard_ = now();
+      const auto message = decode_frame(*frame, received.last_frame_flags());
+      if (!message) {
+        SKYNET_TRACE_LOG("\"{}\" setting {} to dead due to a frame that couldn't be decompressed", manager_->id(), id_);
+        dead_ = true;
+        return;
+      }
+      // Only lives while the message is handled, so it can come from the arena
+      const auto arena = Manager::ExternalManagerAccessor::tick_arena(*manager_);
+      if (auto handler = MessageHandler::try_to_view(*message, arena)) { handle_message(*handler); }
+      else {
+        SKYNET_TRACE_LOG("\"{}\" setting {} to dead due to bad message", manager_->id(), id_);
+        dead_ = true;
+      }
+      if (dead_) { return; }
     }
+    if (!keep_reading) { return; }
+    const auto err = received.fill(conn);
+    if (err == ConnectionError::would_block) {
+      // The connection is fine and there's just nothing currently on the wire
+      return;
+    }
+    if (err == ConnectionError::closed) {
+      SKYNET_TRACE_LOG("\"{}\" setting {} to dead because connection has closed", manager_->id(), id_);
+      dead_ = true;
+      return;
+    }
+    if (err != ConnectionError::no_error) {
+      SKYNET_TRACE_LOG("\"{}\" setting {} to dead because connection has some unknwon error, perhaps received an RST packer", manager_->id(), id_);
+      dead_ = true;
+      return;
+    }
+    // A short read means the socket has been drained; parse what arrived and stop
+    keep_reading = received.may_have_more();
   }
-  //  std::cout << "Agent " << manager_->id() << " done handling messages from the live " << id() << std::endl;
 }
 
-void ExternalManager::send_message(const std::vector<std::byte>& c) noexcept
+void ExternalManager::send_message(std::vector<std::byte> c) noexcept
+{
+  if (dead_) { return; }
+  send_message(std::make_shared<const std::vector<std::byte>>(std::move(c)));
+}
+
+void ExternalManager::send_message(SharedFrame frame) noexcept
+{
+  if (dead_) { return; }
+  send_prepared_frame(prepare_frame(std::move(frame)));
+}
+
+SharedFrame ExternalManager::prepare_frame(SharedFrame frame) noexcept
+{
+  const auto& options = Manager::ExternalManagerAccessor::transport_options(*manager_);
+  const auto features = frame_features();
+  if (
+    !options.use_compression || frame->size() < options.compression_threshold
+    || (features & compression_wire_features) == 0 || frame_flags(*frame) != 0) {
+    return frame;
+  }
+  // Timed with the real clock as it is CPU time that is being measured
+  const auto start = std::chrono::steady_clock::now();
+  auto compressed = compress_frame(*frame, features);
+  compression_stats_.compression_time += std::chrono::steady_clock::now() - start;
+  ++compression_stats_.frames_attempted;
+  compression_stats_.bytes_before += frame->size();
+  if (!compressed) {
+    compression_stats_.bytes_after += frame->size();
+    return frame;
+  }
+  ++compression_stats_.frames_compressed;
+  compression_stats_.bytes_after += compressed->size();
+  return std::make_shared<const std::vector<std::byte>>(std::move(*compressed));
+}
+
+void ExternalManager::send_prepared_frame(SharedFrame frame, const bool rate_limited) noexcept
 {
   if (dead_) { return; }
+  auto& queue = shm_tx_active_ ? shm_queue_ : send_queue_;
+  queue.push(std::move(frame), now(), rate_limited);
+  flush_if_batch_full(queue);
+}
+
+void ExternalManager::send_prepared_publish(
+  const TagID& tag_id, const std::uint32_t tag_index, SharedFrame frame) noexcept
+{
+  if (dead_) { return; }
+  bind_tag(tag_id, tag_index);
+  if (!Manager::ExternalManagerAccessor::transport_options(*manager_).replace_unsent_publishes) {
+    send_prepared_frame(std::move(frame), true);
+    return;
+  }
+  auto& queue = shm_tx_active_ ? shm_queue_ : send_queue_;
+  // Replacing a value doesn't make the queue any longer
+  if (queue.push_replacing(tag_id, std::move(frame), now())) { return; }
+  flush_if_batch_full(queue);
+}
+
+void ExternalManager::flush_if_batch_full(const SendQueue& queue) noexcept
+{
+  // Otherwise it's left for the manager to write along with anything else queued
+  const auto ready = queue.size() - queue.held_frames();
+  if (ready >= Manager::ExternalManagerAccessor::transport_options(*manager_).max_batch_messages) {
+    flush_send_queue();
+  }
+}
+
+bool ExternalManager::rate_limits_allow(const std::chrono::steady_clock::time_point now) const noexcept
+{
+  return rate_limiter_.can_send(now) && Manager::ExternalManagerAccessor::total_rate_limiter(*manager_).can_send(now);
+}
+
+void ExternalManager::bind_tag(const TagID& tag_id, const std::uint32_t tag_index) noexcept
+{
+  if (tag_index == 0 || !(features_ & wire_feature::tag_indices)) { return; }
+  if (tag_index < sent_tag_bindings_.size() && sent_tag_bindings_[tag_index]) { return; }
+  if (tag_index >= sent_tag_bindings_.size()) { sent_tag_bindings_.resize(tag_index + 1); }
+  sent_tag_bindings_[tag_index] = true;
+  // Isn't rate limited, so it can't be held back behind the value that needs it
+  send_message(make_bind_tag(tag_id, tag_index));
+}
+
+const TagID* ExternalManager::received_tag_binding(const std::uint32_t tag_index) const noexcept
+{
+  if (tag_index >= received_tag_bindings_.size() || received_tag_bindings_[tag_index].empty()) { return nullptr; }
+  return &received_tag_bindings_[tag_index];
+}
+
+bool ExternalManager::has_send_credit() const noexcept
+{
+  return !(features_ & wire_feature::credit_flow) || send_credits_ > 0;
+}
+
+bool ExternalManager::take_send_credit() noexcept
+{
+  if (!(features_ & wire_feature::credit_flow)) { return true; }
+  if (send_credits_ == 0) {
+    ++times_out_of_credits_;
+    return false;
+  }
+  --send_credits_;
+  return true;
+}
+
+void ExternalManager::flush_send_queue() noexcept
+{
+  if (dead_) { return; }
+  // Done first as it may queue a wake-up for the neighbor on the socket
+  if (shm_tx_active_) {
+    flush_shared_memory_queue();
+    if (dead_) { return; }
+  }
+  // Published values are only held back by the limits or credits when there are any
+  auto& total_limiter = Manager::ExternalManagerAccessor::total_rate_limiter(*manager_);
+  AdmitFrame admit;
+  if (rate_limiter_.is_limited() || total_limiter.is_limited() || (features_ & wire_feature::credit_flow)) {
+    admit = [this, &total_limiter, time = now()](const std::size_t bytes) {
+      if (!rate_limits_allow(time)) {
+        // Counted against whichever limit was hit
+        (rate_limiter_.can_send(time) ? total_limiter : rate_limiter_).record_throttled();
+        return false;
+      }
+      if (!take_send_credit()) { return false; }
+      rate_limiter_.record_send(bytes, time);
+      total_limiter.record_send(bytes, time);
+      return true;
+    };
+  }
   // TODO: Maybe don't just use the first socket communicator if there are multiple
-  // TODO: Pretty sure this will incorrectly set to dead upon ConnectionError::would_block
-  if (conns_[0].send_message(c.data(), c.size()) != ConnectionError::no_error) { dead_ = true; }
+  const auto err = send_queue_.flush(*conns_[0].conn, Manager::ExternalManagerAccessor::reactor(*manager_), admit);
+  if (err != ConnectionError::no_error && err != ConnectionError::would_block) {
+    SKYNET_TRACE_LOG("\"{}\" setting {} to dead due to error upon message send", manager_->id(), id_);
+    dead_ = true;
+    return;
+  }
+  switch_to_shared_memory_if_ready();
+}
+
+void ExternalManager::switch_to_shared_memory_if_ready() noexcept
+{
+  // Frames that aren't rate limited skip past held publishes, so switching
+  // while any are held would let newer values through the ring arrive first;
+  // a delta could then reach the neighbor before the value it is based on.
+  // Publishes queued since the last flush may be held by the next one, so they
+  // count as well
+  if (!shm_switch_pending_ || send_queue_.unadmitted_frames() != 0) { return; }
+  shm_switch_pending_ = false;
+  // Everything queued before this goes over the socket, and everything after through the ring
+  send_message(make_shm_switch());
+  shm_tx_active_ = true;
 }
 
+std::optional<gsl::span<const std::byte>> ExternalManager::decode_frame(
+  const gsl::span<const std::byte> payload, const std::uint8_t flags) noexcept
+{
+  if (flags == 0) { return payload; }
+  const auto start = std::chrono::steady_clock::now();
+  const bool decompressed = decompress_payload(payload, flags, decompressed_);
+  compression_stats_.decompression_time += std::chrono::steady_clock::now() - start;
+  if (!decompressed) {
+    SKYNET_WARN_LOG("\"{}\" received a malformed compressed frame from {}", manager_->id(), id_);
+    return {};
+  }
+  ++compression_stats_.frames_decompressed;
+  return gsl::span<const std::byte>{
+    reinterpret_cast<const std::byte*>(decompressed_.data()),
+    static_cast<gsl::index>(decompressed_.size() * sizeof(std::uint64_t))};
+}
+
+void ExternalManager::flush_shared_memory_queue() noexcept
+{
+  if (shm_queue_.empty()) { return; }
+  // Shared memory isn't rate limited, but the neighbor still has to keep up
+  AdmitFrame admit;
+  if (features_ & wire_feature::credit_flow) {
+    admit = [this](std::size_t) { return take_send_credit(); };
+  }
+  const auto err = shm_queue_.flush(*shm_tx_, admit);
+  if (err != ConnectionError::no_error && err != ConnectionError::would_block) {
+    SKYNET_TRACE_LOG("\"{}\" setting {} to dead due to error writing to shared memory", manager_->id(), id_);
+    dead_ = true;
+    return;
+  }
+  // The neighbor may be blocked on its sockets, in which case a heartbeat wakes it up
+  if (shm_tx_->take_wakeup_request()) {
+    static const SharedFrame wakeup = std::make_shared<const std::vector<std::byte>>(make_heartbeat());
+    send_queue_.push(wakeup, now());
+  }
+}
+
+void ExternalManager::flush_send_queue_if_due(
+  const std::chrono::steady_clock::time_point now, const TransportOptions& options) noexcept
+{
+  const auto is_due = [&](const SendQueue& queue, const bool rate_limited) {
+    if (queue.empty()) { return false; }
+    if (queue.is_blocked()) { return true; }
+    const auto ready = queue.size() - queue.held_frames();
+    // Everything is waiting for credits or the rate limits
+    if (ready == 0) { return has_send_credit() && (!rate_limited || rate_limits_allow(now)); }
+    return ready >= options.max_batch_messages || queue.oldest_queued_time() + options.batch_delay <= now;
+  };
+  if (is_due(send_queue_, true) || is_due(shm_queue_, false)) { flush_send_queue(); }
+}
+
+std::chrono::steady_clock::time_point ExternalManager::next_flush_time(const TransportOptions& options) const noexcept
+{
+  auto to_ret = std::chrono::steady_clock::time_point::max();
+  if (dead_) { return to_ret; }
+  // Blocked sockets are written once they are writable rather than on a timer
+  if (!send_queue_.empty() && !send_queue_.is_blocked()) {
+    if (send_queue_.size() > send_queue_.held_frames()) {
+      to_ret = send_queue_.oldest_queued_time() + options.batch_delay;
+    }
+    else if (has_send_credit()) {
+      // Everything is waiting for the rate limits
+      const auto time = now();
+      to_ret = std::max(
+        rate_limiter_.next_available(time),
+        Manager::ExternalManagerAccessor::total_rate_limiter(*manager_).next_available(time));
+    }
+  }
+  // Values waiting for credits are sent once the neighbor grants some, which
+  // arrive as a message
+  if (!shm_queue_.empty() && (shm_queue_.size() > shm_queue_.held_frames() || has_send_credit())) {
+    to_ret = std::min(
+      to_ret,
+      shm_queue_.is_blocked() ? now() + shared_memory_retry_interval
+                              : shm_queue_.oldest_queued_time() + options.batch_delay);
+  }
+  return to_ret;
+}
+
+std::size_t ExternalManager::send_queue_size() const noexcept { return send_queue_.size() + shm_queue_.size(); }
+
+std::size_t ExternalManager::send_queue_bytes() const noexcept { return send_queue_.bytes() + shm_queue_.bytes(); }
+
 MachineID ExternalManager::id() const noexcept { return id_; }
 
+WireFeatures ExternalManager::wire_features() const noexcept { return features_; }
+
+void ExternalManager::send_publish_delta(
+  const VersionID version,
+  const TagID& tag_id,
+  std::shared_ptr<const std::vector<PublishValueVariant>> value,
+  const DeltaEncoding& delta,
+  const Quantization quantization,
+  const std::uint32_t tag_index) noexcept
+{
+  auto& last = sent_values_[tag_id];
+  const bool send_full = !last.value || last.deltas_since_full >= delta.full_value_interval;
+  gsl::span<const PublishValueVariant> previous;
+  if (!send_full) { previous = *last.value; }
+  if (!dead_) {
+    bind_tag(tag_id, tag_index);
+    send_prepared_frame(
+      prepare_frame(std::make_shared<const std::vector<std::byte>>(
+        make_publish_delta(version, tag_id, *value, previous, features_, quantization, tag_index))),
+      true);
+    ++(send_full ? publishes_sent_whole_ : publishes_sent_as_changes_);
+  }
+  last.value = std::move(value);
+  last.deltas_since_full = send_full ? 0 : last.deltas_since_full + 1;
+}
+
+std::vector<PublishValueVariant>& ExternalManager::received_value(const TagID& tag_id) noexcept
+{
+  return received_values_[tag_id];
+}
+
+WireFeatures ExternalManager::frame_features() const noexcept
+{
+  // Copying into shared memory is cheaper than compressing
+  return shm_tx_active_ ? features_ & ~compression_wire_features : features_;
+}
+
+const CompressionStats& ExternalManager::compression_stats() const noexcept { return compression_stats_; }
+
+std::size_t ExternalManager::replaced_publishes() const noexcept
+{
+  return send_queue_.replaced_frames() + shm_queue_.replaced_frames();
+}
+
+RateLimitStats ExternalManager::rate_limit_stats() const noexcept { return rate_limiter_.stats(now()); }
+
+void ExternalManager::grant_credits() noexcept
+{
+  if (dead_ || !(features_ & wire_feature::credit_flow)) { return; }
+  std::size_t unread = 0;
+  for (const auto& tag : tags_received_) {
+    unread += Manager::ExternalManagerAccessor::unread_versions(*manager_, tag);
+  }
+  // There's always room for one more so that the jobs see the latest value
+  // however far behind they are
+  const std::uint64_t window = Manager::ExternalManagerAccessor::transport_options(*manager_).credit_window;
+  const std::uint64_t target = unread < window ? window - unread : 1;
+  // Topping up once half is used saves a message for every value received
+  if (granted_credits_ * 2 > target) { return; }
+  const auto credits = target - granted_credits_;
+  granted_credits_ = target;
+  SKYNET_TRACE_LOG("\"{}\" granting {} credits to \"{}\"", manager_->id(), credits, id_);
+  send_message(make_grant_credits(static_cast<std::uint32_t>(credits)));
+}
+
+std::size_t ExternalManager::send_credits() const noexcept { return send_credits_; }
+
+std::size_t ExternalManager::times_out_of_credits() const noexcept { return times_out_of_credits_; }
+
+std::size_t ExternalManager::publishes_sent_as_changes() const noexcept { return publishes_sent_as_changes_; }
+
+std::size_t ExternalManager::publishes_sent_whole() const noexcept { return publishes_sent_whole_; }
+
+bool ExternalManager::is_backpressured() const noexcept
+{
+  // What the last flush held back is out of date once more is published, so
+  // go by what is queued now: each value still to be let through takes a
+  // credit, and those for the socket have to get past the rate limits too
+  const std::uint64_t waiting = send_queue_.unadmitted_frames() + shm_queue_.unadmitted_frames();
+  const bool out_of_credits = (features_ & wire_feature::credit_flow) && waiting >= send_credits_;
+  const bool rate_limited = send_queue_.unadmitted_frames() != 0 && !rate_limits_allow(now());
+  return out_of_credits || rate_limited || send_queue_.is_blocked() || shm_queue_.is_blocked();
+}
+
+bool ExternalManager::is_on_same_host() const noexcept
+{
+  const auto& conn = *conns_[0].conn;
+  return conn.is_local() || conn.ip_address_and_port().first == conn.host_ip_address_and_port().first;
+}
+
+void ExternalManager::offer_shared_memory() noexcept
+{
+  const auto& options = Manager::ExternalManagerAccessor::transport_options(*manager_);
+  if (dead_ || shm_tx_ || !options.use_shared_memory || !(features_ & wire_feature::shared_memory)) { return; }
+  // Everything in the process already shares memory
+  if (!is_on_same_host() || conns_[0].conn->is_in_process()) { return; }
+  // Failing to create it just means staying on the socket
+  shm_tx_ = SharedMemoryRing::create(options.shared_memory_ring_bytes);
+  if (!shm_tx_) { return; }
+  SKYNET_TRACE_LOG("\"{}\" offering shared memory ring \"{}\" to \"{}\"", manager_->id(), shm_tx_->name(), id_);
+  send_message(make_shm_attach(shm_tx_->name(), shm_tx_->capacity()));
+}
+
+bool ExternalManager::is_using_shared_memory() const noexcept { return shm_tx_active_; }
+
+bool ExternalManager::prepare_to_sleep() noexcept
+{
+  if (!shm_rx_active_ || dead_) { return true; }
+  return shm_rx_->prepare_to_sleep();
+}
+
 bool ExternalManager::is_dead() const noexcept { return dead_; }
 
 void ExternalManager::mark_as_dead() noexcept { dead_ = true; }
@@ -74,7 +466,7 @@ bool ExternalManager::is_subscribed_to(const TagID& tag) const noexcept
 
 bool ExternalManager::should_ask_for_tags() const noexcept
 {
-  return !pending_tag_request_ && std::chrono::steady_clock::now() > request_tags_time_;
+  return !pending_tag_request_ && now() > request_tags_time_;
 }
 
 bool ExternalManager::has_pending_tag_request() const noexcept { return pending_tag_request_; }
@@ -100,15 +492,26 @@ bool ExternalManager::has_neighbor(const MachineID& id) const noexcept
 void ExternalManager::send_heartbeat_if_past_interval(std::chrono::milliseconds interval) noexcept
 {
   using namespace std::chrono;
-  const auto time_expired = steady_clock::now() - last_heard_;
+  const auto time_expired = now() - last_heard_;
   if (time_expired >= interval) {
     // Try to send a message
     send_message(make_heartbeat());
     // This count as hearing from the device
-    last_heard_ = steady_clock::now();
+    last_heard_ = now();
   }
 }
 
+std::chrono::steady_clock::time_point
+  ExternalManager::next_heartbeat_time(const std::chrono::milliseconds interval) const noexcept
+{
+  return last_heard_ + interval;
+}
+
+std::chrono::steady_clock::time_point ExternalManager::next_tag_request_time() const noexcept
+{
+  return request_tags_time_;
+}
+
 void ExternalManager::find_publishers_for_tags(
   const std::vector<TagID>& tags, const std::vector<std::uint8_t>& publishers_needed) noexcept
 {
@@ -125,16 +528,32 @@ void ExternalManager::find_publishers_for_tags(
   }
 }
 
+void ExternalManager::find_publishers_for_tags(
+  const gsl::span<const std::string_view> tags, const gsl::span<const std::uint8_t> publishers_needed) noexcept
+{
+  SKYNET_TRACE_LOG(
+    "\"{}\" asking \"{}\" for tags {}{}",
+    manager_->id(),
+    id_,
+    tags,
+    pending_tag_request_ ? ", but ignored due to already pending request" : "");
+  if (!pending_tag_request_) {
+    send_message(make_get_publishers(tags, publishers_needed, ignore_cache_on_next_request_));
+    ignore_cache_on_next_request_ = false;
+    pending_tag_request_ = true;
+  }
+}
+
 std::string ExternalManager::address() const noexcept
 {
-  const auto [ip_address, dummy] = conns_[0].ip_address_and_port();
+  const auto [ip_address, dummy] = conns_[0].conn->ip_address_and_port();
   (void)dummy;
   return ip_address + ':' + std::to_string(port_);
 }
 
 AddrPortPair ExternalManager::address_pair() const noexcept
 {
-  const auto [ip_address, dummy] = conns_[0].ip_address_and_port();
+  const auto [ip_address, dummy] = conns_[0].conn->ip_address_and_port();
   (void)dummy;
   return {ip_address, port_};
 }
@@ -159,48 +578,6 @@ AddrPortPair ExternalManager::address_pair() const noexcept
 //   return true;
 // }
 
-std::optional<MessageHandler> ExternalManager::try_to_get_message(SocketCommunicator& socket_comm) noexcept
-{
-  //std::cout << "Agent " << manager_->id() << " trying to get messages from " << id() << std::endl;
-  const auto bytes_to_read_or_error = read_network_size(socket_comm);
-  //std::cout << "Agent " << manager_->id() << " got bytes to read from " << id() << std::endl;
-  if (std::holds_alternative<NetworkSizeType>(bytes_to_read_or_error)) {
-    //std::cout << "Agent " << manager_->id() << " about to read message size from " << id() << std::endl;
-    const auto bytes_to_read = *std::get_if<NetworkSizeType>(&bytes_to_read_or_error);
-    //std::cout << "Agent " << manager_->id() << " successfully read message size from " << id() << std::endl;
-    // Then read the actual message and parse it
-    if (const auto message_buffer = read_chunked(socket_comm, bytes_to_read); !message_buffer.empty()) {
-      //std::cout << "Agent " << manager_->id() << " read the actual message from " << id() << std::endl;
-      return MessageHandler::try_to_create(message_buffer);
-    }
-    else {
-      // Couldn't read the size bytes - bad message
-      SKYNET_TRACE_LOG("\"{}\" setting {} to dead due to bad message", manager_->id(), id_);
-      dead_ = true;
-      return {};
-    }
-  }
-  else {
-    const auto err = *std::get_if<ConnectionError>(&bytes_to_read_or_error);
-    if (err == ConnectionError::closed)
-    {
-      SKYNET_TRACE_LOG("\"{}\" setting {} to dead because connection has closed", manager_->id(), id_);
-      dead_ = true;
-    }
-    else if (err != ConnectionError::would_block)
-    {
-      SKYNET_TRACE_LOG("\"{}\" setting {} to dead because connection has some unknwon error, perhaps received an RST packer", manager_->id(), id_);
-      dead_ = true;
-    }
-    // we get here if attempting to read_network_size returned
-    // ConnectionError::would_block, which indicates there's the
-    // connection is fine and there's just nothing currently on the
-    // wire
-    //std::cout << "Agent " << manager_->id() << " didn't receive anything from " << id() << std::endl;
-    return {};
-  }
-}
-
 // Handle status messages
 void ExternalManager::handle_message(MessageHandler& handle) noexcept
 {
@@ -313,8 +690,36 @@ void ExternalManager::handle_message(MessageHandler& handle) noexcept
       return Manager::ExternalManagerAccessor::handle_report_reduce_disconnection(*manager_, msg, *this);
     },
     [&](const PublishData& msg) {
-      if (!tag_name_okay(msg.tag_id())) { return false; }
-      return Manager::ExternalManagerAccessor::handle_publish_data(*manager_, msg, *this);
+      const TagID* tag_id = nullptr;
+      if (const auto tag_index = msg.tag_index(); tag_index != 0) {
+        // The name was checked when it was bound
+        tag_id = received_tag_binding(tag_index);
+        if (tag_id == nullptr) {
+          SKYNET_WARN_LOG(
+            "\"{}\" dropping connection with \"{}\" due to unbound tag index {}", manager_->id(), id_, tag_index);
+          return false;
+        }
+      }
+      else {
+        // Read into a reused string, so only the tag being named in full costs anything
+        tag_id = &Manager::ExternalManagerAccessor::lookup_key(*manager_, msg.tag_id_view());
+        if (!tag_name_okay(*tag_id)) { return false; }
+      }
+      if (features_ & wire_feature::credit_flow) {
+        // Each value takes one of the credits the neighbor was granted
+        if (granted_credits_ > 0) { --granted_credits_; }
+        tags_received_.insert(*tag_id);
+      }
+      return Manager::ExternalManagerAccessor::handle_publish_data(*manager_, msg, *tag_id, *this);
+    },
+    [&](const BindTag& msg) {
+      const auto tag_index = msg.index();
+      auto tag_id = msg.tag_id();
+      SKYNET_TRACE_LOG("\"{}\" bound tag \"{}\" from \"{}\" to index {}", manager_->id(), tag_id, id_, tag_index);
+      if (!tag_name_okay(tag_id) || tag_index == 0 || tag_index > max_tag_index) { return false; }
+      if (tag_index >= received_tag_bindings_.size()) { received_tag_bindings_.resize(tag_index + 1); }
+      received_tag_bindings_[tag_index] = std::move(tag_id);
+      return true;
     },
     [&](const SubscriptionNotice& msg) {
       SKYNET_TRACE_LOG(
@@ -349,6 +754,48 @@ void ExternalManager::handle_message(MessageHandler& handle) noexcept
       SKYNET_TRACE_LOG("\"{}\" accepted subscription notice from \"{}\"", manager_->id(), id_);
       return true;
     },
+    [&](const ShmAttach& msg) {
+      SKYNET_TRACE_LOG(
+        "\"{}\" received shared memory ring \"{}\" from \"{}\"", manager_->id(), msg.name(), id_);
+      // Refusing leaves the neighbor sending over the socket
+      bool success = false;
+      if (Manager::ExternalManagerAccessor::transport_options(*manager_).use_shared_memory && !shm_rx_) {
+        shm_rx_ = SharedMemoryRing::open(msg.name(), msg.capacity());
+        success = shm_rx_.has_value();
+      }
+      send_message(make_shm_attach_reply(msg.name(), success));
+      return true;
+    },
+    [&](const ShmAttachReply& msg) {
+      if (!shm_tx_ || shm_tx_active_ || shm_switch_pending_ || msg.name() != shm_tx_->name()) { return false; }
+      SKYNET_TRACE_LOG(
+        "\"{}\" had shared memory ring {} by \"{}\"",
+        manager_->id(),
+        msg.success() ? "accepted" : "refused",
+        id_);
+      if (!msg.success()) {
+        shm_tx_.reset();
+        return true;
+      }
+      // Both sides have it mapped, so the name isn't needed anymore
+      shm_tx_->unlink();
+      shm_switch_pending_ = true;
+      switch_to_shared_memory_if_ready();
+      return true;
+    },
+    [&](const ShmSwitch&) {
+      if (!shm_rx_ || shm_rx_active_) { return false; }
+      shm_rx_active_ = true;
+      return true;
+    },
+    [&](const GrantCredits& msg) {
+      if (!(features_ & wire_feature::credit_flow)) { return false; }
+      SKYNET_TRACE_LOG("\"{}\" was granted {} credits by \"{}\"", manager_->id(), msg.credits(), id_);
+      send_credits_ += msg.credits();
+      // Send anything that was waiting on them
+      if (send_queue_.unadmitted_frames() != 0 || shm_queue_.unadmitted_frames() != 0) { flush_send_queue(); }
+      return true;
+    },
     [](...) {
       // Anything else is a programming bug, this shouldn't be reached
       assert(false && "Missing message type in ExternalManager::handle_message");
@@ -369,7 +816,12 @@ std::chrono::steady_clock::time_point ExternalManager::calc_next_request_time()
     20ms, 40ms, 80ms, 160ms, 320ms, 500ms, 750ms, 1000ms, 2000ms, 5000ms};
   const auto add_time
     = backoff_counter_ >= backoff_times.size() ? backoff_times.back() : backoff_times[backoff_counter_];
-  return std::chrono::steady_clock::now() + add_time;
+  return now() + add_time;
+}
+
+std::chrono::steady_clock::time_point ExternalManager::now() const noexcept
+{
+  return Manager::ExternalManagerAccessor::clock(*manager_).now();
 }
 } // namespace internal
 
@@ -378,10 +830,55 @@ std::chrono::steady_clock::time_point ExternalManager::calc_next_request_time()
 ////////////////////////////////////////////////
 
 Manager::Manager(
-  const std::uint16_t port, const MachineID& id, const std::chrono::milliseconds heartbeat_interval) noexcept
-  : id_{id}, heartbeat_interval_{heartbeat_interval}, port_{port}
+  const std::uint16_t port,
+  const MachineID& id,
+  const std::chrono::milliseconds heartbeat_interval,
+  const ManagerTransport transport) noexcept
+  : owned_reactor_{std::make_unique<internal::Reactor>()}
+  , reactor_{*owned_reactor_}
+  , clock_{internal::Clock::steady()}
+  , transport_{transport}
+  , id_{id}
+  , heartbeat_interval_{heartbeat_interval}
+  , port_{port}
+{
+  if (transport_ == ManagerTransport::in_process) {
+    if (in_process_listener_.listen(port, reactor_) != internal::ConnectionError::no_error) { std::exit(1); }
+    return;
+  }
+  server_socket_.emplace();
+  if (server_socket_->set_to_listen(port) != internal::ConnectionError::no_error) { std::exit(1); }
+  reactor_.watch(server_socket_->native_handle(), false);
+  // Neighbors on the same host can also connect without going through TCP
+  auto local_name = internal::local_socket_name(port);
+  local_server_socket_.emplace(internal::SocketFamily::local);
+  if (local_server_socket_->set_to_listen_local(local_name) == internal::ConnectionError::no_error) {
+    local_socket_name_ = std::move(local_name);
+    reactor_.watch(local_server_socket_->native_handle(), false);
+  }
+  else {
+    SKYNET_WARN_LOG("\"{}\" couldn't listen on a local socket, so neighbors on this host will use TCP", id_);
+    local_server_socket_.reset();
+  }
+}
+
+Manager::Manager(
+  const std::uint16_t port,
+  const MachineID& id,
+  const std::chrono::milliseconds heartbeat_interval,
+  internal::Reactor& reactor,
+  internal::SimulatedLinks& links,
+  internal::JobActivity& job_activity) noexcept
+  : reactor_{reactor}
+  , clock_{links.clock()}
+  , links_{&links}
+  , job_activity_{&job_activity}
+  , transport_{ManagerTransport::in_process}
+  , id_{id}
+  , heartbeat_interval_{heartbeat_interval}
+  , port_{port}
 {
-  if (server_socket_.set_to_listen(port) != internal::ConnectionError::no_error) { std::exit(1); }
+  if (in_process_listener_.listen(port, reactor_, links_) != internal::ConnectionError::no_error) { std::exit(1); }
 }
 
 // Manager::Manager(const BuildManagerInfo& info) noexcept
@@ -417,31 +914,65 @@ Manager::Manager(
 //   }
 // }
 
-Manager::~Manager() { send_to_neighbors(internal::make_goodbye()); }
+Manager::~Manager()
+{
+  send_to_neighbors(internal::make_goodbye());
+  // Nothing will be around to write these later
+  for (auto&& neighbor : neighbors_) {
+    neighbor.second.flush_send_queue();
+  }
+}
 
 Waiter<bool> Manager::connect_to_server(const char* const address, const std::uint16_t port) noexcept
 {
   std::lock_guard<std::mutex> lock{job_mut_};
-  const auto canonical = internal::to_canonical(AddrPortPair{address, port});
+  const AddrPortPair requested{address, port};
+  const auto resolution = resolver_.resolve(requested.first);
+  // Replaced by how this request goes
+  address_resolutions_.erase(requested);
+  switch (resolution.status) {
+  case internal::Resolution::Status::resolved:
+    record_resolution(requested, resolution, {});
+    start_user_connection(AddrPortPair{resolution.address, port});
+    break;
+
+  case internal::Resolution::Status::pending:
+    // The connection is started once the address is known
+    pending_resolutions_.push_back(PendingResolution{requested, ConnType::user_requested, {}, clock_.now()});
+    break;
+
+  case internal::Resolution::Status::failed:
+    SKYNET_WARN_LOG("\"{}\" couldn't connect to {} as it couldn't be resolved", id_, requested);
+    record_resolution(requested, resolution, {});
+    break;
+  }
+  reactor_.wake();
+  // Waiters use the requested address as the resolved one may not be known yet
+  return make_waiter<bool>(
+    job_mut_,
+    connection_cv_,
+    internal::ManagerConnectionIsComplete{*this, requested.first, requested.second},
+    internal::ManagerGetConnectionSuccess{*this, requested.first, requested.second});
+}
+
+void Manager::start_user_connection(const AddrPortPair& canonical) noexcept
+{
   // Only actually try the connection if it doesn't already exist
   if (addr_to_machine_.find(canonical) == addr_to_machine_.cend()) {
     const auto [iter, inserted] = pending_conns_.try_emplace(
       canonical,
-      PendingInfo{internal::SocketCommunicator{}, ConnStatus::waiting_for_conn, ConnType::user_requested, ""});
+      PendingInfo{nullptr, ConnStatus::waiting_for_conn, ConnType::user_requested, "", {}});
     if (inserted) {
-      const auto status = iter->second.conn.connect_non_blocking(canonical.first.c_str(), canonical.second);
+      const auto status = start_connection(iter->second.conn, canonical.first, canonical.second);
       // Ignore status - if this initially fails it will be handled later
       (void)status;
+      // Completion of the connection is signaled by the socket becoming writable
+      reactor_.watch(iter->second.conn->native_handle(), true);
       SKYNET_TRACE_LOG("\"{}\" making connection from {} to {}",
-                       id_, iter->second.conn.host_ip_address_and_port(),
-                       iter->second.conn.ip_address_and_port());
+                       id_, iter->second.conn->host_ip_address_and_port(),
+                       iter->second.conn->ip_address_and_port());
     }
   }
-  return make_waiter<bool>(
-    job_mut_,
-    connection_cv_,
-    internal::ManagerConnectionIsComplete{*this, canonical.first, canonical.second},
-    internal::ManagerGetConnectionSuccess{*this, canonical.first, canonical.second});
 }
 
 Waiter<bool> Manager::connect_to_server(std::string_view address) noexcept
@@ -452,27 +983,69 @@ Waiter<bool> Manager::connect_to_server(std::string_view address) noexcept
 
 void Manager::accept_pending_connections() noexcept
 {
-  while (auto conn = server_socket_.accept()) {
-    // This feels gross since it's basically the same thing as above, but I'm not
-    // sure how to condense them as they are slightly different
-    const auto& [address, port] = conn->ip_address_and_port();
-    auto info = PendingInfo{std::move(*conn), ConnStatus::waiting_for_conn, ConnType::user_requested, ""};
-    SKYNET_DEBUG_LOG("\"{}\" accepted connection from {}:{}", id_, address, port);
-    // Accept seems to re-use ports, and the actual address doesn't matter, so keep shuffling
-    // until it manages to get in
-    auto inc_port = port;
-    while (true) {
-      const auto [iter, inserted] = pending_conns_.try_emplace(AddrPortPair{address, inc_port}, std::move(info));
-      (void)iter;
-      ++inc_port;
-      if (inserted) {
-        SKYNET_DEBUG_LOG("\"{}\" inserted accepted connection from {} into pending_conns_",
-                         id_, iter->second.conn.ip_address_and_port());
-        break;
-      }
+  for (auto* const listener : {&server_socket_, &local_server_socket_}) {
+    if (!*listener) { continue; }
+    while (auto conn = (*listener)->accept()) {
+      add_accepted_connection(std::make_unique<internal::SocketCommunicator>(std::move(*conn)));
+    }
+  }
+  while (auto conn = in_process_listener_.accept()) {
+    add_accepted_connection(std::move(conn));
+  }
+}
+
+void Manager::add_accepted_connection(std::unique_ptr<internal::Communicator> conn) noexcept
+{
+  // This feels gross since it's basically the same thing as above, but I'm not
+  // sure how to condense them as they are slightly different
+  const auto [address, port] = conn->ip_address_and_port();
+  // Watch for writability so the greeting is sent on the next pass
+  reactor_.watch(conn->native_handle(), true);
+  auto info = PendingInfo{std::move(conn), ConnStatus::waiting_for_conn, ConnType::user_requested, "", {}};
+  SKYNET_DEBUG_LOG("\"{}\" accepted connection from {}:{}", id_, address, port);
+  // Accept seems to re-use ports, and the actual address doesn't matter, so keep shuffling
+  // until it manages to get in
+  auto inc_port = port;
+  while (true) {
+    const auto [iter, inserted] = pending_conns_.try_emplace(AddrPortPair{address, inc_port}, std::move(info));
+    (void)iter;
+    ++inc_port;
+    if (inserted) {
+      SKYNET_DEBUG_LOG("\"{}\" inserted accepted connection from {} into pending_conns_",
+                       id_, iter->second.conn->ip_address_and_port());
+      break;
+    }
+  }
+  // No need for waiters or anything
+}
+
+internal::ConnectionError Manager::start_connection(
+  std::unique_ptr<internal::Communicator>& conn, const std::string& address, const std::uint16_t port) noexcept
+{
+  if (transport_ == ManagerTransport::in_process) {
+    // Only instances in this process can be reached, which all use the loopback address
+    conn = internal::InProcessCommunicator::connect(is_loopback(address) ? port : 0, reactor_, port_);
+    return conn->connection_progress_status();
+  }
+  if (transport_options_.use_local_sockets && is_loopback(address)) {
+    // Neighbors that were seen before advertised their name; anything else may be an
+    // instance listening on the usual name for its port
+    const auto known = local_socket_names_.find(AddrPortPair{address, port});
+    const auto name = known != local_socket_names_.cend() ? known->second : internal::local_socket_name(port);
+    auto local_conn = std::make_unique<internal::SocketCommunicator>(internal::SocketFamily::local);
+    const auto err = local_conn->connect_local_non_blocking(name);
+    if (err == internal::ConnectionError::no_error || err == internal::ConnectionError::connection_in_progress) {
+      SKYNET_TRACE_LOG("\"{}\" connecting to {}:{} through a local socket", id_, address, port);
+      conn = std::move(local_conn);
+      return err;
     }
-    // No need for waiters or anything
+    // Nothing is listening there anymore, so fall back to TCP
+    if (known != local_socket_names_.cend()) { local_socket_names_.erase(known); }
   }
+  auto socket = std::make_unique<internal::SocketCommunicator>();
+  const auto err = socket->connect_non_blocking(address.c_str(), port);
+  conn = std::move(socket);
+  return err;
 }
 
 size_t Manager::number_of_neighbors() const noexcept
@@ -481,6 +1054,41 @@ size_t Manager::number_of_neighbors() const noexcept
   return neighbors_.size();
 }
 
+std::vector<NeighborStats> Manager::neighbor_stats() const noexcept
+{
+  std::lock_guard<std::mutex> lock{job_mut_};
+  std::vector<NeighborStats> to_ret;
+  to_ret.reserve(neighbors_.size());
+  for (const auto& [name, neighbor] : neighbors_) {
+    auto& stats = to_ret.emplace_back();
+    stats.id = name;
+    stats.queued_messages = neighbor.send_queue_size();
+    stats.queued_bytes = neighbor.send_queue_bytes();
+    stats.replaced_publishes = neighbor.replaced_publishes();
+    stats.compression = neighbor.compression_stats();
+    stats.rate_limit = neighbor.rate_limit_stats();
+    stats.send_credits = neighbor.send_credits();
+    stats.times_out_of_credits = neighbor.times_out_of_credits();
+    stats.publishes_sent_as_changes = neighbor.publishes_sent_as_changes();
+    stats.publishes_sent_whole = neighbor.publishes_sent_whole();
+  }
+  return to_ret;
+}
+
+std::optional<AddressResolution> Manager::address_resolution(const AddrPortPair& address) const noexcept
+{
+  std::lock_guard<std::mutex> lock{job_mut_};
+  const auto iter = address_resolutions_.find(address);
+  if (iter == address_resolutions_.cend()) { return std::nullopt; }
+  return iter->second;
+}
+
+RateLimitStats Manager::total_rate_limit_stats() const noexcept
+{
+  std::lock_guard<std::mutex> lock{job_mut_};
+  return total_rate_limiter_.stats(clock_.now());
+}
+
 bool Manager::submit_job(JobID name, std::function<void(Job&, ManagerHandle)> to_run) noexcept
 {
   const auto res = jobs_.try_emplace(name, Job::Accessor::AllowConstruction{}, name, *this, std::move(to_run));
@@ -489,62 +1097,12 @@ bool Manager::submit_job(JobID name, std::function<void(Job&, ManagerHandle)> to
 
 void Manager::run() noexcept
 {
-  using namespace std::chrono_literals;
-  std::vector<std::thread> threads;
-  threads.reserve(jobs_.size());
-  for (auto& [name, job] : jobs_) {
-    (void)name;
-    threads.push_back(Job::Accessor::run(job));
-  }
+  auto threads = start_jobs();
   // Do processing while there are still jobs
   while (!jobs_.empty()) {
-    const auto end_sleep_time = std::chrono::steady_clock::now() + 100us;
-    {
-      // Ensure there's no data race with jobs
-      //std::cout << "Agent " << id() << " at top of loop." << std::endl;
-      std::lock_guard lock{job_mut_};
-      //std::cout << "Agent " << id() << " acquired mutex." << std::endl;
-      // Remove any finished jobs
-      for (auto iter = jobs_.begin(); iter != jobs_.end();) {
-        std::unique_lock lock{Job::Accessor::get_mutex(iter->second), std::try_to_lock};
-        if (lock.owns_lock() && iter->second.is_finished()) {
-          // Need to unlock before deallocation
-          lock.unlock();
-          iter = jobs_.erase(iter);
-        }
-        else {
-          ++iter;
-        }
-      }
-      //std::cout << "Agent " << id() << " about to process pending conns. " << std::endl;
-      process_pending_conns();
-      //std::cout << "Agent " << id() << " about to accept pending connections. " << std::endl;
-      accept_pending_connections();
-      //std::cout << "Agent " << id() << " about to handle neighbor messages. " << std::endl;
-      handle_neighbor_messages();
-      //std::cout << "Agent " << id() << " about to remove dead neighbors " << std::endl;
-      remove_dead_neighbors();
-      //std::cout << "Agent " << id() << " about to find publishers for pending tags. " << std::endl;
-      find_publishers_for_pending_tags();
-      //std::cout << "Agent " << id() << " about to send heartbeats. " << std::endl;
-      for (auto&& neighbor : neighbors_) {
-        neighbor.second.send_heartbeat_if_past_interval(heartbeat_interval_);
-      }
-      //std::cout << "Agent " << id() << " about to announce notifications. " << std::endl;
-      using cv_ref_pair = std::pair<bool&, std::condition_variable&>;
-      std::array<cv_ref_pair, 3> cv_array{
-        cv_ref_pair{notify_subscriptions_, subscription_cv_},
-        cv_ref_pair{notify_reduce_group_, reduce_group_cv_},
-        cv_ref_pair{notify_connection_, connection_cv_}};
-      for (auto& [notify, cv] : cv_array) {
-        if (notify) {
-          cv.notify_all();
-          notify = false;
-        }
-      }
-    }
-    // Wait a bit for other messages
-    std::this_thread::sleep_until(end_sleep_time);
+    const auto wait_time = process_events();
+    // Sleep until there's network activity, a job needs something, or a timer expires
+    reactor_.wait(wait_time);
   }
   //std::cout << "Agent " << id() << " has no running jobs, waiting for threads to complete." << std::endl;
   // Join all of the threads now
@@ -554,12 +1112,82 @@ void Manager::run() noexcept
   //std::cout << "Agent " << id() << " is shutting down." << std::endl;
 }
 
+std::vector<std::thread> Manager::start_jobs() noexcept
+{
+  std::vector<std::thread> threads;
+  threads.reserve(jobs_.size());
+  for (auto& [name, job] : jobs_) {
+    (void)name;
+    threads.push_back(Job::Accessor::run(job));
+  }
+  return threads;
+}
+
+std::chrono::milliseconds Manager::process_events() noexcept
+{
+  using namespace std::chrono_literals;
+  // Ensure there's no data race with jobs
+  //std::cout << "Agent " << id() << " at top of loop." << std::endl;
+  std::lock_guard lock{job_mut_};
+  //std::cout << "Agent " << id() << " acquired mutex." << std::endl;
+  // Remove any finished jobs
+  for (auto iter = jobs_.begin(); iter != jobs_.end();) {
+    std::unique_lock lock{Job::Accessor::get_mutex(iter->second), std::try_to_lock};
+    if (lock.owns_lock() && iter->second.is_finished()) {
+      // Need to unlock before deallocation
+      lock.unlock();
+      iter = jobs_.erase(iter);
+    }
+    else {
+      ++iter;
+    }
+  }
+  resolve_pending_addresses();
+  //std::cout << "Agent " << id() << " about to process pending conns. " << std::endl;
+  process_pending_conns();
+  //std::cout << "Agent " << id() << " about to accept pending connections. " << std::endl;
+  accept_pending_connections();
+  //std::cout << "Agent " << id() << " about to handle neighbor messages. " << std::endl;
+  handle_neighbor_messages();
+  //std::cout << "Agent " << id() << " about to remove dead neighbors " << std::endl;
+  remove_dead_neighbors();
+  //std::cout << "Agent " << id() << " about to find publishers for pending tags. " << std::endl;
+  find_publishers_for_pending_tags();
+  // Includes anything queued by reduce groups while handling the messages above
+  send_queued_reduce_messages();
+  //std::cout << "Agent " << id() << " about to send heartbeats. " << std::endl;
+  for (auto&& neighbor : neighbors_) {
+    neighbor.second.send_heartbeat_if_past_interval(heartbeat_interval_);
+  }
+  flush_neighbor_send_queues();
+  //std::cout << "Agent " << id() << " about to announce notifications. " << std::endl;
+  using cv_ref_pair = std::pair<bool&, std::condition_variable&>;
+  std::array<cv_ref_pair, 3> cv_array{
+    cv_ref_pair{notify_subscriptions_, subscription_cv_},
+    cv_ref_pair{notify_reduce_group_, reduce_group_cv_},
+    cv_ref_pair{notify_connection_, connection_cv_}};
+  for (auto& [notify, cv] : cv_array) {
+    if (notify) {
+      cv.notify_all();
+      notify = false;
+    }
+  }
+  // Nothing allocated during the pass outlives it
+  tick_arena_.reset();
+  auto wait_time = time_until_next_timer();
+  // Neighbors writing through shared memory only wake this up if asked to
+  for (auto&& neighbor : neighbors_) {
+    if (!neighbor.second.prepare_to_sleep()) { wait_time = 0ms; }
+  }
+  return wait_time;
+}
+
 const std::string& Manager::id() const noexcept { return id_; }
 
 size_t Manager::number_of_subscribers(const internal::PublishTagBase& tag) const noexcept
 {
   std::lock_guard<std::mutex> lock{job_mut_};
-  const auto self_iter = self_sub_count_.find(tag.id());
+  const auto self_iter = self_sub_count_.find(tag_symbols_.find(tag.id()));
   const auto self_subs = self_iter == self_sub_count_.cend() ? 0 : self_iter->second;
   return std::accumulate(
     neighbors_.cbegin(), neighbors_.cend(), self_subs, [&](const size_t sum, const auto& neighbor_pair) noexcept {
@@ -574,19 +1202,141 @@ void Manager::handle_neighbor_messages() noexcept
   //std::cout << "Agent " << id() << " handling neighbor messages." << std::endl;
   for (auto&& neighbor : neighbors_) {
     neighbor.second.get_and_handle_messages();
+    neighbor.second.grant_credits();
+  }
+}
+
+void Manager::flush_neighbor_send_queues() noexcept
+{
+  const auto now = clock_.now();
+  for (auto&& neighbor : neighbors_) {
+    neighbor.second.flush_send_queue_if_due(now, transport_options_);
   }
 }
 
-void Manager::publish(const VersionID version, const TagID& tag_id, gsl::span<PublishValueVariant> value) noexcept
+void Manager::set_transport_options(const TransportOptions& options) noexcept
+{
+  std::lock_guard lock{job_mut_};
+  transport_options_ = options;
+  // A batch size of zero would never write anything
+  transport_options_.max_batch_messages = std::max(transport_options_.max_batch_messages, std::size_t{1});
+  // Neighbors can't send anything without credits, and the grants only carry 32 bits
+  transport_options_.credit_window = std::clamp(
+    transport_options_.credit_window, std::size_t{1}, std::size_t{std::numeric_limits<std::uint32_t>::max()});
+  total_rate_limiter_ = internal::RateLimiter{transport_options_.total_rate_limit, clock_.now()};
+}
+
+const TransportOptions& Manager::transport_options() const noexcept { return transport_options_; }
+
+std::size_t Manager::publish(
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<PublishValueVariant> value,
+  const PublishOptions& options) noexcept
 {
-  const auto msg = internal::make_publish(version, tag_id, value);
-  (void)msg;
   SKYNET_TRACE_LOG("\"{}\" publishing on tag \"{}\", version \"{}\", data {}", id_, tag_id, version, value);
   for (auto& [name, job] : jobs_) {
     (void)name;
     Job::Accessor::process_data(job, tag_id, value, version);
   }
-  send_to_neighbors_if(msg, [&](const auto& neighbor) { return neighbor.is_subscribed_to(tag_id); });
+  const auto sends_delta = [&](const internal::ExternalManager& neighbor) {
+    return options.delta && (neighbor.wire_features() & internal::wire_feature::vector_delta);
+  };
+  auto& tmpl = publish_template(tag_id);
+  send_encoded_to_neighbors_if(
+    [&](const internal::WireFeatures features) {
+      return internal::make_publish(tmpl, version, tag_id, value, features, options.quantization);
+    },
+    [&](const auto& neighbor) { return neighbor.is_subscribed_to(tag_id) && !sends_delta(neighbor); },
+    &tag_id,
+    tmpl.tag_index());
+  // Every neighbor keeps the same copy to send the next value against
+  std::shared_ptr<const std::vector<PublishValueVariant>> kept;
+  for (auto& [name, neighbor] : neighbors_) {
+    (void)name;
+    if (!neighbor.is_subscribed_to(tag_id) || !sends_delta(neighbor)) { continue; }
+    if (!kept) { kept = std::make_shared<const std::vector<PublishValueVariant>>(value.begin(), value.end()); }
+    neighbor.send_publish_delta(version, tag_id, kept, *options.delta, options.quantization, tmpl.tag_index());
+  }
+  return neighbors_behind_on(tag_id);
+}
+
+std::size_t Manager::publish_view(
+  const VersionID version,
+  const TagID& tag_id,
+  gsl::span<const internal::PublishValueView> value,
+  const PublishOptions& options) noexcept
+{
+  if (has_local_subscriber(tag_id) || options.delta || options.quantization != Quantization::none) {
+    std::vector<PublishValueVariant> copied;
+    copied.reserve(static_cast<std::size_t>(value.size()));
+    std::transform(value.begin(), value.end(), std::back_inserter(copied), internal::to_publish_value);
+    return publish(version, tag_id, copied, options);
+  }
+  SKYNET_TRACE_LOG("\"{}\" publishing on tag \"{}\", version \"{}\" from a view", id_, tag_id, version);
+  auto& tmpl = publish_template(tag_id);
+  send_encoded_to_neighbors_if(
+    [&](const internal::WireFeatures features) {
+      return internal::make_publish(tmpl, version, tag_id, value, features);
+    },
+    [&](const auto& neighbor) { return neighbor.is_subscribed_to(tag_id); },
+    &tag_id,
+    tmpl.tag_index());
+  return neighbors_behind_on(tag_id);
+}
+
+std::size_t Manager::publish_typed(
+  const VersionID version,
+  const TagID& tag_id,
+  const internal::PublishValueWriter& value,
+  const PublishOptions& options) noexcept
+{
+  // Jobs here take the value as variants, and deltas are sent against a kept copy
+  if (has_local_subscriber(tag_id) || options.delta) {
+    auto copied = value.to_variants();
+    return publish(version, tag_id, copied, options);
+  }
+  SKYNET_TRACE_LOG("\"{}\" publishing on tag \"{}\", version \"{}\"", id_, tag_id, version);
+  auto& tmpl = publish_template(tag_id);
+  send_encoded_to_neighbors_if(
+    [&](const internal::WireFeatures features) {
+      return internal::make_publish(tmpl, version, tag_id, value, features, options.quantization);
+    },
+    [&](const auto& neighbor) { return neighbor.is_subscribed_to(tag_id); },
+    &tag_id,
+    tmpl.tag_index());
+  return neighbors_behind_on(tag_id);
+}
+
+internal::PublishTemplate& Manager::publish_template(const TagID& tag_id) noexcept
+{
+  // Tags past the largest index are always sent by name
+  const auto next_index = publish_templates_.size() + 1;
+  const auto tag_index = next_index <= internal::max_tag_index ? static_cast<std::uint32_t>(next_index) : 0;
+  return publish_templates_.try_emplace(tag_id, tag_index).first->second;
+}
+
+bool Manager::has_local_subscriber(const TagID& tag_id) noexcept
+{
+  return std::any_of(
+    jobs_.begin(), jobs_.end(), [&](auto& job) { return Job::Accessor::is_subscribed_to(job.second, tag_id); });
+}
+
+std::size_t Manager::neighbors_behind_on(const TagID& tag_id) const noexcept
+{
+  return static_cast<std::size_t>(std::count_if(neighbors_.cbegin(), neighbors_.cend(), [&](const auto& neighbor) {
+    return neighbor.second.is_subscribed_to(tag_id) && neighbor.second.is_backpressured();
+  }));
+}
+
+std::size_t Manager::unread_versions(const TagID& tag_id) noexcept
+{
+  std::size_t to_ret = 0;
+  for (auto& [name, job] : jobs_) {
+    (void)name;
+    to_ret += Job::Accessor::unread_versions(job, tag_id);
+  }
+  return to_ret;
 }
 
 bool Manager::add_data_to_queue(const internal::PublishData& msg) noexcept
@@ -649,9 +1399,9 @@ void Manager::remove_dead_neighbors() noexcept
       erase_addr(tag_to_machine_, [&](const auto& tag_pair) {
         new_tags = true;
         for (auto& job_pair : jobs_) {
-          Job::Accessor::report_dead_tag(job_pair.second, tag_pair.first);
+          Job::Accessor::report_dead_tag(job_pair.second, tag_symbols_.name(tag_pair.first));
         }
-        pending_tags_.emplace_back(tag_pair.first);
+        pending_tags_.emplace_back(tag_symbols_.name(tag_pair.first));
         });
       it = neighbors_.erase(it);
     }
@@ -681,8 +1431,9 @@ void Manager::send_to_neighbors(const std::vector<std::byte>& to_send) noexcept
 bool Manager::subscribe_is_done(const std::vector<TagID>& required_tags) const noexcept
 {
   for (const auto& tag : required_tags) {
-    if (self_sub_count_.find(tag) != self_sub_count_.cend()) { continue; }
-    const auto iter = tag_to_machine_.find(tag);
+    const auto symbol = tag_symbols_.find(tag);
+    if (self_sub_count_.find(symbol) != self_sub_count_.cend()) { continue; }
+    const auto iter = tag_to_machine_.find(symbol);
     if (iter == tag_to_machine_.cend()) { return false; }
   }
   SKYNET_DEBUG_LOG("\"{}\" subscription for tags {} finished.", id_, required_tags);
@@ -693,7 +1444,7 @@ Waiter<void> Manager::subscribe(const std::vector<TagID>& tag_ids) noexcept
 {
   SKYNET_DEBUG_LOG("\"{}\" initializing subscription for tags {}", id_, tag_ids);
   std::copy_if(tag_ids.cbegin(), tag_ids.cend(), std::back_inserter(pending_tags_), [&](const TagID& to_find) {
-    if (tag_to_machine_.find(to_find) != tag_to_machine_.cend()) { return false; }
+    if (tag_to_machine_.find(tag_symbols_.find(to_find)) != tag_to_machine_.cend()) { return false; }
     if (std::find(pending_tags_.cbegin(), pending_tags_.cend(), to_find) != pending_tags_.cend()) { return false; }
     // Ignore private tags
     if (to_find[0] == internal::private_tag_marker) { return false; }
@@ -712,14 +1463,42 @@ Waiter<void> Manager::subscribe(const std::vector<TagID>& tag_ids) noexcept
 
 Waiter<bool> Manager::ip_subscribe(const AddrPortPair& addr, const std::vector<TagID>& tag_ids) noexcept
 {
-  const auto canonical_addr = internal::to_canonical(addr);
+  bool is_self_sub = false;
+  const auto resolution = resolver_.resolve(addr.first);
+  address_resolutions_.erase(addr);
+  switch (resolution.status) {
+  case internal::Resolution::Status::resolved:
+    record_resolution(addr, resolution, {});
+    is_self_sub = ip_subscribe_resolved(AddrPortPair{resolution.address, addr.second}, tag_ids);
+    break;
+
+  case internal::Resolution::Status::pending:
+    pending_resolutions_.push_back(PendingResolution{addr, ConnType::specific_ip, tag_ids, clock_.now()});
+    break;
+
+  case internal::Resolution::Status::failed:
+    SKYNET_WARN_LOG("\"{}\" couldn't subscribe to {} as it couldn't be resolved", id_, addr);
+    record_resolution(addr, resolution, {});
+    notify_subscriptions_ = true;
+    break;
+  }
+  // Waiters use the requested address as the resolved one may not be known yet
+  return make_waiter<bool>(
+    job_mut_,
+    subscription_cv_,
+    internal::ManagerIPSubscribeComplete{*this, addr, tag_ids, is_self_sub},
+    internal::ManagerIPSubscribeSuccess{*this, addr, tag_ids, is_self_sub});
+}
+
+bool Manager::ip_subscribe_resolved(const AddrPortPair& canonical_addr, const std::vector<TagID>& tag_ids) noexcept
+{
   const auto iter = addr_to_machine_.find(canonical_addr);
   // Handle self-subscription
   bool is_self_sub = false;
-  if (internal::to_ip_port(canonical_addr) == internal::to_ip_port({"localhost", port_})) {
+  if (canonical_addr == AddrPortPair{"127.0.0.1", port_}) {
     for (const auto& tag : tag_ids) {
       is_self_sub = true;
-      const auto iter = self_sub_count_.find(tag);
+      const auto iter = self_sub_count_.find(tag_symbols_.find(tag));
       if (iter == self_sub_count_.cend()) {
         std::cerr << "Tag \"" << tag << "\" was attempted to be self-subscribed but it isn't produced!\n";
         std::exit(4);
@@ -741,16 +1520,13 @@ Waiter<bool> Manager::ip_subscribe(const AddrPortPair& addr, const std::vector<T
       [](const std::string& so_far, const std::string& next) { return so_far + '\0' + next; });
     const auto [iter, inserted] = pending_conns_.try_emplace(
       canonical_addr,
-      PendingInfo{internal::SocketCommunicator{}, ConnStatus::waiting_for_conn, ConnType::specific_ip, tag_list});
+      PendingInfo{nullptr, ConnStatus::waiting_for_conn, ConnType::specific_ip, tag_list, {}});
     assert(inserted);
     // Ignore the status - it is handeled later
-    (void)iter->second.conn.connect_non_blocking(canonical_addr.first.c_str(), canonical_addr.second);
+    (void)start_connection(iter->second.conn, canonical_addr.first, canonical_addr.second);
+    reactor_.watch(iter->second.conn->native_handle(), true);
   }
-  return make_waiter<bool>(
-    job_mut_,
-    subscription_cv_,
-    internal::ManagerIPSubscribeComplete{*this, canonical_addr, tag_ids, is_self_sub},
-    internal::ManagerIPSubscribeSuccess{*this, canonical_addr, tag_ids, is_self_sub});
+  return is_self_sub;
 }
 
 void Manager::handle_get_publishers(const internal::GetPublishers& msg, internal::ExternalManager& from) noexcept
@@ -768,8 +1544,8 @@ void Manager::handle_get_publishers(const internal::GetPublishers& msg, internal
     // sent back so that the receiving end no longer thinks they are pending
     // Also clear them if the cache is being ignored, as it is assumed that
     // they are now invalid
-    for (const auto& tag : remaining_tags) {
-      const auto& [iter, inserted] = publishers_for_tag_.try_emplace(tag);
+    for (const auto tag : remaining_tags) {
+      const auto& [iter, inserted] = publishers_for_tag_.try_emplace(tag_symbols_.intern(tag));
       (void)inserted;
       if (msg.ignore_cache()) { iter->second.clear(); }
     }
@@ -780,7 +1556,7 @@ void Manager::handle_get_publishers(const internal::GetPublishers& msg, internal
         "\"{}\" sending \"{}\" publisher information for {}, no neighbors to ask", id_, from.id(), [&]() {
           std::vector<TagID> known_tags;
           for (const auto& [tag, publishers] : publishers_for_tag_) {
-            if (!publishers.empty()) { known_tags.push_back(tag); }
+            if (!publishers.empty()) { known_tags.push_back(tag_symbols_.name(tag)); }
           }
           return known_tags;
         }());
@@ -788,8 +1564,8 @@ void Manager::handle_get_publishers(const internal::GetPublishers& msg, internal
       return;
     }
     // Mark the information as needing to be propagated
-    for (const auto& tag : remaining_tags) {
-      auto [iter, dummy] = send_publisher_information_to_.try_emplace(tag);
+    for (const auto tag : remaining_tags) {
+      auto [iter, dummy] = send_publisher_information_to_.try_emplace(tag_symbols_.intern(tag));
       iter->second.emplace(from.id());
       (void)dummy;
     }
@@ -804,7 +1580,10 @@ void Manager::handle_get_publishers(const internal::GetPublishers& msg, internal
       from.send_message(make_known_tag_publisher_message());
       // No longer need to propagate information to this neighbor, as it
       // is being sent now
-      send_publisher_information_to_.erase(from.id());
+      for (auto iter = send_publisher_information_to_.begin(); iter != send_publisher_information_to_.end();) {
+        iter->second.erase(from.id());
+        iter = iter->second.empty() ? send_publisher_information_to_.erase(iter) : std::next(iter);
+      }
     }
     else {
       SKYNET_TRACE_LOG(
@@ -820,10 +1599,10 @@ void Manager::handle_get_publishers(const internal::GetPublishers& msg, internal
 }
 
 auto Manager::remove_tags_with_enough_publishers(const internal::GetPublishers& msg) noexcept
-  -> std::pair<std::vector<TagID>, std::vector<std::uint8_t>>
+  -> std::pair<std::pmr::vector<std::string_view>, std::pmr::vector<std::uint8_t>>
 {
-  auto tags_left = msg.tags();
-  auto publishers_needed = msg.publishers_needed();
+  auto tags_left = msg.tags(tick_arena_.resource());
+  auto publishers_needed = msg.publishers_needed(tick_arena_.resource());
   // Remove tags that either have a known producer or are known locally
   const auto [tag_iter, num_iter]
     = std::remove_if(
@@ -835,15 +1614,22 @@ auto Manager::remove_tags_with_enough_publishers(const internal::GetPublishers&
           // Just count it as an additional source for now, but presumably just having it
           // be valid no matter what is the best option going forward (why would you not
           // trust yourself?)
-          const auto self_subscribed = self_sub_count_.find(tag) != self_sub_count_.cend();
-          const auto loc = publishers_for_tag_.find(tag);
+          const auto symbol = tag_symbols_.find(tag);
+          const auto self_subscribed = self_sub_count_.find(symbol) != self_sub_count_.cend();
+          const auto loc = publishers_for_tag_.find(symbol);
           const auto num_external_pubs = loc == publishers_for_tag_.cend() ? 0 : loc->second.size();
           return num_external_pubs + self_subscribed >= num_left;
         })
         .underlying_iters();
   tags_left.erase(tag_iter, tags_left.end());
   publishers_needed.erase(num_iter, publishers_needed.end());
-  return {tags_left, publishers_needed};
+  return {std::move(tags_left), std::move(publishers_needed)};
+}
+
+const TagID& Manager::lookup_key(const std::string_view tag) noexcept
+{
+  lookup_key_.assign(tag);
+  return lookup_key_;
 }
 
 void Manager::add_publishers_and_propagate(
@@ -873,31 +1659,13 @@ void Manager::add_publishers_and_propagate(
     const auto& publishers = publishers_list[i];
     const auto& machines = machines_list[i];
     // Find or create the tag
-    decltype(publishers_for_tag_)::iterator iter = [&]() noexcept {
-      const auto loc = publishers_for_tag_.find(tag);
-      if (loc == publishers_for_tag_.end()) {
-        const auto [iter, inserted] = publishers_for_tag_.try_emplace(tag);
-        (void)inserted;
-        return iter;
-      }
-      else {
-        return loc;
-      }
-    }();
+    const auto iter = publishers_for_tag_.try_emplace(tag_symbols_.intern(tag)).first;
     insert_publisher_infos(iter, publishers, machines);
   }
   // Add the tags that the external manager produced
   const auto external_tags = msg.locally_produced_tags();
   for (const auto& tag : external_tags) {
-    const decltype(publishers_for_tag_)::iterator iter = [&]() noexcept {
-      const auto loc = publishers_for_tag_.find(tag);
-      if (loc == publishers_for_tag_.end()) {
-        using SecondType = decltype(publishers_for_tag_)::value_type::second_type;
-        const auto [iter, inserted] = publishers_for_tag_.insert_or_assign(tag, SecondType{});
-        return iter;
-      }
-      return loc;
-    }();
+    const auto iter = publishers_for_tag_.try_emplace(tag_symbols_.intern(tag)).first;
     iter->second.insert(internal::PublisherInfo{from.address(), from.id()});
   }
   // Propagate to any machines that need this information, marking them
@@ -942,7 +1710,7 @@ std::vector<std::byte> Manager::make_known_tag_publisher_message() const noexcep
         new_addrs.push_back(addr);
         new_machines.push_back(machine);
       }
-      tags_to_send.push_back(tag);
+      tags_to_send.push_back(tag_symbols_.name(tag));
     }
   }
   return internal::make_report_publishers(tags_to_send, addresses_to_send, machines_to_send, local_tags());
@@ -953,7 +1721,7 @@ void Manager::report_new_publish_tags(const std::vector<TagID>& tags) noexcept
   SKYNET_TRACE_LOG("\"{}\" adding tags produced: {}", id_, tags);
   // Mark the tags produced by this job
   for (const auto& tag : tags) {
-    const auto [iter, inserted] = self_sub_count_.emplace(tag, 0);
+    const auto [iter, inserted] = self_sub_count_.try_emplace(tag_symbols_.intern(tag), 0);
     (void)iter;
     if (!inserted) {
       // Two jobs on the same manager can't produce the same tag; fail loudly
@@ -970,7 +1738,7 @@ Waiter<internal::ReduceGroupBase&> Manager::create_reduce_group(std::unique_ptr<
   const auto& tag_produced = internal::ReduceGroupBase::Accessor::produced_tag(*group_ptr);
   const auto& group_id = internal::ReduceGroupBase::Accessor::group_id(*group_ptr);
   // Create an entry for the group
-  const auto [tag_iter, tag_inserted] = self_sub_count_.emplace(tag_produced, 0);
+  const auto [tag_iter, tag_inserted] = self_sub_count_.try_emplace(tag_symbols_.intern(tag_produced), 0);
   (void)tag_iter;
   if (!tag_inserted) {
     std::cerr << "The tag " << std::quoted(tag_produced)
@@ -1030,7 +1798,7 @@ bool Manager::reduce_group_is_created(const TagID& group_id) noexcept
   const auto& reduce_data = group_iter->second;
   const auto& parent_tag = internal::ReduceGroupBase::Accessor::tag_neighbors(*reduce_data.group).parent();
   if (!parent_tag.empty() && reduce_data.parent_machines.empty()) {
-    if (self_sub_count_.find(parent_tag) == self_sub_count_.cend()) {
+    if (self_sub_count_.find(tag_symbols_.find(parent_tag)) == self_sub_count_.cend()) {
       SKYNET_TRACE_LOG(
         "\"{}\" - reduce group \"{}\" is not yet created as there is no parent connection", id_, group_id);
       return false;
@@ -1041,7 +1809,7 @@ bool Manager::reduce_group_is_created(const TagID& group_id) noexcept
     // Ignore empty tags
     const auto& neighbors = internal::ReduceGroupBase::Accessor::tag_neighbors(*reduce_data.group);
     if (!neighbors.tags[i + 1].empty() && reduce_data.child_machines[i].empty()) {
-      if (self_sub_count_.find(neighbors.tags[i + 1]) == self_sub_count_.cend()) {
+      if (self_sub_count_.find(tag_symbols_.find(neighbors.tags[i + 1])) == self_sub_count_.cend()) {
         SKYNET_TRACE_LOG(
           "\"{}\" - reduce group \"{}\" is not yet created as the {} child has no connections",
           id_,
@@ -1109,7 +1877,7 @@ internal::ReduceGroupBase& Manager::get_reduce_group(const TagID& group_id) noex
 }
 
 void Manager::reduce_send_data_and_remove_missing(
-  std::vector<MachineID>& machines, const std::vector<std::byte>& message) noexcept
+  std::vector<MachineID>& machines, const internal::SharedFrame& message) noexcept
 {
   for (auto iter = machines.begin(); iter != machines.end();) {
     const auto parent_loc = neighbors_.find(*iter);
@@ -1121,18 +1889,44 @@ void Manager::reduce_send_data_and_remove_missing(
   }
 }
 
+void Manager::queue_reduce_message(
+  const TagID& group_id, const ReduceDestination destination, std::vector<std::byte> message) noexcept
+{
+  auto frame = std::make_shared<const std::vector<std::byte>>(std::move(message));
+  auto [outbox, lock] = reduce_outbox_.get();
+  outbox.push_back({group_id, destination, std::move(frame)});
+}
+
+void Manager::send_queued_reduce_messages() noexcept
+{
+  {
+    auto [outbox, lock] = reduce_outbox_.get();
+    if (outbox.empty()) { return; }
+    outbox.swap(reduce_messages_to_send_);
+  }
+  for (const auto& queued : reduce_messages_to_send_) {
+    const auto loc = reduce_tag_data_.find(queued.group_id);
+    if (loc == reduce_tag_data_.cend()) { continue; }
+    if (queued.destination != ReduceDestination::children) {
+      reduce_send_data_and_remove_missing(loc->second.parent_machines, queued.message);
+    }
+    if (queued.destination != ReduceDestination::parent) {
+      for (auto& children : loc->second.child_machines) {
+        reduce_send_data_and_remove_missing(children, queued.message);
+      }
+    }
+  }
+  reduce_messages_to_send_.clear();
+}
+
 void Manager::send_reduce_data_to_parent(
   const TagID& group_id,
   const VersionID version,
   const TagID& reduce_tag,
   gsl::span<const PublishValueVariant> value) noexcept
 {
-  const auto loc = reduce_tag_data_.find(group_id);
-  assert(loc != reduce_tag_data_.cend());
-  auto& parent_machines = loc->second.parent_machines;
-  const auto reduce_message = internal::make_submit_reduce_value(group_id, version, reduce_tag, value);
-  reduce_send_data_and_remove_missing(parent_machines, reduce_message);
-  // internal::ReduceGroupBase::Accessor::add_data(*loc->second.group, reduce_tag, value, version);
+  queue_reduce_message(
+    group_id, ReduceDestination::parent, internal::make_submit_reduce_value(group_id, version, reduce_tag, value));
 }
 
 void Manager::send_reduce_data_to_children(
@@ -1141,26 +1935,17 @@ void Manager::send_reduce_data_to_children(
   const TagID& reduce_tag,
   gsl::span<const PublishValueVariant> value) noexcept
 {
-  const auto loc = reduce_tag_data_.find(group_id);
-  assert(loc != reduce_tag_data_.cend());
-  auto& child_machines = loc->second.child_machines;
-  const auto reduce_message = internal::make_submit_reduce_value(group_id, version, reduce_tag, value);
-  for (auto& children : child_machines) {
-    reduce_send_data_and_remove_missing(children, reduce_message);
-  }
-  // internal::ReduceGroupBase::Accessor::add_data(*loc->second.group, reduce_tag, value, version);
+  queue_reduce_message(
+    group_id, ReduceDestination::children, internal::make_submit_reduce_value(group_id, version, reduce_tag, value));
 }
 
 void Manager::send_report_disconnection(
   const TagID& group_id, const MachineID& initiating_machine, const ReductionDisconnectID disconnect_id) noexcept
 {
-  const auto loc = reduce_tag_data_.find(group_id);
-  assert(loc != reduce_tag_data_.cend());
-  const auto msg = internal::make_report_reduce_disconnection(group_id, initiating_machine, disconnect_id);
-  reduce_send_data_and_remove_missing(loc->second.parent_machines, msg);
-  for (auto& children : loc->second.child_machines) {
-    reduce_send_data_and_remove_missing(children, msg);
-  }
+  queue_reduce_message(
+    group_id,
+    ReduceDestination::parent_and_children,
+    internal::make_report_reduce_disconnection(group_id, initiating_machine, disconnect_id));
 }
 
 bool Manager::handle_submit_reduce_value(
@@ -1239,9 +2024,10 @@ void Manager::init_connections_for_pending_tags() noexcept
   
   for (auto tag_iter = pending_tags_.begin(); tag_iter != pending_tags_.end();) {
     const auto& tag = *tag_iter;
-    const auto iter = publishers_for_tag_.find(tag);
+    const auto symbol = tag_symbols_.find(tag);
+    const auto iter = publishers_for_tag_.find(symbol);
     // Delete pending tags for self-published tags
-    if (const auto self_iter = self_sub_count_.find(tag); self_iter != self_sub_count_.cend()) {
+    if (const auto self_iter = self_sub_count_.find(symbol); self_iter != self_sub_count_.end()) {
       ++self_iter->second;
       SKYNET_TRACE_LOG("\"{}\" produces tag \"{}\", not creating connection", id_, tag);
       tag_iter = pending_tags_.erase(tag_iter);
@@ -1307,27 +2093,30 @@ void Manager::init_connections_for_pending_tags() noexcept
     }
   }
   for (const auto& [addr, tag] : to_conn) {
-    internal::SocketCommunicator conn{};
+    std::unique_ptr<internal::Communicator> conn;
     SKYNET_DEBUG_LOG("\"{}\" about to connect to \"{}\" for tag \"{}\"", id_, addr, tag);
-    const auto err = conn.connect_non_blocking(addr);
+    auto [addrstr, port] = internal::split_address(addr);
+    const auto err
+      = addrstr.empty() ? internal::ConnectionError::unrecoverable : start_connection(conn, addrstr, port);
     if (err == internal::ConnectionError::connection_in_progress || err == internal::ConnectionError::no_error) {
       // Port can be recycled, so have to iterate until it gets inserted
       // Ignore the address as the IP isn't initialized until the connection is complete
-      auto [addrstr, port] = internal::split_address(addr);
+      // The info is only moved from once it is inserted
+      auto info = PendingInfo{
+        std::move(conn),
+        ConnStatus::waiting_for_conn,
+        tag[0] == internal::publish_tag_marker ? ConnType::subscription : ConnType::reduce_group,
+        tag,
+        {}};
       while (true) {
         SKYNET_DEBUG_LOG("\"{}\" trying connecting to \"{}\" with key {} for tag \"{}\"",
                          id_, addr, AddrPortPair{addr.substr(0, addr.find(':')), port}, tag);
-        const auto [iter, inserted] = pending_conns_.try_emplace(
-          AddrPortPair{addrstr, port},
-          PendingInfo{
-            std::move(conn),
-            ConnStatus::waiting_for_conn,
-            tag[0] == internal::publish_tag_marker ? ConnType::subscription : ConnType::reduce_group,
-            tag});
+        const auto [iter, inserted] = pending_conns_.try_emplace(AddrPortPair{addrstr, port}, std::move(info));
         (void)iter;
         if (inserted)
         {
           SKYNET_DEBUG_LOG("\"{}\" connecting to \"{}\" for tag \"{}\"", id_, iter->first, tag);
+          reactor_.watch(iter->second.conn->native_handle(), true);
           break;
         }
         ++port;
@@ -1339,16 +2128,75 @@ void Manager::init_connections_for_pending_tags() noexcept
 
 bool Manager::conn_is_complete(const AddrPortPair& address) noexcept
 {
-  return pending_conns_.find(address) == pending_conns_.cend();
+  const bool is_resolving = std::any_of(
+    pending_resolutions_.cbegin(), pending_resolutions_.cend(), [&](const auto& pending) {
+      return pending.address == address;
+    });
+  if (is_resolving) { return false; }
+  const auto canonical = canonical_address(address);
+  // Addresses that couldn't be resolved never had a connection started
+  return !canonical || pending_conns_.find(*canonical) == pending_conns_.cend();
 }
 
 bool Manager::addr_is_connected(const AddrPortPair& address) const noexcept
 {
-  const auto iter = addr_to_machine_.find(address);
+  const auto canonical = canonical_address(address);
+  if (!canonical) { return false; }
+  const auto iter = addr_to_machine_.find(*canonical);
   if (iter == addr_to_machine_.cend()) { return false; }
   return !iter->second->is_dead();
 }
 
+std::optional<AddrPortPair> Manager::canonical_address(const AddrPortPair& address) const noexcept
+{
+  auto resolved = resolver_.cached(address.first);
+  if (!resolved) { return std::nullopt; }
+  return AddrPortPair{std::move(*resolved), address.second};
+}
+
+void Manager::record_resolution(
+  const AddrPortPair& requested,
+  const internal::Resolution& resolution,
+  const std::chrono::steady_clock::duration latency) noexcept
+{
+  const bool failed = resolution.status == internal::Resolution::Status::failed;
+  address_resolutions_.insert_or_assign(
+    requested, AddressResolution{failed ? std::string{} : resolution.address, resolution.error, latency});
+}
+
+void Manager::resolve_pending_addresses() noexcept
+{
+  // Failures are only reported once, so look each host up once per pass
+  std::unordered_map<std::string, internal::Resolution> resolutions;
+  for (auto iter = pending_resolutions_.begin(); iter != pending_resolutions_.end();) {
+    auto res_iter = resolutions.find(iter->address.first);
+    if (res_iter == resolutions.end()) {
+      res_iter = resolutions.emplace(iter->address.first, resolver_.resolve(iter->address.first)).first;
+    }
+    const auto& resolution = res_iter->second;
+    if (resolution.status == internal::Resolution::Status::pending) {
+      ++iter;
+      continue;
+    }
+    const auto pending = std::move(*iter);
+    iter = pending_resolutions_.erase(iter);
+    notify_connection_ = true;
+    notify_subscriptions_ = true;
+    // Read by the job once its waiter returns, so it is there before they are woken
+    record_resolution(pending.address, resolution, clock_.now() - pending.started);
+    if (resolution.status == internal::Resolution::Status::failed) {
+      SKYNET_WARN_LOG(
+        "\"{}\" couldn't connect to {} as it couldn't be resolved: {}", id_, pending.address, resolution.error);
+      continue;
+    }
+    const AddrPortPair canonical{resolution.address, pending.address.second};
+    if (pending.type == ConnType::user_requested) { start_user_connection(canonical); }
+    else {
+      (void)ip_subscribe_resolved(canonical, pending.tags);
+    }
+  }
+}
+
 const char* Manager::to_c_str(ConnType type) noexcept
 {
   switch (type) {
@@ -1375,7 +2223,7 @@ void Manager::process_pending_conns() noexcept
   const auto handle_error = [&](PendingInfo& info) {
     const auto handle_tag = [&](const std::string& pub_tag, const std::string& base_tag) {
       new_pending_tags = true;
-      const auto pub_iter = publishers_for_tag_.find(pub_tag);
+      const auto pub_iter = publishers_for_tag_.find(tag_symbols_.find(pub_tag));
       assert(pub_iter != publishers_for_tag_.cend());
       auto& publishers = pub_iter->second;
       // Set to ignore cache if there are no more publishers
@@ -1423,7 +2271,7 @@ void Manager::process_pending_conns() noexcept
     bool okay = true;
     auto& info = iter->second;
     if (info.status == ConnStatus::waiting_for_conn) {
-      const auto init_status = info.conn.connection_progress_status();
+      const auto init_status = info.conn->connection_progress_status();
       switch (init_status) {
       case internal::ConnectionError::connection_in_progress:
         break;
@@ -1431,15 +2279,17 @@ void Manager::process_pending_conns() noexcept
       case internal::ConnectionError::no_error: {
         SKYNET_TRACE_LOG(
           "\"{}\" sending greeting from {} to {} for tag \"{}\"",
-          id_, info.conn.host_ip_address_and_port(), info.conn.ip_address_and_port(), info.tag);
+          id_, info.conn->host_ip_address_and_port(), info.conn->ip_address_and_port(), info.tag);
         // Send message and mark as waiting
         const auto message = make_handshake();
-        if (info.conn.send_message(message.data(), message.size()) != internal::ConnectionError::no_error) {
+        if (info.conn->send_message(message.data(), message.size()) != internal::ConnectionError::no_error) {
           notify_connection_ = true;
           iter = pending_conns_.erase(iter);
           continue;
         }
         info.status = ConnStatus::waiting_for_resp;
+        // Only need to know about the response now
+        reactor_.watch(info.conn->native_handle(), false);
       } break;
 
       // Anything else is an error
@@ -1461,32 +2311,41 @@ void Manager::process_pending_conns() noexcept
     else if (info.status == ConnStatus::waiting_for_resp) {
       // TODO: Add timeout here?
       // Try to read message from the connection
-      const auto bytes_to_read_or_error = read_network_size(info.conn);
-      if (std::holds_alternative<internal::ConnectionError>(bytes_to_read_or_error)) {
-        const auto err = *std::get_if<internal::ConnectionError>(&bytes_to_read_or_error);
-        if (err != internal::ConnectionError::would_block) { okay = false; }
+      const auto err = info.received.fill(*info.conn);
+      if (err != internal::ConnectionError::no_error && err != internal::ConnectionError::would_block) {
+        okay = false;
       }
       else {
-        const auto bytes_to_read = *std::get_if<NetworkSizeType>(&bytes_to_read_or_error);
-        if (const auto message_buffer = internal::read_chunked(info.conn, bytes_to_read); !message_buffer.empty()) {
-          if (const auto msg = internal::MessageHandler::try_to_create(message_buffer)) {
+        if (const auto message_buffer = info.received.next_frame()) {
+          if (const auto msg = internal::MessageHandler::try_to_view(*message_buffer, tick_arena_.resource())) {
             decltype(neighbors_)::iterator new_neighbor_iter;
             okay &= msg->do_callback(
               [&](const internal::Greeting& greeting) {
                 // add connection to active list / remove from pending list
                 auto [neighbor_iter, inserted] = neighbors_.try_emplace(
-                  greeting.from(), std::move(info.conn), greeting.from(), greeting.neighbors(), *this, greeting.port());
+                  greeting.from(),
+                  std::move(info.conn),
+                  std::move(info.received),
+                  greeting.from(),
+                  greeting.neighbors(),
+                  *this,
+                  greeting.port(),
+                  greeting.features());
                 new_neighbor_iter = neighbor_iter;
                 if (!inserted) {
                   SKYNET_TRACE_LOG(
                     "\"{}\" already has a connection from \"{}\" so will simply add to communicators.",
                     id_,
                     neighbor_iter->first);
-                  new_neighbor_iter->second.add_communicator(std::move(info.conn));
+                  new_neighbor_iter->second.add_communicator(std::move(info.conn), std::move(info.received));
                   return true;
                 }
                 addr_to_machine_.try_emplace(new_neighbor_iter->second.address_pair(), &neighbor_iter->second);
                 SKYNET_TRACE_LOG("\"{}\" received greeting from \"{}\"", id_, neighbor_iter->first);
+                if (!greeting.local_socket().empty() && is_loopback(neighbor_iter->second.address_pair().first)) {
+                  local_socket_names_.insert_or_assign(neighbor_iter->second.address_pair(), greeting.local_socket());
+                }
+                neighbor_iter->second.offer_shared_memory();
                 return true;
               },
               [&](...) {
@@ -1549,7 +2408,7 @@ void Manager::process_pending_conns() noexcept
       }
       if (!okay) {
         SKYNET_WARN_LOG(
-          "\"{}\" failed connecting to {} for tag \"{}\"", id_, info.conn.ip_address_and_port(), info.tag);
+          "\"{}\" failed connecting to {} for tag \"{}\"", id_, info.conn->ip_address_and_port(), info.tag);
         notify_connection_ = true;
         handle_error(info);
         iter = pending_conns_.erase(iter);
@@ -1566,7 +2425,12 @@ void Manager::process_pending_conns() noexcept
 
 std::vector<std::byte> Manager::make_handshake() const noexcept
 {
-  return internal::make_greeting(id_, make_neighbor_vector(), port_);
+  return internal::make_greeting(
+    id_,
+    make_neighbor_vector(),
+    port_,
+    internal::supported_wire_features,
+    transport_options_.use_local_sockets ? local_socket_name_ : std::string{});
 }
 
 void Manager::finalize_reduce_group(const MachineID& parent_machine_id, const TagID& group_tag) noexcept
@@ -1586,32 +2450,37 @@ bool Manager::subscription_tags_are_produced(const internal::SubscriptionNotice&
 {
   const auto& tags = msg.tags();
   for (const auto& tag : tags) {
-    if (self_sub_count_.find(tag) == self_sub_count_.cend()) { return false; }
+    if (self_sub_count_.find(tag_symbols_.find(tag)) == self_sub_count_.cend()) { return false; }
   }
   return true;
 }
 
-bool Manager::handle_publish_data(const internal::PublishData& msg, const internal::ExternalManager& from) noexcept
+bool Manager::handle_publish_data(
+  const internal::PublishData& msg, const TagID& tag_id, internal::ExternalManager& from) noexcept
 {
-  (void)from;
-  if (const auto value = msg.value()) {
-    SKYNET_TRACE_LOG(
-      "\"{}\" received data on tag \"{}\" from \"{}\", version {}, data: {}",
-      id_,
-      msg.tag_id(),
-      from.id(),
-      msg.version(),
-      *value);
-    bool okay = true;
+  SKYNET_TRACE_LOG(
+    "\"{}\" received data on tag \"{}\" from \"{}\", version {}", id_, tag_id, from.id(), msg.version());
+  bool okay = true;
+  if (msg.is_delta_base()) {
+    // Rebuilt in place, since the next value may be sent as the changes from this one
+    auto& value = from.received_value(tag_id);
+    if (!msg.apply_to(value)) {
+      SKYNET_WARN_LOG("\"{}\" couldn't apply the changes on tag \"{}\" from \"{}\"", id_, tag_id, from.id());
+      value.clear();
+      return false;
+    }
     for (auto& [job_id, job] : jobs_) {
       (void)job_id;
-      okay &= Job::Accessor::process_data(job, msg.tag_id(), *value, msg.version());
+      okay &= Job::Accessor::process_data(job, tag_id, value, msg.version());
     }
     return okay;
   }
-  else {
-    return false;
+  // Each job decodes the values straight into its own buffer
+  for (auto& [job_id, job] : jobs_) {
+    (void)job_id;
+    okay &= Job::Accessor::process_data(job, tag_id, msg);
   }
+  return okay;
 }
 
 void Manager::finalize_subscription(const std::string& tags, internal::ExternalManager& source) noexcept
@@ -1624,7 +2493,7 @@ void Manager::finalize_subscription(const std::string& tags, internal::ExternalM
       return std::string{v};
     });
   for (const auto& tag : tags_to_sub_to) {
-    tag_to_machine_[tag] = &source;
+    tag_to_machine_[tag_symbols_.intern(tag)] = &source;
   }
   const auto msg = internal::make_subscription_notice(tags_to_sub_to, false);
   source.send_message(msg);
@@ -1642,8 +2511,9 @@ void Manager::find_publishers_for_pending_tags(const bool force_ask) noexcept
   }
   else {
     const auto no_known_publishers = [&](const TagID& tag) noexcept {
-      if (tag_to_machine_.find(tag) != tag_to_machine_.cend()) { return false; }
-      const auto iter = publishers_for_tag_.find(tag);
+      const auto symbol = tag_symbols_.find(tag);
+      if (tag_to_machine_.find(symbol) != tag_to_machine_.cend()) { return false; }
+      const auto iter = publishers_for_tag_.find(symbol);
       if (iter == publishers_for_tag_.cend()) { return true; }
       return iter->second.empty();
     };
@@ -1660,11 +2530,30 @@ void Manager::find_publishers_for_pending_tags(const bool force_ask) noexcept
   }
 }
 
+std::chrono::milliseconds Manager::time_until_next_timer() const noexcept
+{
+  using namespace std::chrono;
+  const auto now = clock_.now();
+  auto next_timer = now + heartbeat_interval_;
+  for (const auto& [name, neighbor] : neighbors_) {
+    (void)name;
+    next_timer = std::min(next_timer, neighbor.next_heartbeat_time(heartbeat_interval_));
+    next_timer = std::min(next_timer, neighbor.next_flush_time(transport_options_));
+    // Tag requests are only re-sent while something is still pending; a request time
+    // that has already passed means nothing needed asking this pass, so don't spin on it
+    if (!pending_tags_.empty() && !neighbor.has_pending_tag_request()) {
+      next_timer = std::min(next_timer, std::max(neighbor.next_tag_request_time(), now + milliseconds{20}));
+    }
+  }
+  if (next_timer <= now) { return milliseconds{0}; }
+  return std::chrono::ceil<milliseconds>(next_timer - now);
+}
+
 std::vector<TagID> Manager::local_tags() const noexcept
 {
   std::vector<TagID> to_ret(self_sub_count_.size());
-  std::transform(self_sub_count_.cbegin(), self_sub_count_.cend(), to_ret.begin(), [](const auto& tag_pair) {
-    return tag_pair.first;
+  std::transform(self_sub_count_.cbegin(), self_sub_count_.cend(), to_ret.begin(), [&](const auto& tag_pair) {
+    return tag_symbols_.name(tag_pair.first);
   });
   return to_ret;
 }
@@ -2,10 +2,26 @@
 #define SKYNET_MANAGER_HPP
 
 #include "skywing_core/internal/capn_proto_wrapper.hpp"
+#include "skywing_core/internal/devices/address_resolver.hpp"
+#include "skywing_core/internal/devices/communicator.hpp"
+#include "skywing_core/internal/devices/in_process_communicator.hpp"
+#include "skywing_core/internal/devices/reactor.hpp"
+#include "skywing_core/internal/devices/receive_buffer.hpp"
+#include "skywing_core/internal/devices/send_queue.hpp"
+#include "skywing_core/internal/devices/shared_memory_ring.hpp"
 #include "skywing_core/internal/devices/socket_communicator.hpp"
+#include "skywing_core/internal/job_activity.hpp"
 #include "skywing_core/internal/manager_waiter_callables.hpp"
 #include "skywing_core/internal/message_creators.hpp"
 #include "skywing_core/internal/reduce_group.hpp"
+#include "skywing_core/internal/utility/clock.hpp"
+#include "skywing_core/internal/utility/flat_id_map.hpp"
+#include "skywing_core/internal/utility/frame_compression.hpp"
+#include "skywing_core/internal/utility/mutex_guarded.hpp"
+#include "skywing_core/internal/utility/rate_limiter.hpp"
+#include "skywing_core/internal/utility/symbol_table.hpp"
+#include "skywing_core/internal/utility/tick_arena.hpp"
+#include "skywing_core/internal/wire_features.hpp"
 // #include "skywing_core/basic_manager_config.hpp"
 #include "skywing_core/job.hpp"
 #include "skywing_core/types.hpp"
@@ -20,8 +36,11 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <memory_resource>
 #include <optional>
+#include <string_view>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -47,7 +66,10 @@ template<>
 struct std::hash<skywing::internal::PublisherInfo> {
   std::size_t operator()(const skywing::internal::PublisherInfo& i) const noexcept
   {
-    return std::hash<std::string>{}(i.address) ^ std::hash<skywing::MachineID>{}(i.machine_id);
+    // Mixed rather than XORed so that swapped or equal fields don't collide
+    const auto address_hash = std::hash<std::string>{}(i.address);
+    const auto id_hash = std::hash<skywing::MachineID>{}(i.machine_id);
+    return address_hash ^ (id_hash + 0x9E3779B97F4A7C15u + (address_hash << 6) + (address_hash >> 2));
   }
 }; // struct std::hash
 
@@ -55,6 +77,143 @@ namespace skywing {
 class Manager;
 class ManagerHandle;
 class Job;
+class Simulator;
+
+/** \brief Counters for the compression of frames exchanged with a neighbor
+ */
+struct CompressionStats {
+  /// Number of frames large enough that compressing them was tried
+  std::size_t frames_attempted = 0;
+
+  /// Number of those frames that were sent compressed
+  std::size_t frames_compressed = 0;
+
+  /// Total size of the frames that compressing was tried on
+  std::size_t bytes_before = 0;
+
+  /// Total size that those frames were sent as, compressed or not
+  std::size_t bytes_after = 0;
+
+  /// Time spent compressing frames
+  std::chrono::nanoseconds compression_time{0};
+
+  /// Number of compressed frames received
+  std::size_t frames_decompressed = 0;
+
+  /// Time spent decompressing received frames
+  std::chrono::nanoseconds decompression_time{0};
+}; // struct CompressionStats
+
+/** \brief Snapshot of the state of the connection to a neighbor
+ */
+struct NeighborStats {
+  /// The ID of the neighbor
+  MachineID id;
+
+  /// Number of messages that have been queued but not completely sent
+  std::size_t queued_messages = 0;
+
+  /// Number of bytes that have been queued but not sent
+  std::size_t queued_bytes = 0;
+
+  /// Number of published values that were replaced by a newer value on the same
+  /// tag before they could be sent
+  std::size_t replaced_publishes = 0;
+
+  /// How well frames exchanged with the neighbor compressed; a frame shared by
+  /// several neighbors is only counted for the one it was compressed for
+  CompressionStats compression;
+
+  /// Values sent to the neighbor under its rate limit
+  RateLimitStats rate_limit;
+
+  /// Number of published values the neighbor has granted credits for that
+  /// haven't been sent yet
+  std::size_t send_credits = 0;
+
+  /// Number of times published values were held back for running out of credits
+  std::size_t times_out_of_credits = 0;
+
+  /// Number of values on tags sent as changes that went out as the changes
+  /// from the value before
+  std::size_t publishes_sent_as_changes = 0;
+
+  /// Number of values on tags sent as changes that went out whole
+  std::size_t publishes_sent_whole = 0;
+}; // struct NeighborStats
+
+/** \brief How looking up the host of a requested connection or IP subscription went
+ */
+struct AddressResolution {
+  /// The address the host was found at; empty if it couldn't be found
+  std::string address;
+
+  /// Why the host couldn't be found; empty if it was
+  std::string error;
+
+  /// How long the manager waited for the lookup; zero for numeric addresses and
+  /// hosts that were already known
+  std::chrono::steady_clock::duration latency{};
+}; // struct AddressResolution
+
+/** \brief Options controlling how messages are written to neighbors
+ *
+ * Messages for a neighbor are queued and written together with a single
+ * gathered send.  Holding on to messages for longer lets more of them share
+ * a send at the cost of latency.
+ */
+struct TransportOptions {
+  /// Write a neighbor's messages as soon as this many are queued; 1 writes every message immediately
+  std::size_t max_batch_messages = 64;
+
+  /// The longest a message is held waiting for others; zero writes at the end of each pass of the manager
+  std::chrono::milliseconds batch_delay{0};
+
+  /// Exchange messages through shared memory with neighbors on the same host, if they support it
+  bool use_shared_memory = true;
+
+  /// The size of the ring used for each direction when using shared memory
+  std::size_t shared_memory_ring_bytes = std::size_t{1} << 22;
+
+  /// Connect to neighbors on the same host through Unix domain sockets instead of TCP when they advertise one
+  bool use_local_sockets = true;
+
+  /// Compress large frames for neighbors that support it, other than those using shared memory
+  bool use_compression = true;
+
+  /// The smallest frame, in bytes, that compressing is tried on
+  std::size_t compression_threshold = 4096;
+
+  /// Replace a value published on a tag that is still waiting to be sent to a neighbor
+  /// with the newer one, so that a slow neighbor is only sent the latest values;
+  /// values sent as changes are never replaced as each depends on the one before
+  bool replace_unsent_publishes = true;
+
+  /// Limits on the published values sent to each neighbor over a socket; values
+  /// over the limit wait in the queue, where newer ones replace them
+  RateLimit neighbor_rate_limit;
+
+  /// Limits on the published values sent to all neighbors together over sockets
+  RateLimit total_rate_limit;
+
+  /// The most published values a neighbor may have in flight to this instance;
+  /// each value that the jobs have yet to read takes one of them, so a neighbor
+  /// publishing faster than the jobs can keep up is slowed down to their pace
+  std::size_t credit_window = 64;
+}; // struct TransportOptions
+
+/** \brief How a Manager reaches other instances
+ */
+enum class ManagerTransport {
+  /// TCP, with local sockets and shared memory for instances on the same host
+  network,
+
+  /// Only instances in the same process, which are addressed as 127.0.0.1 and the
+  /// port they were created with; no sockets or ports of the operating system are used.
+  /// Each instance still has its own event loop and thread, which take two file
+  /// descriptors on Linux; use a Simulator to run thousands of instances
+  in_process
+}; // enum class ManagerTransport
 
 namespace internal {
 // The default hearbeat interval
@@ -73,11 +232,13 @@ struct ByRequest {};
 class ExternalManager {
 public:
   ExternalManager(
-    SocketCommunicator comm,
+    std::unique_ptr<Communicator> comm,
+    ReceiveBuffer received,
     const MachineID& id,
     const std::vector<MachineID>& neighbors,
     Manager& manager,
-    std::uint16_t port) noexcept;
+    std::uint16_t port,
+    WireFeatures features) noexcept;
 
   /** \brief Handles any messages sent from the connection
    */
@@ -85,15 +246,163 @@ public:
 
   /** \brief Sends a raw message to the other manager
    *
+   * The message is queued and as much of the queue as possible is written
+   * immediately; anything left is written once the connection is writable.
    * Also marks the connection as dead if any errors occur.  Does nothing
    * if the connection is marked as dead.
    */
-  void send_message(const std::vector<std::byte>& c) noexcept;
+  void send_message(std::vector<std::byte> c) noexcept;
+
+  /** \brief Sends a message that may be shared with other neighbors
+   *
+   * The message is compressed first if it is worth it; see prepare_frame().
+   */
+  void send_message(SharedFrame frame) noexcept;
+
+  /** \brief Compresses a frame for this neighbor if compression is enabled,
+   * the frame is at least the threshold in size, and compressing shrinks it
+   *
+   * \return The compressed frame, or the frame itself if it wasn't compressed
+   */
+  SharedFrame prepare_frame(SharedFrame frame) noexcept;
+
+  /** \brief Sends a frame that has already been through prepare_frame()
+   *
+   * \param rate_limited If the frame holds a published value, which is held
+   * back while over the rate limits
+   */
+  void send_prepared_frame(SharedFrame frame, bool rate_limited = false) noexcept;
+
+  /** \brief Sends a prepared frame holding a value published on a tag,
+   * replacing the last value on the tag if that hasn't been sent yet
+   *
+   * \param tag_index The index the frame names the tag by if the neighbor
+   * supports it, which is bound to the tag first if it hasn't been yet
+   */
+  void send_prepared_publish(const TagID& tag_id, std::uint32_t tag_index, SharedFrame frame) noexcept;
+
+  /** \brief Publishes a value on a tag as the changes from the value last
+   * sent to the neighbor on it, or whole if it is time for a full value
+   *
+   * \param value The value, which is kept to send the next one against
+   * \param quantization The lossy encoding for vectors sent whole
+   * \param tag_index As for send_prepared_publish
+   */
+  void send_publish_delta(
+    VersionID version,
+    const TagID& tag_id,
+    std::shared_ptr<const std::vector<PublishValueVariant>> value,
+    const DeltaEncoding& delta,
+    Quantization quantization,
+    std::uint32_t tag_index) noexcept;
+
+  /** \brief Returns the last value received on a tag whose values may be sent
+   * as changes, which is empty if there hasn't been one
+   */
+  std::vector<PublishValueVariant>& received_value(const TagID& tag_id) noexcept;
+
+  /** \brief Writes any queued messages that the connection will accept
+   */
+  void flush_send_queue() noexcept;
+
+  /** \brief Writes queued messages if enough have built up, the oldest one
+   * has waited long enough, or an earlier write was cut short
+   */
+  void flush_send_queue_if_due(std::chrono::steady_clock::time_point now, const TransportOptions& options) noexcept;
+
+  /** \brief Returns the time by which the queued messages have to be written,
+   * or time_point::max() if there's nothing that will become due
+   */
+  std::chrono::steady_clock::time_point next_flush_time(const TransportOptions& options) const noexcept;
+
+  /** \brief Returns the number of messages waiting to be sent
+   */
+  std::size_t send_queue_size() const noexcept;
+
+  /** \brief Returns the number of bytes waiting to be sent
+   */
+  std::size_t send_queue_bytes() const noexcept;
 
   /** \brief Returns the id of the computer this is connected to
    */
   MachineID id() const noexcept;
 
+  /** \brief Returns the wire features that both sides support
+   */
+  WireFeatures wire_features() const noexcept;
+
+  /** \brief Returns the wire features that frames sent to the neighbor are
+   * encoded with; frames going through shared memory aren't compressed
+   */
+  WireFeatures frame_features() const noexcept;
+
+  /** \brief Returns how well frames exchanged with the neighbor compressed
+   */
+  const CompressionStats& compression_stats() const noexcept;
+
+  /** \brief Returns the number of published values replaced before being sent
+   */
+  std::size_t replaced_publishes() const noexcept;
+
+  /** \brief Returns the counters for the values sent under the neighbor's rate limit
+   */
+  RateLimitStats rate_limit_stats() const noexcept;
+
+  /** \brief Grants the neighbor credits for more published values if enough
+   * of the ones it was allowed have been received and the jobs are keeping up
+   */
+  void grant_credits() noexcept;
+
+  /** \brief Returns the number of published values that can be sent before
+   * the neighbor grants more credits
+   */
+  std::size_t send_credits() const noexcept;
+
+  /** \brief Returns the number of times published values were held back for
+   * running out of credits
+   */
+  std::size_t times_out_of_credits() const noexcept;
+
+  /** \brief Returns the number of values on tags sent as changes that were
+   * sent as the changes from the value before
+   */
+  std::size_t publishes_sent_as_changes() const noexcept;
+
+  /** \brief Returns the number of values on tags sent as changes that were
+   * sent whole
+   */
+  std::size_t publishes_sent_whole() const noexcept;
+
+  /** \brief Returns true if published values for the neighbor are being held
+   * back or the connection isn't taking any more data
+   *
+   * Values queued since the last flush count as held back if the credits or
+   * rate limits won't let them through on the next one.
+   */
+  bool is_backpressured() const noexcept;
+
+  /** \brief Returns true if the neighbor is on the same host
+   */
+  bool is_on_same_host() const noexcept;
+
+  /** \brief Offers the neighbor a shared memory ring to receive messages
+   * through if it is on the same host and both sides support it
+   *
+   * Messages keep going over the socket until the neighbor accepts.
+   */
+  void offer_shared_memory() noexcept;
+
+  /** \brief Returns true if messages are being sent through shared memory
+   */
+  bool is_using_shared_memory() const noexcept;
+
+  /** \brief Called before the manager blocks; asks the neighbor to notify
+   * this side over the socket when it next writes to the shared memory ring
+   *
+   * \return false if there are already messages waiting in the ring
+   */
+  bool prepare_to_sleep() noexcept;
+
   /** \brief Returns if the connection is dead or not
    */
   bool is_dead() const noexcept;
@@ -110,11 +419,24 @@ public:
    */
   void send_heartbeat_if_past_interval(std::chrono::milliseconds interval) noexcept;
 
+  /** \brief Returns the time at which a heartbeat will next be due
+   */
+  std::chrono::steady_clock::time_point next_heartbeat_time(std::chrono::milliseconds interval) const noexcept;
+
+  /** \brief Returns the earliest time at which tags may be asked for again
+   */
+  std::chrono::steady_clock::time_point next_tag_request_time() const noexcept;
+
   /** \brief Begins the search process for the specified tags
    */
   void find_publishers_for_tags(
     const std::vector<TagID>& tags, const std::vector<std::uint8_t>& publishers_needed) noexcept;
 
+  /** \brief Same as the above, for tags viewed in a message being handled
+   */
+  void find_publishers_for_tags(
+    gsl::span<const std::string_view> tags, gsl::span<const std::uint8_t> publishers_needed) noexcept;
+
   /** \brief The address for communication with the external manager
    */
   std::string address() const noexcept;
@@ -152,8 +474,8 @@ public:
   const std::vector<MachineID>& neighbors()
   { return neighbors_; }
 
-  void add_communicator(SocketCommunicator&& comm)
-  { conns_.push_back(std::move(comm)); }
+  void add_communicator(std::unique_ptr<Communicator>&& comm, ReceiveBuffer&& received)
+  { conns_.push_back(Link{std::move(comm), std::move(received)}); }
 
 private:
   // // Read some bytes from the connection, returning false if the read failed
@@ -163,8 +485,46 @@ private:
   // // the number of bytes couldn't be read
   // std::vector<std::byte> read_from_conn(std::size_t count) noexcept;
 
-  // Attempts to get a message
-  std::optional<MessageHandler> try_to_get_message(SocketCommunicator& socket_comm) noexcept;
+  // A connection along with the data that has been received on it
+  struct Link {
+    std::unique_ptr<Communicator> conn;
+    ReceiveBuffer received;
+  };
+
+  // Handles every message that is available on a connection or ring
+  template<typename Connection>
+  void handle_messages_from(Connection& conn, ReceiveBuffer& received) noexcept;
+
+  // Writes the messages queued for the shared memory ring
+  void flush_shared_memory_queue() noexcept;
+
+  // Tells the neighbor that messages now come through the ring, once nothing
+  // is held back on the socket that newer values through the ring could pass
+  void switch_to_shared_memory_if_ready() noexcept;
+
+  // Writes the queue if enough messages that aren't waiting on the rate limits have built up
+  void flush_if_batch_full(const SendQueue& queue) noexcept;
+
+  // Returns true if the rate limits allow a published value to be sent
+  bool rate_limits_allow(std::chrono::steady_clock::time_point now) const noexcept;
+
+  // Returns true if the neighbor will take another published value
+  bool has_send_credit() const noexcept;
+
+  // Takes a credit for a published value if there is one
+  bool take_send_credit() noexcept;
+
+  // Sends the binding of a tag to its index ahead of the first value that names
+  // the tag by it; does nothing if the neighbor is sent the name instead
+  void bind_tag(const TagID& tag_id, std::uint32_t tag_index) noexcept;
+
+  // Returns the tag the neighbor bound to an index, or nullptr if it hasn't
+  const TagID* received_tag_binding(std::uint32_t tag_index) const noexcept;
+
+  // Returns the message in a received frame, decompressing it if needed,
+  // or nothing if it couldn't be decompressed
+  std::optional<gsl::span<const std::byte>>
+  decode_frame(gsl::span<const std::byte> payload, std::uint8_t flags) noexcept;
 
   // Handle status messages
   void handle_message(MessageHandler& handle) noexcept;
@@ -172,15 +532,33 @@ private:
   // Calculate the next time tags should be requested
   std::chrono::steady_clock::time_point calc_next_request_time() const noexcept;
 
+  // The current time according to the manager's clock
+  std::chrono::steady_clock::time_point now() const noexcept;
+
   // For talking with the external manager.  
-  // See you'd think there would only be one SocketCommunicator for
+  // See you'd think there would only be one Communicator for
   // talking to another agent, so why the vector? It's because
   // sometimes agents initiate connections with each other
   // simulataneously, creating multiple socket connections between the
   // same pair of agents. Deciding which one to drop would require an
   // entire agreement protocol, which isn't worth it, so just hang on
   // to both.
-  std::vector<SocketCommunicator> conns_;
+  std::vector<Link> conns_;
+
+  // Messages waiting to be written to conns_[0]
+  SendQueue send_queue_;
+
+  // Ring that messages are written to once the neighbor has attached to it
+  std::optional<SharedMemoryRing> shm_tx_;
+
+  // Messages waiting to be written to shm_tx_
+  SendQueue shm_queue_;
+
+  // Ring that the neighbor writes messages to
+  std::optional<SharedMemoryRing> shm_rx_;
+
+  // The data that has been read from shm_rx_
+  ReceiveBuffer shm_received_;
 
   // The id of the external manager
   MachineID id_;
@@ -204,6 +582,52 @@ private:
   // The port to use to connect to the remote machine
   std::uint16_t port_;
 
+  // The optional encodings that can be used when sending to the remote machine
+  WireFeatures features_;
+
+  // Added to by prepare_frame for every frame queued, so frames are only
+  // prepared with job_mut_ held or on the manager thread
+  CompressionStats compression_stats_;
+
+  // Limits the published values sent over the socket
+  RateLimiter rate_limiter_;
+
+  // The published values the neighbor will take before granting more credits
+  // Taken by publishes from jobs, which hold job_mut_, and topped up on the
+  // manager thread; nothing else may send published values to the neighbor
+  std::uint64_t send_credits_ = 0;
+  std::size_t times_out_of_credits_ = 0;
+
+  // The credits the neighbor has left as far as this side knows, which is
+  // what it was granted less the published values received since
+  std::uint64_t granted_credits_ = 0;
+
+  // Tags that published values have been received on, which are checked for
+  // how far behind the jobs are when granting credits
+  std::unordered_set<TagID> tags_received_;
+
+  // The indices that have been bound to tags for the neighbor
+  std::vector<bool> sent_tag_bindings_;
+
+  // The tags the neighbor has bound to each index, empty if it hasn't
+  std::vector<TagID> received_tag_bindings_;
+
+  // The last value sent on each tag that sends changes, and how many have been
+  // sent as changes since the last whole one
+  struct SentValue {
+    std::shared_ptr<const std::vector<PublishValueVariant>> value;
+    std::uint32_t deltas_since_full = 0;
+  };
+  std::unordered_map<TagID, SentValue> sent_values_;
+  std::size_t publishes_sent_as_changes_ = 0;
+  std::size_t publishes_sent_whole_ = 0;
+
+  // The last value received on each tag that sends changes
+  std::unordered_map<TagID, std::vector<PublishValueVariant>> received_values_;
+
+  // Reused for the message in each compressed frame received
+  std::vector<std::uint64_t> decompressed_;
+
   // The number of times requests have been unfulfilled
   std::uint8_t backoff_counter_ = 0;
 
@@ -215,10 +639,27 @@ private:
 
   // If there is a request out for tags or not
   bool pending_tag_request_ = false;
+
+  // If messages are sent through shm_tx_ instead of the socket
+  // Set on the manager thread and read by every send, so sends from jobs have to
+  // hold job_mut_; a plain bool is enough then
+  bool shm_tx_active_ = false;
+
+  // If the neighbor accepted shm_tx_ but the switch to it is waiting on held publishes
+  bool shm_switch_pending_ = false;
+
+  // If the neighbor has switched to sending through shm_rx_
+  bool shm_rx_active_ = false;
 }; // class ExternalManager
 } // namespace internal
 
 /** \brief The manager Skywing instance used for communication
+ *
+ * Every instance created directly runs its own event loop on its own thread,
+ * which holds a few file descriptors even when only talking to instances in
+ * the same process.  Instances added to a Simulator share one event loop and
+ * thread instead, so only the Simulator scales to thousands of instances in a
+ * process.
  */
 class Manager {
 public:
@@ -229,6 +670,7 @@ public:
    * \param port The port to listen on
    * \param id The ID to assign to this machine
    * \param heartbeat_interval The interval to wait between heartbeats
+   * \param transport How other instances are reached
    */
   template<
     typename Rep = decltype(internal::default_heartbeat_interval)::rep,
@@ -236,13 +678,18 @@ public:
   Manager(
     const std::uint16_t port,
     const MachineID& id,
-    const std::chrono::duration<Rep, Period> heartbeat_interval = internal::default_heartbeat_interval) noexcept
-    : Manager{port, id, std::chrono::duration_cast<std::chrono::milliseconds>(heartbeat_interval)}
+    const std::chrono::duration<Rep, Period> heartbeat_interval = internal::default_heartbeat_interval,
+    const ManagerTransport transport = ManagerTransport::network) noexcept
+    : Manager{port, id, std::chrono::duration_cast<std::chrono::milliseconds>(heartbeat_interval), transport}
   {}
 
   /** \brief Constructor specifically for milliseconds
    */
-  Manager(const std::uint16_t port, const MachineID& id, const std::chrono::milliseconds heartbeat_interval) noexcept;
+  Manager(
+    const std::uint16_t port,
+    const MachineID& id,
+    const std::chrono::milliseconds heartbeat_interval,
+    ManagerTransport transport = ManagerTransport::network) noexcept;
 
   // /** \brief Constructor for building from a file format specified in
   //  * basic_manager_config.hpp
@@ -266,6 +713,16 @@ public:
    */
   void run() noexcept;
 
+  /** \brief Sets how messages are batched when written to neighbors
+   *
+   * Must be called before run().
+   */
+  void set_transport_options(const TransportOptions& options) noexcept;
+
+  /** \brief Returns the options for writing messages to neighbors
+   */
+  const TransportOptions& transport_options() const noexcept;
+
   /** \brief Gets the id of the manager
    */
   const std::string& id() const noexcept;
@@ -275,36 +732,77 @@ public:
   private:
     friend class Job;
 
-    static void
-      publish(Manager& m, const VersionID version, const TagID& tag_id, gsl::span<PublishValueVariant> value) noexcept
+    static std::size_t publish(
+      Manager& m,
+      const VersionID version,
+      const TagID& tag_id,
+      gsl::span<PublishValueVariant> value,
+      const PublishOptions& options) noexcept
+    {
+      std::lock_guard lock{m.job_mut_};
+      const auto behind = m.publish(version, tag_id, value, options);
+      m.reactor_.wake();
+      return behind;
+    }
+
+    static std::size_t publish_typed(
+      Manager& m,
+      const VersionID version,
+      const TagID& tag_id,
+      const internal::PublishValueWriter& value,
+      const PublishOptions& options) noexcept
     {
       std::lock_guard lock{m.job_mut_};
-      m.publish(version, tag_id, value);
+      const auto behind = m.publish_typed(version, tag_id, value, options);
+      m.reactor_.wake();
+      return behind;
+    }
+
+    static std::size_t publish_view(
+      Manager& m,
+      const VersionID version,
+      const TagID& tag_id,
+      gsl::span<const internal::PublishValueView> value,
+      const PublishOptions& options) noexcept
+    {
+      std::lock_guard lock{m.job_mut_};
+      const auto behind = m.publish_view(version, tag_id, value, options);
+      m.reactor_.wake();
+      return behind;
     }
 
     static void report_new_publish_tags(Manager& m, const std::vector<TagID>& tags) noexcept
     {
       std::lock_guard lock{m.job_mut_};
       m.report_new_publish_tags(tags);
+      m.reactor_.wake();
     }
 
     static auto subscribe(Manager& m, const std::vector<TagID>& tag_ids) noexcept
     {
       std::lock_guard lock{m.job_mut_};
+      m.reactor_.wake();
       return m.subscribe(tag_ids);
     }
 
     static auto create_reduce_group(Manager& m, std::unique_ptr<internal::ReduceGroupBase> group_ptr) noexcept
     {
       std::lock_guard lock{m.job_mut_};
+      m.reactor_.wake();
       return m.create_reduce_group(std::move(group_ptr));
     }
 
     static auto ip_subscribe(Manager& m, const AddrPortPair& addr, const std::vector<TagID>& tag_ids) noexcept
     {
       std::lock_guard lock{m.job_mut_};
+      m.reactor_.wake();
       return m.ip_subscribe(addr, tag_ids);
     }
+
+    // Lets the manager thread notice and clean up a finished job right away
+    static void notify_job_finished(Manager& m) noexcept { m.reactor_.wake(); }
+
+    static internal::JobActivity* job_activity(Manager& m) noexcept { return m.job_activity_; }
   }; // struct JobAccessor
 
   // Accessor for the ExternalManager class
@@ -347,13 +845,27 @@ public:
       return m.subscription_tags_are_produced(msg);
     }
 
-    static bool
-      handle_publish_data(Manager& m, const internal::PublishData& msg, const internal::ExternalManager& from) noexcept
+    static bool handle_publish_data(
+      Manager& m, const internal::PublishData& msg, const TagID& tag_id, internal::ExternalManager& from) noexcept
     {
-      return m.handle_publish_data(msg, from);
+      return m.handle_publish_data(msg, tag_id, from);
     }
 
+    static const TagID& lookup_key(Manager& m, const std::string_view tag) noexcept { return m.lookup_key(tag); }
+
     static void notify_subscriptions(Manager& m) noexcept { m.notify_subscriptions_ = true; }
+
+    static internal::Reactor& reactor(Manager& m) noexcept { return m.reactor_; }
+
+    static const internal::Clock& clock(const Manager& m) noexcept { return m.clock_; }
+
+    static const TransportOptions& transport_options(const Manager& m) noexcept { return m.transport_options_; }
+
+    static internal::RateLimiter& total_rate_limiter(Manager& m) noexcept { return m.total_rate_limiter_; }
+
+    static std::size_t unread_versions(Manager& m, const TagID& tag_id) noexcept { return m.unread_versions(tag_id); }
+
+    static std::pmr::memory_resource* tick_arena(Manager& m) noexcept { return m.tick_arena_.resource(); }
   }; // struct ExternalManagerAccessor
 
   struct ReduceGroupAccessor {
@@ -368,6 +880,9 @@ public:
       gsl::span<const PublishValueVariant> value) noexcept
     {
       m.send_reduce_data_to_parent(group_id, version, reduce_tag, value);
+      // These are called from job threads, so the messages are only queued; wake
+      // the manager so it sends them
+      m.reactor_.wake();
     }
 
     static void send_reduce_data_to_children(
@@ -378,6 +893,7 @@ public:
       gsl::span<const PublishValueVariant> value) noexcept
     {
       m.send_reduce_data_to_children(group_id, version, reduce_tag, value);
+      m.reactor_.wake();
     }
 
     static void send_report_disconnection(
@@ -387,11 +903,13 @@ public:
       const ReductionDisconnectID disconnect_id) noexcept
     {
       m.send_report_disconnection(group_id, initiating_machine, disconnect_id);
+      m.reactor_.wake();
     }
 
     static auto rebuild_reduce_group(Manager& m, const TagID& group_id) noexcept
     {
       std::lock_guard<std::mutex> lock{m.job_mut_};
+      m.reactor_.wake();
       return m.rebuild_reduce_group(group_id);
     }
   }; // struct ReduceGroupAccessor
@@ -432,7 +950,54 @@ public:
     }
   }; // struct WaiterAccessor
 
+  // Access for the Simulator class
+  struct SimulatorAccessor {
+  private:
+    friend class Simulator;
+
+    static std::unique_ptr<Manager> create(
+      const std::uint16_t port,
+      const MachineID& id,
+      const std::chrono::milliseconds heartbeat_interval,
+      internal::Reactor& reactor,
+      internal::SimulatedLinks& links,
+      internal::JobActivity& job_activity) noexcept
+    {
+      return std::unique_ptr<Manager>{new Manager{port, id, heartbeat_interval, reactor, links, job_activity}};
+    }
+
+    static std::vector<std::thread> start_jobs(Manager& m) noexcept { return m.start_jobs(); }
+
+    static bool has_jobs(const Manager& m) noexcept { return !m.jobs_.empty(); }
+
+    static std::chrono::milliseconds process_events(Manager& m) noexcept { return m.process_events(); }
+  }; // struct SimulatorAccessor
+
 private:
+  /** \brief Constructor for instances run by a Simulator
+   *
+   * Uses the in-process transport, the simulation's clock for all timers, and
+   * a reactor shared with every other instance in the simulation.  Its jobs
+   * report to the simulation when they are blocked.
+   */
+  Manager(
+    std::uint16_t port,
+    const MachineID& id,
+    std::chrono::milliseconds heartbeat_interval,
+    internal::Reactor& reactor,
+    internal::SimulatedLinks& links,
+    internal::JobActivity& job_activity) noexcept;
+
+  /** \brief Starts a thread for each submitted job
+   */
+  std::vector<std::thread> start_jobs() noexcept;
+
+  /** \brief Does a single pass of handling everything that is ready
+   *
+   * \return How long the manager can sleep for before a timer needs servicing
+   */
+  std::chrono::milliseconds process_events() noexcept;
+
   ///////////////////////////////////////
   // Interface for ManagerHandle
   ///////////////////////////////////////
@@ -440,6 +1005,9 @@ private:
   Waiter<bool> connect_to_server(const char* const address, const std::uint16_t port) noexcept;
   Waiter<bool> connect_to_server(std::string_view address) noexcept;
   size_t number_of_neighbors() const noexcept;
+  std::vector<NeighborStats> neighbor_stats() const noexcept;
+  std::optional<AddressResolution> address_resolution(const AddrPortPair& address) const noexcept;
+  RateLimitStats total_rate_limit_stats() const noexcept;
   size_t number_of_subscribers(const internal::PublishTagBase& tag) const noexcept;
   std::uint16_t port() const noexcept;
 
@@ -465,6 +1033,40 @@ private:
    */
   void accept_pending_connections() noexcept;
 
+  /** \brief Starts a user requested connection to a resolved address if
+   * there isn't one already
+   */
+  void start_user_connection(const AddrPortPair& canonical) noexcept;
+
+  /** \brief Starts the connections and subscriptions whose addresses have
+   * finished resolving
+   */
+  void resolve_pending_addresses() noexcept;
+
+  /** \brief Returns an address with its host resolved, if it is known
+   */
+  std::optional<AddrPortPair> canonical_address(const AddrPortPair& address) const noexcept;
+
+  /** \brief Keeps how looking up a requested address went for jobs to read
+   * once their waiter returns
+   */
+  void record_resolution(
+    const AddrPortPair& requested,
+    const internal::Resolution& resolution,
+    std::chrono::steady_clock::duration latency) noexcept;
+
+  /** \brief Adds a connection that was accepted to the pending connections
+   */
+  void add_accepted_connection(std::unique_ptr<internal::Communicator> conn) noexcept;
+
+  /** \brief Starts a non-blocking connection to an address, storing the connection in conn
+   *
+   * Goes through a local socket instead if the address is on this host and
+   * one is available.
+   */
+  internal::ConnectionError start_connection(
+    std::unique_ptr<internal::Communicator>& conn, const std::string& address, std::uint16_t port) noexcept;
+
   /** \brief Listens for messages from neighbors and handles them if there
    * are any.
    */
@@ -475,8 +1077,51 @@ private:
    * \param version The message's version
    * \param tag_id The id of the tag the message is for
    * \param value The value to send
+   * \param options How to send the value to neighbors
+   * \return The number of subscribed neighbors that are behind
+   */
+  std::size_t publish(
+    const VersionID version,
+    const TagID& tag_id,
+    gsl::span<PublishValueVariant> value,
+    const PublishOptions& options) noexcept;
+
+  /** \brief Broadcast a value whose numeric vectors may be in the caller's memory
+   *
+   * The values are encoded for neighbors straight from that memory.  They are
+   * only copied if a job on this instance is subscribed to the tag, or if the
+   * options call for changes or a lossy encoding, which both need the whole
+   * value.
+   */
+  std::size_t publish_view(
+    const VersionID version,
+    const TagID& tag_id,
+    gsl::span<const internal::PublishValueView> value,
+    const PublishOptions& options) noexcept;
+
+  /** \brief Broadcast a value whose types are known at compile time
+   *
+   * Neighbors get the values written by code for their exact types.  They are
+   * only converted to variants if a job on this instance is subscribed to the
+   * tag, or if the options call for changes, which are sent against a kept copy.
    */
-  void publish(const VersionID version, const TagID& tag_id, gsl::span<PublishValueVariant> value) noexcept;
+  std::size_t publish_typed(
+    const VersionID version,
+    const TagID& tag_id,
+    const internal::PublishValueWriter& value,
+    const PublishOptions& options) noexcept;
+
+  // Returns true if any job on this instance is subscribed to the tag
+  bool has_local_subscriber(const TagID& tag_id) noexcept;
+
+  // Returns the template for publishes on the tag, giving it the next index if it's new
+  internal::PublishTemplate& publish_template(const TagID& tag_id) noexcept;
+
+  // Returns the number of subscribed neighbors whose published values are being held back
+  std::size_t neighbors_behind_on(const TagID& tag_id) const noexcept;
+
+  // Returns the total number of versions on a tag that the jobs have yet to read
+  std::size_t unread_versions(const TagID& tag_id) noexcept;
 
   // Adds data to the tag queue for a job from a message
   // Returns true if it was successful, false if something went wrong
@@ -499,11 +1144,62 @@ private:
   template<typename Callable>
   void send_to_neighbors_if(const std::vector<std::byte>& to_send, Callable condition) noexcept
   {
+    // Only copied once no matter how many neighbors it goes to
+    internal::SharedFrame frame;
     for (auto&& neighbor : neighbors_) {
-      if (condition(neighbor.second)) { neighbor.second.send_message(to_send); }
+      if (condition(neighbor.second)) {
+        if (!frame) { frame = std::make_shared<const std::vector<std::byte>>(to_send); }
+        neighbor.second.send_message(frame);
+      }
     }
   }
 
+  /** \brief Sends a message to neighbors that meet some condition, encoded
+   * with the wire features that each neighbor supports
+   *
+   * \param make_message Creates the message given a set of wire features, as
+   * either the bytes or a frame that is already shared
+   * \param published_on If set, the message is a value published on this tag
+   * and replaces any value on it that a neighbor hasn't been sent yet
+   * \param tag_index The index the published value names its tag by
+   */
+  template<typename MakeMessage, typename Callable>
+  void send_encoded_to_neighbors_if(
+    const MakeMessage& make_message,
+    Callable condition,
+    const TagID* published_on = nullptr,
+    const std::uint32_t tag_index = 0) noexcept
+  {
+    // Each encoding is only created and compressed once no matter how many neighbors it goes to
+    // Kept between calls so that its storage is reused
+    auto& frames = encoded_frames_;
+    for (auto&& neighbor : neighbors_) {
+      if (!condition(neighbor.second)) { continue; }
+      const auto features = neighbor.second.frame_features();
+      auto iter = std::find_if(frames.begin(), frames.end(), [&](const auto& f) { return f.first == features; });
+      if (iter == frames.end()) {
+        internal::SharedFrame frame;
+        if constexpr (std::is_convertible_v<decltype(make_message(features)), internal::SharedFrame>) {
+          frame = make_message(features);
+        }
+        else {
+          frame = std::make_shared<const std::vector<std::byte>>(make_message(features));
+        }
+        frames.emplace_back(features, neighbor.second.prepare_frame(std::move(frame)));
+        iter = std::prev(frames.end());
+      }
+      if (published_on != nullptr) { neighbor.second.send_prepared_publish(*published_on, tag_index, iter->second); }
+      else {
+        neighbor.second.send_prepared_frame(iter->second);
+      }
+    }
+    frames.clear();
+  }
+
+  /** \brief Writes queued messages to every neighbor whose batch is due
+   */
+  void flush_neighbor_send_queues() noexcept;
+
   /** \brief Broadcasts a message to all neighbors
    */
   void send_to_neighbors(const std::vector<std::byte>& to_send) noexcept;
@@ -519,15 +1215,31 @@ private:
    */
   Waiter<bool> ip_subscribe(const AddrPortPair& addr, const std::vector<TagID>& tag_ids) noexcept;
 
+  /** \brief Subscribes to tags on an address that has been resolved
+   *
+   * \return True if the address is this instance
+   */
+  bool ip_subscribe_resolved(const AddrPortPair& canonical_addr, const std::vector<TagID>& tag_ids) noexcept;
+
   /** \brief Handles the get_publishers message
    */
   void handle_get_publishers(const internal::GetPublishers& msg, internal::ExternalManager& from) noexcept;
 
   /** \brief Removes any tags that have enough publishers, returning the tags that
    * remain and the number of publishers that they need
+   *
+   * The tags are views into the message and the vectors are allocated from
+   * the arena for this pass through the loop.
    */
   auto remove_tags_with_enough_publishers(const internal::GetPublishers& msg) noexcept
-    -> std::pair<std::vector<TagID>, std::vector<std::uint8_t>>;
+    -> std::pair<std::pmr::vector<std::string_view>, std::pmr::vector<std::uint8_t>>;
+
+  /** \brief Returns a tag ID with the contents of a view, for looking up tags
+   *
+   * The same string is reused so that lookups don't allocate; the returned
+   * reference is only valid until the next call.
+   */
+  const TagID& lookup_key(std::string_view tag) noexcept;
 
   /** \brief Adds the publishers and propagate the information is required
    *
@@ -573,7 +1285,30 @@ private:
    * the array if not present
    */
   void reduce_send_data_and_remove_missing(
-    std::vector<MachineID>& machines, const std::vector<std::byte>& message) noexcept;
+    std::vector<MachineID>& machines, const internal::SharedFrame& message) noexcept;
+
+  /** \brief Where a queued reduce message goes within its group
+   */
+  enum class ReduceDestination
+  {
+    parent,
+    children,
+    parent_and_children
+  };
+
+  /** \brief Queues a message for the machines of a reduce group
+   *
+   * Reduce groups send from job threads, which hold the group's buffer mutex
+   * but not job_mut_, so they can't touch the neighbors.  Taking job_mut_
+   * there would invert the order it is taken in by the manager thread when
+   * adding data to a group, so the messages are sent by process_events instead.
+   */
+  void queue_reduce_message(
+    const TagID& group_id, ReduceDestination destination, std::vector<std::byte> message) noexcept;
+
+  /** \brief Sends the messages queued by queue_reduce_message
+   */
+  void send_queued_reduce_messages() noexcept;
 
   /** \brief Sends a value for a reduce to the corresponding parents
    */
@@ -655,8 +1390,12 @@ private:
   bool subscription_tags_are_produced(const internal::SubscriptionNotice& msg) const noexcept;
 
   /** \brief Handles published information
+   *
+   * \param tag_id The tag the message was published on, which it may only
+   * name by index
    */
-  bool handle_publish_data(const internal::PublishData& msg, const internal::ExternalManager& from) noexcept;
+  bool handle_publish_data(
+    const internal::PublishData& msg, const TagID& tag_id, internal::ExternalManager& from) noexcept;
 
   /** \brief Finalizes a subscription connection.
    *
@@ -672,8 +1411,44 @@ private:
    */
   std::vector<TagID> local_tags() const noexcept;
 
-  // For listening to connection requests
-  internal::SocketCommunicator server_socket_;
+  /** \brief Returns how long the manager thread can sleep before a timer
+   * (heartbeats or tag request backoff) needs servicing
+   */
+  std::chrono::milliseconds time_until_next_timer() const noexcept;
+
+  // Null for simulated instances, which share the simulation's reactor
+  std::unique_ptr<internal::Reactor> owned_reactor_;
+
+  // Wakes the manager thread on socket readiness or requests from jobs
+  // Declared before any sockets so that it outlives them
+  internal::Reactor& reactor_;
+
+  // Source of the time for all timers
+  const internal::Clock& clock_;
+
+  // Delays in-process frames; only set for simulated instances
+  internal::SimulatedLinks* links_ = nullptr;
+
+  // Set when run by a Simulator, which needs to know when all jobs are blocked
+  internal::JobActivity* job_activity_ = nullptr;
+
+  // Looks up host names off of the manager thread
+  internal::AddressResolver resolver_{reactor_};
+
+  // How other instances are reached
+  ManagerTransport transport_;
+
+  // For listening to connection requests; only used with the network transport
+  std::optional<internal::SocketCommunicator> server_socket_;
+
+  // For listening to connection requests from the same host
+  std::optional<internal::SocketCommunicator> local_server_socket_;
+
+  // For listening to connection requests from within the process
+  internal::InProcessListener in_process_listener_;
+
+  // The name that local_server_socket_ listens on; empty if it couldn't listen
+  std::string local_socket_name_;
 
   // List of the jobs that are present
   std::unordered_map<JobID, Job> jobs_;
@@ -681,8 +1456,8 @@ private:
   // List of neighboring connections
   std::unordered_map<MachineID, internal::ExternalManager> neighbors_;
 
-  // List of publishers that are known for each tag
-  std::unordered_map<TagID, std::unordered_set<internal::PublisherInfo>> publishers_for_tag_;
+  // List of publishers that are known for each tag, keyed by tag_symbols_
+  internal::FlatIdMap<std::unordered_set<internal::PublisherInfo>> publishers_for_tag_;
 
   // A list of tags that still need to have publishers found
   std::vector<std::string> pending_tags_;
@@ -701,12 +1476,43 @@ private:
   };
   std::unordered_map<TagID, ReduceGroupData> reduce_tag_data_;
 
+  struct QueuedReduceMessage {
+    TagID group_id;
+    ReduceDestination destination;
+    internal::SharedFrame message;
+  };
+  // Messages queued by reduce groups; the mutex is only held to add to or swap the list
+  MutexGuarded<std::vector<QueuedReduceMessage>> reduce_outbox_;
+  // Swapped with the outbox when sending so neither has to reallocate
+  std::vector<QueuedReduceMessage> reduce_messages_to_send_;
+
   // The id of this machine
   MachineID id_;
 
   // The time to send a heartbeat if nothing has been heard in the time
   std::chrono::milliseconds heartbeat_interval_;
 
+  // How messages to neighbors are batched
+  TransportOptions transport_options_;
+
+  // Limits the published values sent to all neighbors together
+  // Every neighbor's flush draws on it, so it is only used with job_mut_ held or
+  // on the manager thread; reduce groups queue their messages for this reason
+  internal::RateLimiter total_rate_limiter_;
+
+  // Keeps the buffers and sizes of the messages for each tag that is published on
+  // Only grows, so that the index given to each tag is never reused
+  std::unordered_map<TagID, internal::PublishTemplate> publish_templates_;
+
+  // The encodings made by send_encoded_to_neighbors_if
+  std::vector<std::pair<internal::WireFeatures, internal::SharedFrame>> encoded_frames_;
+
+  // Memory for things that only live for one pass through process_events
+  internal::TickArena tick_arena_;
+
+  // Reused by lookup_key
+  TagID lookup_key_;
+
   // Only allow one job access to the manager at a time
   mutable std::mutex job_mut_;
 
@@ -719,10 +1525,15 @@ private:
   // is received
   // TODO: Maybe move to pointers and just make sure to remove them when the neighbor is removed?
   // Also potentially combine with tag_to_machine_ since they are tags into the same thing
-  std::unordered_map<TagID, std::unordered_set<MachineID>> send_publisher_information_to_;
+  // Keyed by tag_symbols_
+  internal::FlatIdMap<std::unordered_set<MachineID>> send_publisher_information_to_;
+
+  // Symbols for the tags that key the tables looked up on every pass, so that
+  // they are found by an integer instead of by hashing and comparing strings
+  internal::SymbolTable tag_symbols_;
 
   // The tags that this machine produces and the self-subscription count
-  std::unordered_map<TagID, int> self_sub_count_;
+  internal::FlatIdMap<int> self_sub_count_;
 
   // The port used for communications
   std::uint16_t port_;
@@ -731,11 +1542,14 @@ private:
   // This is also used for testing that a connection has completed
   std::unordered_map<AddrPortPair, internal::ExternalManager*> addr_to_machine_;
 
+  // Local socket names advertised by neighbors on the same host, by their address
+  std::unordered_map<AddrPortPair, std::string> local_socket_names_;
+
   // Mapping from a tag to the ID used for the subscription to the tag
   // Used to know when a subscription is done and for if multiple jobs
   // subscribe to the same tag
   // This is also use to mark when a pending connection is for a tag
-  std::unordered_map<TagID, internal::ExternalManager*> tag_to_machine_;
+  internal::FlatIdMap<internal::ExternalManager*> tag_to_machine_;
 
   /** \brief Connection status for pending connections
    */
@@ -758,13 +1572,27 @@ private:
   static const char* to_c_str(ConnType type) noexcept;
   // Pending connections for all types
   struct PendingInfo {
-    internal::SocketCommunicator conn;
+    std::unique_ptr<internal::Communicator> conn;
     ConnStatus status;
     ConnType type;
     std::string tag;
+    // Anything received past the greeting is handed to the neighbor with the connection
+    internal::ReceiveBuffer received;
   };
   std::unordered_map<AddrPortPair, PendingInfo> pending_conns_;
 
+  // Connections and IP subscriptions waiting for their address to be resolved
+  struct PendingResolution {
+    AddrPortPair address;
+    ConnType type;
+    std::vector<TagID> tags;
+    std::chrono::steady_clock::time_point started;
+  };
+  std::vector<PendingResolution> pending_resolutions_;
+
+  // How the lookups for requested addresses went, by the address as requested
+  std::unordered_map<AddrPortPair, AddressResolution> address_resolutions_;
+
   // Notification for when new subscriptions are created
   std::condition_variable subscription_cv_;
 
@@ -794,6 +1622,19 @@ public:
     return handle_->connect_to_server(address, port);
   }
 
+  /** \brief Returns how looking up the host of a connection or IP subscription
+   * went, once it has finished
+   *
+   * Tells a job whose waiter returned false whether the host couldn't be found
+   * and why, and how long the lookup took either way.  Empty while the lookup
+   * is still going or if the address was never requested.
+   */
+  std::optional<AddressResolution>
+    address_resolution(const char* const address, const std::uint16_t port) const noexcept
+  {
+    return handle_->address_resolution(AddrPortPair{address, port});
+  }
+
   /** \brief Connects to another instance with the address:port format
    */
   Waiter<bool> connect_to_server(std::string_view address) noexcept
@@ -805,6 +1646,14 @@ public:
    */
   int number_of_neighbors() const noexcept { return handle_->number_of_neighbors(); }
 
+  /** \brief Returns the current state of the connection to each neighbor
+   */
+  std::vector<NeighborStats> neighbor_stats() const noexcept { return handle_->neighbor_stats(); }
+
+  /** \brief Returns the counters for the values sent under the limit on all neighbors together
+   */
+  RateLimitStats total_rate_limit_stats() const noexcept { return handle_->total_rate_limit_stats(); }
+
   /** \brief Returns the id of the manager
    */
   const std::string& id() const noexcept { return handle_->id(); }
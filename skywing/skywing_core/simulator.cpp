@@ -0,0 +1,74 @@
+#include "skywing_core/simulator.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace skywing {
+namespace {
+// How often to check on jobs that are running without waking the reactor
+constexpr std::chrono::milliseconds running_job_poll{100};
+} // namespace
+
+LatencyModel constant_latency(const std::chrono::nanoseconds latency) noexcept
+{
+  return [latency](std::uint16_t, std::uint16_t, std::size_t) noexcept { return latency; };
+}
+
+LatencyModel bandwidth_latency(const std::chrono::nanoseconds latency, const double bytes_per_second) noexcept
+{
+  return [latency, bytes_per_second](std::uint16_t, std::uint16_t, const std::size_t bytes) noexcept {
+    const std::chrono::duration<double> transmit{static_cast<double>(bytes) / bytes_per_second};
+    return latency + std::chrono::duration_cast<std::chrono::nanoseconds>(transmit);
+  };
+}
+
+Simulator::Simulator(LatencyModel latency) noexcept : links_{clock_, std::move(latency)}, job_activity_{reactor_} {}
+
+Manager& Simulator::add_manager(
+  const std::uint16_t port, const MachineID& id, const std::chrono::milliseconds heartbeat_interval) noexcept
+{
+  managers_.push_back(
+    Manager::SimulatorAccessor::create(port, id, heartbeat_interval, reactor_, links_, job_activity_));
+  return *managers_.back();
+}
+
+void Simulator::run() noexcept
+{
+  std::vector<std::thread> threads;
+  for (auto& manager : managers_) {
+    for (auto& thread : Manager::SimulatorAccessor::start_jobs(*manager)) {
+      threads.push_back(std::move(thread));
+    }
+  }
+  while (true) {
+    auto next_event = internal::Clock::time_point::max();
+    bool any_running = false;
+    for (auto& manager : managers_) {
+      if (!Manager::SimulatorAccessor::has_jobs(*manager)) { continue; }
+      any_running = true;
+      next_event = std::min(next_event, clock_.now() + Manager::SimulatorAccessor::process_events(*manager));
+    }
+    if (!any_running) { break; }
+    // Something is already due, or a job or connection did something that needs handling
+    if (next_event <= clock_.now() || reactor_.wait(std::chrono::milliseconds{0})) { continue; }
+    // Jobs that are running may still do something at the current time; they
+    // wake the reactor when they block or finish, so this only waits that long
+    // if a job keeps running without touching its instance
+    if (!job_activity_.all_blocked()) {
+      reactor_.wait(running_job_poll);
+      continue;
+    }
+    if (const auto delivery = links_.next_delivery()) { next_event = std::min(next_event, *delivery); }
+    clock_.advance_to(next_event);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+std::chrono::nanoseconds Simulator::elapsed() const noexcept
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_.now().time_since_epoch());
+}
+} // namespace skywing
@@ -0,0 +1,98 @@
+#ifndef SKYNET_SIMULATOR_HPP
+#define SKYNET_SIMULATOR_HPP
+
+#include "skywing_core/internal/devices/reactor.hpp"
+#include "skywing_core/internal/devices/simulated_links.hpp"
+#include "skywing_core/internal/job_activity.hpp"
+#include "skywing_core/internal/utility/clock.hpp"
+#include "skywing_core/manager.hpp"
+#include "skywing_core/types.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace skywing {
+/** \brief How long a frame takes to get from one instance to another
+ *
+ * Called with the ports of the sending and receiving instances and the size of
+ * the frame in bytes.  May be called from any thread.
+ */
+using LatencyModel = internal::LatencyModel;
+
+/** \brief Returns a latency model where every frame takes the same time
+ */
+LatencyModel constant_latency(std::chrono::nanoseconds latency) noexcept;
+
+/** \brief Returns a latency model with a fixed delay plus the time to transmit
+ * the frame at a given bandwidth
+ */
+LatencyModel bandwidth_latency(std::chrono::nanoseconds latency, double bytes_per_second) noexcept;
+
+/** \brief Runs many Manager instances in one process on a virtual clock
+ *
+ * Every instance uses the in-process transport, with frames delayed by the
+ * latency model, and all of their timers (heartbeats, batching, tag request
+ * backoff) follow the virtual clock.  A single thread handles the events of
+ * every instance, one pass over them at a time; once nothing is left to do at
+ * the current time the clock jumps to the next timer or frame delivery, so
+ * idle time costs nothing.
+ *
+ * Jobs still run on their own threads, one for each job.  The clock is only
+ * moved once every job is blocked in a waiter that can't be ready until an
+ * instance handles an event, so how the host schedules the threads doesn't
+ * change what happens at each point in virtual time.  A job that blocks on
+ * anything else, such as its own mutexes or a timed wait, holds the clock
+ * still until it is back in a waiter or finishes.
+ *
+ * Instances are addressed as 127.0.0.1 and the port they were added with.
+ */
+class Simulator {
+public:
+  /** \brief Creates an empty simulation
+   *
+   * \param latency The delay for each frame
+   */
+  explicit Simulator(LatencyModel latency = constant_latency(std::chrono::milliseconds{1})) noexcept;
+
+  // Can not be copied or moved; instances refer to it
+  Simulator(const Simulator&) = delete;
+  Simulator& operator=(const Simulator&) = delete;
+
+  /** \brief Adds an instance to the simulation
+   *
+   * Jobs are submitted to the returned Manager as usual, but it must not be
+   * run directly; run() runs every instance.  Exits the program if the port is
+   * already in use by another in-process instance.
+   *
+   * \param port The port to listen on
+   * \param id The ID to assign to the instance
+   * \param heartbeat_interval The interval to wait between heartbeats, in virtual time
+   */
+  Manager& add_manager(
+    std::uint16_t port,
+    const MachineID& id,
+    std::chrono::milliseconds heartbeat_interval = internal::default_heartbeat_interval) noexcept;
+
+  /** \brief Runs every instance until all of their jobs have finished
+   */
+  void run() noexcept;
+
+  /** \brief Returns how much virtual time has passed
+   */
+  std::chrono::nanoseconds elapsed() const noexcept;
+
+private:
+  internal::VirtualClock clock_;
+  // Shared by all instances as only one thread waits on it
+  internal::Reactor reactor_;
+  internal::SimulatedLinks links_;
+  internal::JobActivity job_activity_;
+
+  // Declared last so the instances are destroyed first
+  std::vector<std::unique_ptr<Manager>> managers_;
+}; // class Simulator
+} // namespace skywing
+
+#endif // SKYNET_SIMULATOR_HPP
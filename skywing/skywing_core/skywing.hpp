@@ -5,6 +5,7 @@
 #include "enable_logging.hpp"
 #include "job.hpp"
 #include "manager.hpp"
+#include "simulator.hpp"
 #include "types.hpp"
 #include "waiter.hpp"
 
@@ -31,6 +31,29 @@ using NetworkSizeType = std::uint32_t;
 /// The type used for disconnection notifications in reduce groups
 using ReductionDisconnectID = std::uint64_t;
 
+/** \brief Lossy encodings that vectors of floating point values can be sent with
+ *
+ * Each trades precision for size on the wire; receivers get back vectors of
+ * the published type.  Values that an encoding can't represent, such as
+ * infinities for the scaled encodings, cause the vector to be sent exactly.
+ */
+enum class Quantization : std::uint8_t {
+  /// Sent exactly
+  none,
+
+  /// IEEE half precision: 2 bytes, 11 significant bits, finite magnitudes below 65520
+  float16,
+
+  /// The upper half of a float: 2 bytes, 8 significant bits, the range of a float
+  bfloat16,
+
+  /// 1 byte, 255 evenly spaced levels between the smallest and largest element of each vector
+  scaled_int8,
+
+  /// 2 bytes, 65535 evenly spaced levels between the smallest and largest element of each vector
+  scaled_int16
+};
+
 /// A typelist of all the types that can be published
 using PublishValueTypeList = internal::TypeList<
   float,
@@ -7,6 +7,7 @@
 #include <optional>
 #include <type_traits>
 
+#include "skywing_core/internal/job_activity.hpp"
 #include "skywing_core/types.hpp"
 #include <iostream>
 namespace skywing {
@@ -162,6 +163,8 @@ public:
       
     std::unique_lock<std::mutex> lock{**mutex_};
     if (!is_ready_no_lock()) {
+      // Lets a simulation know this job can't continue until the waiter is ready
+      const internal::JobActivity::BlockedWaiter blocked{**mutex_, *is_ready_callable_};
       (*cv_)->wait(lock, [this]() noexcept { return is_ready_no_lock(); });
     }
     return get_value_callable_();
@@ -174,10 +177,14 @@ public:
     if (is_instant()) return;
     std::unique_lock<std::mutex> lock{**mutex_};
     if (is_ready_no_lock()) { return; }
+    const internal::JobActivity::BlockedWaiter blocked{**mutex_, *is_ready_callable_};
     (*cv_)->wait(lock, [this]() noexcept { return is_ready_no_lock(); });
   }
 
   /** @brief Block until ready or a given amount of time passes, whichever is first.
+   *
+   * The time is real time, even for instances run by a Simulator, which keep
+   * their clock still while a job waits like this.
    */
   template<class Rep, class Period>
   bool wait_for(const std::chrono::duration<Rep, Period>& wait_time) noexcept
@@ -3,6 +3,11 @@
 
 #include "skywing_core/types.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <typeinfo>
+
 namespace skywing
 {
   // template metaprogramming structs
@@ -45,6 +50,34 @@ namespace skywing
   };
   template<typename T>
   using IsPubSubType_v = typename IsPubSubType<T>::value;
+
+  /*********************************************************************
+   * @brief Checks if a type can be sent as its raw bytes.
+   *
+   * That is a trivially copyable, default constructible class that
+   * Skywing doesn't send natively and that isn't a tuple.
+   *********************************************************************/
+  template<typename T>
+  inline constexpr bool IsRawBytesCandidate_v =
+    std::is_class_v<T> && std::is_trivially_copyable_v<T>
+    && std::is_default_constructible_v<T> && !IsTuple_v<T>
+    && !IsNativeToSkywing_v<T>;
+
+  /*********************************************************************
+   * @brief Checks if a type is converted by the raw bytes
+   * PubSubConverter, rather than one written for it.
+   *********************************************************************/
+  template<typename T, typename = void>
+  struct HasRawBytesConverter : std::false_type {};
+
+  template<typename T>
+  struct HasRawBytesConverter<T, std::void_t<decltype(PubSubConverter<T>::is_raw_bytes)>>
+    : std::bool_constant<PubSubConverter<T>::is_raw_bytes> {};
+
+  // Only looks at the converter for types that could have the raw bytes one
+  template<typename T>
+  inline constexpr bool IsRawBytesPubSub_v =
+    std::conjunction_v<std::bool_constant<IsRawBytesCandidate_v<T>>, HasRawBytesConverter<T>>;
     
   /*********************************************************************
    * @brief Get the number of tuple elements, after conversion to
@@ -85,6 +118,36 @@ namespace skywing
 
   // functions for use during conversion
 
+  /** @brief A hash of the name, size and alignment of a type sent as
+   * raw bytes, so that a receiver can tell if the sender's type is
+   * laid out differently.
+   *
+   * Type names differ between compilers, so both ends need to be
+   * built with the same one. Fields of the same sizes that have been
+   * reordered aren't caught.
+   */
+  template<typename T>
+  std::uint64_t raw_bytes_layout_hash()
+  {
+    static const std::uint64_t hash = []
+    {
+      // FNV-1a
+      std::uint64_t to_ret = 14695981039346656037ull;
+      const auto mix = [&](const unsigned char byte)
+      {
+        to_ret ^= byte;
+        to_ret *= 1099511628211ull;
+      };
+      for (const char* c = typeid(T).name(); *c != '\0'; ++c)
+        mix(static_cast<unsigned char>(*c));
+      for (const std::uint64_t value : {std::uint64_t{sizeof(T)}, std::uint64_t{alignof(T)}})
+        for (std::size_t i = 0; i < sizeof(value); ++i)
+          mix(static_cast<unsigned char>(value >> (8 * i)));
+      return to_ret;
+    }();
+    return hash;
+  }
+
   /** @brief Convert an object of type S to pubsub type and, if the
    *  result is not a tuple, wrap it in a tuple of length 1.
    */
@@ -1,9 +1,14 @@
 #ifndef SKYNET_PUBSUB_CONVERTER_HPP
 #define SKYNET_PUBSUB_CONVERTER_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
 #include <tuple>
 #include <utility>
 #include <type_traits>
+#include <vector>
 #include "skywing_core/types.hpp"
 #include "skywing_mid/internal/iterative_helpers.hpp"
 
@@ -361,7 +366,8 @@ namespace skywing
     std::vector<T>,
     std::enable_if_t<!IsNativeToSkywing_v<std::vector<T>>
                      && !IsTuple_v<T>
-                     && !IsSpecialization_v<T, std::vector>>>
+                     && !IsSpecialization_v<T, std::vector>
+                     && !IsRawBytesPubSub_v<T>>>
   {
     using input_type = std::vector<T>;
     using before_final_t = std::vector<PubSub_t<T>>;
@@ -386,6 +392,73 @@ namespace skywing
   }; // struct PubSubConverter<std::vector<T>>
 
 
+  /** @brief PubSubConverter specialization for trivially copyable
+   * structs that don't have a converter of their own.
+   *
+   * The object is sent as its bytes following a hash of its type's
+   * layout, so both conversions are a single memcpy. The hash is
+   * checked on deconversion, but both ends still have to agree on the
+   * layout and byte order, as they do when running the same build. A
+   * specialization written for the type is used instead of this one.
+   */
+  template<typename T>
+  struct PubSubConverter<T, std::enable_if_t<IsRawBytesCandidate_v<T>>>
+  {
+    static constexpr bool is_raw_bytes = true;
+    using input_type = T;
+    using pubsub_type = std::tuple<std::uint64_t, std::vector<std::byte>>;
+
+    static pubsub_type convert(const T& input)
+    {
+      std::vector<std::byte> bytes(sizeof(T));
+      std::memcpy(bytes.data(), &input, sizeof(T));
+      return pubsub_type(raw_bytes_layout_hash<T>(), std::move(bytes));
+    }
+
+    static input_type deconvert(const pubsub_type& ps_input)
+    {
+      const auto& bytes = std::get<1>(ps_input);
+      if (std::get<0>(ps_input) != raw_bytes_layout_hash<T>() || bytes.size() != sizeof(T))
+        throw std::runtime_error("PubSubConverter: Received the bytes of a type with a different layout.");
+      T to_ret;
+      std::memcpy(&to_ret, bytes.data(), sizeof(T));
+      return to_ret;
+    }
+  }; // struct PubSubConverter<T> for trivially copyable T
+
+  /** @brief PubSubConverter specialization for vectors of structs
+   * that are sent as raw bytes.
+   *
+   * The elements are sent as one block of bytes, rather than being
+   * converted one at a time.
+   */
+  template<typename T>
+  struct PubSubConverter<std::vector<T>, std::enable_if_t<IsRawBytesPubSub_v<T>>>
+  {
+    using input_type = std::vector<T>;
+    using pubsub_type = std::tuple<std::uint64_t, std::vector<std::byte>>;
+
+    static pubsub_type convert(const input_type& input)
+    {
+      std::vector<std::byte> bytes(input.size() * sizeof(T));
+      if (!input.empty())
+        std::memcpy(bytes.data(), input.data(), bytes.size());
+      return pubsub_type(raw_bytes_layout_hash<T>(), std::move(bytes));
+    }
+
+    static input_type deconvert(const pubsub_type& ps_input)
+    {
+      const auto& bytes = std::get<1>(ps_input);
+      if (std::get<0>(ps_input) != raw_bytes_layout_hash<T>() || bytes.size() % sizeof(T) != 0)
+        throw std::runtime_error("PubSubConverter: Received the bytes of a type with a different layout.");
+      input_type to_ret(bytes.size() / sizeof(T));
+      if (!to_ret.empty())
+        std::memcpy(to_ret.data(), bytes.data(), bytes.size());
+      return to_ret;
+    }
+  }; // struct PubSubConverter<std::vector<T>> for trivially copyable T
+
+
   
   // struct Colin { int c; };
     
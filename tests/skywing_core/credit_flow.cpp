@@ -0,0 +1,129 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/skywing.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace skywing;
+
+// In-process ports don't need to be free for sockets
+constexpr std::uint16_t base_port = 20200;
+constexpr std::size_t credit_window = 8;
+// Far more than the window, so that running out of credits is the only way to stop
+constexpr std::int32_t max_publishes = 10'000;
+constexpr std::int32_t num_rounds = 4;
+
+namespace {
+std::size_t send_credits_to(const ManagerHandle& handle, const MachineID& id)
+{
+  const auto stats = handle.neighbor_stats();
+  const auto iter
+    = std::find_if(stats.cbegin(), stats.cend(), [&](const NeighborStats& neighbor) { return neighbor.id == id; });
+  return iter == stats.cend() ? 0 : iter->send_credits;
+}
+} // namespace
+
+TEST_CASE("Publishers are held back until subscribers read", "[Skywing_CreditFlow]")
+{
+  const PublishTag<std::int32_t> values_tag{"values"};
+  const PublishTag<std::int32_t> resume_tag{"resume"};
+  const PublishTag<std::int32_t> ack_tag{"ack"};
+  Simulator simulator;
+  auto& publisher = simulator.add_manager(base_port, "publisher");
+  auto& subscriber = simulator.add_manager(base_port + 1, "subscriber");
+  TransportOptions options;
+  options.credit_window = credit_window;
+  publisher.set_transport_options(options);
+  subscriber.set_transport_options(options);
+  static std::mutex catch_mutex;
+  publisher.submit_job("job", [&](Job& job, ManagerHandle handle) {
+    job.declare_publication_intent(values_tag);
+    job.declare_publication_intent(resume_tag);
+    job.subscribe(ack_tag).get();
+    handle
+      .waiter_on_subscription_change([&]() {
+        return handle.number_of_subscribers(values_tag) > 0 && handle.number_of_subscribers(resume_tag) > 0;
+      })
+      .wait();
+    const auto wait_for_ack = [&](const std::int32_t expected) {
+      while (true) {
+        const auto ack = job.get_waiter(ack_tag).get();
+        if (!ack || *ack == expected) { return; }
+      }
+    };
+
+    // Once the subscriber has read a value it stops, so values it hasn't read
+    // use up its credits and nothing more is sent
+    job.publish(values_tag, 0);
+    wait_for_ack(0);
+    std::int32_t published = 0;
+    std::size_t behind = 0;
+    while (behind == 0 && published < max_publishes) {
+      ++published;
+      behind = job.publish_with_backpressure(values_tag, published);
+    }
+    {
+      std::lock_guard lock{catch_mutex};
+      REQUIRE(behind == 1);
+      // The first values were sent under the credits granted after the read
+      REQUIRE(published > 1);
+      // Reported as soon as the queued value would take the last credit, before
+      // the manager has sent it
+      REQUIRE(send_credits_to(handle, "subscriber") <= 1);
+    }
+
+    job.publish(resume_tag, published);
+    wait_for_ack(published);
+
+    // Reading again frees up the window, so values go out without waiting
+    for (std::int32_t round = 1; round <= num_rounds; ++round) {
+      behind = job.publish_with_backpressure(values_tag, published + round);
+      wait_for_ack(published + round);
+    }
+    std::lock_guard lock{catch_mutex};
+    REQUIRE(behind == 0);
+    REQUIRE(send_credits_to(handle, "subscriber") > 1);
+  });
+  subscriber.submit_job("job", [&](Job& job, ManagerHandle handle) {
+    while (!handle.connect_to_server("127.0.0.1", base_port).get()) {}
+    job.declare_publication_intent(ack_tag);
+    job.subscribe(values_tag, resume_tag).get();
+    handle.waiter_on_subscription_change([&]() { return handle.number_of_subscribers(ack_tag) > 0; }).wait();
+
+    const auto first = job.get_waiter(values_tag).get();
+    {
+      std::lock_guard lock{catch_mutex};
+      REQUIRE(first);
+      REQUIRE(*first == 0);
+    }
+    job.publish(ack_tag, 0);
+
+    // Doesn't read any more values until told to
+    const auto last_published = job.get_waiter(resume_tag).get();
+    {
+      std::lock_guard lock{catch_mutex};
+      REQUIRE(last_published);
+    }
+    // One more value is always let through, so the latest one still arrives
+    const auto latest = job.get_waiter(values_tag).get();
+    {
+      std::lock_guard lock{catch_mutex};
+      REQUIRE(latest);
+      REQUIRE(*latest == *last_published);
+    }
+    job.publish(ack_tag, *last_published);
+
+    for (std::int32_t round = 1; round <= num_rounds; ++round) {
+      const auto expected = *last_published + round;
+      while (true) {
+        const auto value = job.get_waiter(values_tag).get();
+        if (!value || *value == expected) { break; }
+      }
+      job.publish(ack_tag, expected);
+    }
+  });
+  simulator.run();
+}
@@ -0,0 +1,88 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/skywing.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace skywing;
+
+// In-process ports don't need to be free for sockets
+constexpr std::uint16_t base_port = 20100;
+constexpr std::size_t vector_size = 1000;
+// Enough to go through several whole values
+constexpr std::int32_t num_iterations = 40;
+constexpr std::uint32_t full_value_interval = 8;
+
+namespace {
+NeighborStats stats_for(const ManagerHandle& handle, const MachineID& id)
+{
+  const auto stats = handle.neighbor_stats();
+  const auto iter
+    = std::find_if(stats.cbegin(), stats.cend(), [&](const NeighborStats& neighbor) { return neighbor.id == id; });
+  return iter == stats.cend() ? NeighborStats{} : *iter;
+}
+} // namespace
+
+// Changes a few elements, as an iterative solver close to converging would
+void update(std::vector<double>& values, const std::int32_t iteration)
+{
+  for (std::size_t i = 0; i < 3; ++i) {
+    values[(static_cast<std::size_t>(iteration) * 37 + i * 101) % vector_size] += 0.5;
+  }
+}
+
+TEST_CASE("Vectors published as changes arrive whole", "[Skywing_DeltaPublish]")
+{
+  const PublishTag<std::vector<double>, std::int32_t> values_tag{"values", DeltaEncoding{full_value_interval}};
+  const PublishTag<std::int32_t> ack_tag{"ack"};
+  Simulator simulator;
+  static std::mutex catch_mutex;
+  auto& publisher = simulator.add_manager(base_port, "publisher");
+  auto& subscriber = simulator.add_manager(base_port + 1, "subscriber");
+  // Each job waits in the simulation for the other to subscribe; waiting on
+  // each other directly would keep the clock still
+  publisher.submit_job("job", [&](Job& job, ManagerHandle handle) {
+    job.declare_publication_intent(values_tag);
+    job.subscribe(ack_tag).get();
+    handle.waiter_on_subscription_change([&]() { return handle.number_of_subscribers(values_tag) > 0; }).wait();
+    std::vector<double> values(vector_size, 1.0);
+    for (std::int32_t i = 0; i < num_iterations; ++i) {
+      update(values, i);
+      job.publish(values_tag, values, i);
+      // Every value has to be seen, so wait until it has been before changing it again
+      while (true) {
+        const auto ack = job.get_waiter(ack_tag).get();
+        if (!ack || *ack == i) { break; }
+      }
+      // The first value and every one after full_value_interval changes go out whole
+      const auto sent = static_cast<std::size_t>(i) + 1;
+      const auto expected_whole = static_cast<std::size_t>(i) / (full_value_interval + 1) + 1;
+      const auto stats = stats_for(handle, "subscriber");
+      std::lock_guard lock{catch_mutex};
+      REQUIRE(stats.publishes_sent_whole == expected_whole);
+      REQUIRE(stats.publishes_sent_as_changes == sent - expected_whole);
+    }
+  });
+  subscriber.submit_job("job", [&](Job& job, ManagerHandle handle) {
+    while (!handle.connect_to_server("127.0.0.1", base_port).get()) {}
+    job.declare_publication_intent(ack_tag);
+    job.subscribe(values_tag).get();
+    handle.waiter_on_subscription_change([&]() { return handle.number_of_subscribers(ack_tag) > 0; }).wait();
+    std::vector<double> expected(vector_size, 1.0);
+    for (std::int32_t i = 0; i < num_iterations; ++i) {
+      update(expected, i);
+      const auto value = job.get_waiter(values_tag).get();
+      {
+        std::lock_guard lock{catch_mutex};
+        REQUIRE(value);
+        REQUIRE(std::get<1>(*value) == i);
+        REQUIRE(std::get<0>(*value) == expected);
+      }
+      job.publish(ack_tag, i);
+    }
+  });
+  simulator.run();
+}
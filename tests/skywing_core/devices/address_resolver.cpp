@@ -0,0 +1,46 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/devices/address_resolver.hpp"
+#include "skywing_core/internal/devices/reactor.hpp"
+
+#include <chrono>
+
+using namespace skywing::internal;
+
+TEST_CASE("Address resolver handles numeric addresses immediately", "[Skywing_AddressResolver]")
+{
+  REQUIRE(AddressResolver::resolve_numeric("10.1.2.3") == "10.1.2.3");
+  REQUIRE(AddressResolver::resolve_numeric("localhost") == "127.0.0.1");
+  REQUIRE(!AddressResolver::resolve_numeric("example.invalid"));
+  REQUIRE(!AddressResolver::resolve_numeric("10.1.2"));
+
+  Reactor reactor;
+  AddressResolver resolver{reactor};
+  const auto resolution = resolver.resolve("127.0.0.1");
+  REQUIRE(resolution.status == Resolution::Status::resolved);
+  REQUIRE(resolution.address == "127.0.0.1");
+  REQUIRE(resolver.cached("localhost") == "127.0.0.1");
+}
+
+TEST_CASE("Address resolver reports failed lookups without blocking", "[Skywing_AddressResolver]")
+{
+  using namespace std::chrono_literals;
+  Reactor reactor;
+  AddressResolver resolver{reactor};
+  // The .invalid top level domain never resolves
+  const std::string host = "skywing.invalid";
+  REQUIRE(resolver.resolve(host).status == Resolution::Status::pending);
+  REQUIRE(!resolver.cached(host));
+  // The reactor is woken once the lookup finishes
+  auto resolution = resolver.resolve(host);
+  while (resolution.status == Resolution::Status::pending) {
+    reactor.wait(100ms);
+    resolution = resolver.resolve(host);
+  }
+  REQUIRE(resolution.status == Resolution::Status::failed);
+  // The reason is passed on to whoever asked for the connection
+  REQUIRE(!resolution.error.empty());
+  REQUIRE(!resolver.cached(host));
+  // Failures are only reported once so that the lookup can be retried
+  REQUIRE(resolver.resolve(host).status == Resolution::Status::pending);
+}
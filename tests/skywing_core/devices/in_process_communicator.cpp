@@ -0,0 +1,144 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/devices/in_process_communicator.hpp"
+#include "skywing_core/internal/devices/reactor.hpp"
+#include "skywing_core/internal/devices/receive_buffer.hpp"
+#include "skywing_core/internal/devices/send_queue.hpp"
+#include "skywing_core/internal/utility/network_conv.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace skywing;
+using namespace skywing::internal;
+
+namespace {
+SharedFrame make_frame(const std::size_t payload_size, const int seed)
+{
+  std::vector<std::byte> frame(frame_header_size + payload_size);
+  const auto size_bytes = to_network_bytes(static_cast<NetworkSizeType>(payload_size));
+  std::memcpy(frame.data(), size_bytes.data(), size_bytes.size());
+  for (std::size_t i = 0; i < payload_size; ++i) {
+    frame[frame_header_size + i] = static_cast<std::byte>(i * 5 + seed);
+  }
+  return std::make_shared<const std::vector<std::byte>>(std::move(frame));
+}
+} // namespace
+
+TEST_CASE("In-process connections pass frames between reactors", "[Skywing_InProcessCommunicator]")
+{
+  using namespace std::chrono_literals;
+  constexpr std::uint16_t port = 12345;
+  Reactor server_reactor;
+  Reactor client_reactor;
+  InProcessListener listener;
+  REQUIRE(listener.listen(port, server_reactor) == ConnectionError::no_error);
+  {
+    // Only one listener per port
+    InProcessListener duplicate;
+    REQUIRE(duplicate.listen(port, client_reactor) == ConnectionError::unrecoverable);
+  }
+  REQUIRE(!listener.accept());
+  REQUIRE(InProcessCommunicator::connect(port + 1, client_reactor)->connection_progress_status()
+          == ConnectionError::unrecoverable);
+
+  auto client = InProcessCommunicator::connect(port, client_reactor);
+  REQUIRE(client->connection_progress_status() == ConnectionError::no_error);
+  REQUIRE(client->native_handle() == -1);
+  REQUIRE(client->is_in_process());
+  // Connecting wakes the listener
+  REQUIRE(server_reactor.wait(0ms));
+  auto server = listener.accept();
+  REQUIRE(server);
+
+  // Frames are passed without copying them
+  SendQueue queue;
+  std::vector<SharedFrame> sent;
+  for (int i = 0; i < 10; ++i) {
+    sent.push_back(make_frame(8 * (i + 1), i));
+    queue.push(sent.back());
+  }
+  REQUIRE(queue.flush(*client, client_reactor) == ConnectionError::no_error);
+  REQUIRE(queue.empty());
+  for (const auto& frame : sent) {
+    REQUIRE(frame.use_count() == 2);
+  }
+  REQUIRE(server_reactor.wait(0ms));
+
+  ReceiveBuffer received;
+  REQUIRE(received.fill(*server) == ConnectionError::no_error);
+  for (const auto& frame : sent) {
+    const auto read = received.next_frame();
+    REQUIRE(read);
+    REQUIRE(std::vector<std::byte>(read->begin(), read->end())
+            == std::vector<std::byte>(frame->cbegin() + frame_header_size, frame->cend()));
+  }
+  REQUIRE(!received.next_frame());
+  REQUIRE(received.fill(*server) == ConnectionError::would_block);
+
+  // Replies go the other way
+  const auto reply = make_frame(16, 42);
+  REQUIRE(server->send_message(reply->data(), reply->size()) == ConnectionError::no_error);
+  REQUIRE(client_reactor.wait(0ms));
+  ReceiveBuffer client_received;
+  REQUIRE(client_received.fill(*client) == ConnectionError::no_error);
+  REQUIRE(client_received.next_frame());
+
+  // Closing one end is seen by the other once everything sent has been read
+  REQUIRE(client->send_message(reply->data(), reply->size()) == ConnectionError::no_error);
+  client.reset();
+  REQUIRE(received.fill(*server) == ConnectionError::no_error);
+  REQUIRE(received.next_frame());
+  REQUIRE(received.fill(*server) == ConnectionError::closed);
+  REQUIRE(server->send_message(reply->data(), reply->size()) == ConnectionError::closed);
+}
+
+TEST_CASE("Simulated in-process connections deliver frames by a virtual clock", "[Skywing_InProcessCommunicator]")
+{
+  using namespace std::chrono_literals;
+  constexpr std::uint16_t port = 12346;
+  constexpr std::uint16_t client_port = 12347;
+  VirtualClock clock;
+  SimulatedLinks links{clock, [=](const std::uint16_t from, const std::uint16_t to, const std::size_t bytes) {
+                         REQUIRE(from == client_port);
+                         REQUIRE(to == port);
+                         return std::chrono::nanoseconds{1000 * bytes};
+                       }};
+  Reactor reactor;
+  InProcessListener listener;
+  REQUIRE(listener.listen(port, reactor, &links) == ConnectionError::no_error);
+  auto client = InProcessCommunicator::connect(port, reactor, client_port);
+  auto server = listener.accept();
+  REQUIRE(server);
+  REQUIRE(!links.next_delivery());
+
+  const auto large = make_frame(64, 0);
+  const auto small = make_frame(8, 1);
+  REQUIRE(client->send_shared_frame(large));
+  REQUIRE(client->send_shared_frame(small));
+  const auto large_delivery = VirtualClock::time_point{} + std::chrono::nanoseconds{1000 * large->size()};
+  REQUIRE(links.next_delivery() == large_delivery);
+
+  // Nothing arrives until the clock reaches the delivery time
+  ReceiveBuffer received;
+  REQUIRE(received.fill(*server) == ConnectionError::would_block);
+  clock.advance_to(large_delivery - 1ns);
+  REQUIRE(received.fill(*server) == ConnectionError::would_block);
+  // Smaller frames sent later still arrive in order
+  clock.advance_to(large_delivery);
+  REQUIRE(!links.next_delivery());
+  REQUIRE(received.fill(*server) == ConnectionError::no_error);
+  REQUIRE(received.next_frame()->size() == 64);
+  REQUIRE(received.next_frame()->size() == 8);
+
+  // Closing isn't seen until everything sent has been delivered
+  REQUIRE(client->send_shared_frame(small));
+  client.reset();
+  REQUIRE(received.fill(*server) == ConnectionError::would_block);
+  clock.advance_to(clock.now() + 1ms);
+  REQUIRE(received.fill(*server) == ConnectionError::no_error);
+  REQUIRE(received.fill(*server) == ConnectionError::closed);
+}
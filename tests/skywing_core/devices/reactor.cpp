@@ -0,0 +1,62 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/devices/reactor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace skywing::internal;
+using namespace std::chrono_literals;
+
+TEST_CASE("Reactor wakes are coalesced and not lost", "[Skywing_Reactor]")
+{
+  Reactor reactor;
+
+  // A wake before the wait makes it return immediately
+  reactor.wake();
+  REQUIRE(reactor.wait(1000ms));
+
+  // Woken from another thread while waiting
+  std::thread waker{[&]() {
+    std::this_thread::sleep_for(50ms);
+    reactor.wake();
+  }};
+  const auto start = std::chrono::steady_clock::now();
+  REQUIRE(reactor.wait(10'000ms));
+  REQUIRE(std::chrono::steady_clock::now() - start < 5s);
+  waker.join();
+
+  // A wake while one is already pending is folded into it
+  reactor.wake();
+  reactor.wake();
+  REQUIRE(reactor.wait(1000ms));
+  // Both were consumed by the first wait
+  REQUIRE(!reactor.wait(10ms));
+
+  // Later wakes still get through
+  reactor.wake();
+  REQUIRE(reactor.wait(1000ms));
+}
+
+TEST_CASE("Reactor wakes racing with waits are never lost", "[Skywing_Reactor]")
+{
+  Reactor reactor;
+  // Keep waking while the reactor drains earlier wakes, so that some land
+  // between a wait reading the wake and it being marked as handled
+  std::atomic<bool> done{false};
+  std::thread waker{[&]() {
+    while (!done) {
+      reactor.wake();
+    }
+  }};
+  for (int i = 0; i < 10'000; ++i) {
+    (void)reactor.wait(10ms);
+  }
+  done = true;
+  waker.join();
+  // Drain whatever wake is left over, then check that a new one still gets through
+  (void)reactor.wait(0ms);
+  reactor.wake();
+  REQUIRE(reactor.wait(1000ms));
+}
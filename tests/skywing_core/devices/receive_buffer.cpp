@@ -0,0 +1,125 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/devices/receive_buffer.hpp"
+#include "skywing_core/internal/devices/socket_communicator.hpp"
+#include "skywing_core/internal/utility/network_conv.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace skywing;
+using namespace skywing::internal;
+
+namespace {
+std::vector<std::byte> make_frame(const std::size_t payload_size, const int seed)
+{
+  std::vector<std::byte> frame(frame_header_size + payload_size);
+  const auto size_bytes = to_network_bytes(static_cast<NetworkSizeType>(payload_size));
+  std::memcpy(frame.data(), size_bytes.data(), size_bytes.size());
+  for (std::size_t i = 0; i < payload_size; ++i) {
+    frame[frame_header_size + i] = static_cast<std::byte>(i + seed);
+  }
+  return frame;
+}
+
+bool payload_matches(const gsl::span<const std::byte> payload, const std::vector<std::byte>& frame)
+{
+  return static_cast<std::size_t>(payload.size()) + frame_header_size == frame.size()
+      && std::equal(payload.begin(), payload.end(), frame.cbegin() + frame_header_size);
+}
+
+// Fills until the expected number of frames have been parsed out
+std::vector<std::vector<std::byte>> read_frames(SocketCommunicator& conn, ReceiveBuffer& buffer, std::size_t count)
+{
+  std::vector<std::vector<std::byte>> frames;
+  while (frames.size() < count) {
+    const auto err = buffer.fill(conn);
+    REQUIRE((err == ConnectionError::no_error || err == ConnectionError::would_block));
+    while (const auto frame = buffer.next_frame()) {
+      frames.emplace_back(frame->begin(), frame->end());
+    }
+  }
+  return frames;
+}
+} // namespace
+
+TEST_CASE("Receive buffer frames data", "[Skywing_ReceiveBuffer]")
+{
+  const auto port = get_starting_port();
+  SocketCommunicator server;
+  REQUIRE(server.set_to_listen(port) == ConnectionError::no_error);
+  SocketCommunicator client;
+  REQUIRE(client.connect_to_server("127.0.0.1", port) == ConnectionError::no_error);
+  std::optional<SocketCommunicator> accepted;
+  while (!accepted) {
+    accepted = server.accept();
+  }
+  ReceiveBuffer buffer;
+
+  // Several frames in one read
+  {
+    std::vector<std::byte> to_send;
+    std::vector<std::vector<std::byte>> sent;
+    for (int i = 0; i < 10; ++i) {
+      sent.push_back(make_frame(8 * i, i));
+      to_send.insert(to_send.end(), sent.back().cbegin(), sent.back().cend());
+    }
+    REQUIRE(client.send_message(to_send.data(), to_send.size()) == ConnectionError::no_error);
+    std::size_t num_received = 0;
+    while (num_received < sent.size()) {
+      const auto err = buffer.fill(*accepted);
+      REQUIRE((err == ConnectionError::no_error || err == ConnectionError::would_block));
+      while (const auto frame = buffer.next_frame()) {
+        REQUIRE(payload_matches(*frame, sent[num_received]));
+        // Frames that are a whole number of words stay word-aligned
+        REQUIRE(reinterpret_cast<std::uintptr_t>(frame->data()) % 8 == 0);
+        ++num_received;
+      }
+    }
+    REQUIRE(buffer.size() == 0);
+  }
+
+  // A frame split across reads
+  {
+    const auto frame = make_frame(1000, 3);
+    // Send the size prefix in pieces, then the rest
+    for (std::size_t sent_so_far = 0; sent_so_far < frame.size();) {
+      const std::size_t amount = sent_so_far < frame_header_size ? 1 : 300;
+      const auto to_send = std::min(amount, frame.size() - sent_so_far);
+      REQUIRE(client.send_message(frame.data() + sent_so_far, to_send) == ConnectionError::no_error);
+      sent_so_far += to_send;
+      // Nothing should come out until the entire frame is present
+      if (sent_so_far != frame.size()) {
+        while (buffer.size() < sent_so_far) {
+          (void)buffer.fill(*accepted);
+        }
+        REQUIRE(!buffer.next_frame());
+      }
+    }
+    const auto received = read_frames(*accepted, buffer, 1);
+    REQUIRE(payload_matches(received[0], frame));
+  }
+
+  // A frame larger than the initial buffer
+  {
+    const auto frame = make_frame(1'000'000, 5);
+    std::size_t sent_so_far = 0;
+    std::vector<std::vector<std::byte>> received;
+    // The socket buffer may not hold the whole thing, so interleave sending and reading
+    while (received.empty()) {
+      if (sent_so_far < frame.size()) {
+        const auto to_send = std::min<std::size_t>(0x1'0000, frame.size() - sent_so_far);
+        if (client.send_message(frame.data() + sent_so_far, to_send) == ConnectionError::no_error) {
+          sent_so_far += to_send;
+        }
+      }
+      (void)buffer.fill(*accepted);
+      if (const auto payload = buffer.next_frame()) { received.emplace_back(payload->begin(), payload->end()); }
+    }
+    REQUIRE(payload_matches(received[0], frame));
+  }
+}
@@ -0,0 +1,183 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/devices/reactor.hpp"
+#include "skywing_core/internal/devices/send_queue.hpp"
+#include "skywing_core/internal/devices/socket_communicator.hpp"
+#include "utils.hpp"
+
+#include <sys/socket.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace skywing;
+using namespace skywing::internal;
+
+TEST_CASE("Send queue survives partial writes", "[Skywing_SendQueue]")
+{
+  const auto port = get_starting_port();
+  SocketCommunicator server;
+  REQUIRE(server.set_to_listen(port) == ConnectionError::no_error);
+  SocketCommunicator client;
+  REQUIRE(client.connect_to_server("127.0.0.1", port) == ConnectionError::no_error);
+  std::optional<SocketCommunicator> accepted;
+  while (!accepted) {
+    accepted = server.accept();
+  }
+
+  // Queue up far more than a socket buffer can hold so that writes are cut short
+  Reactor reactor;
+  SendQueue queue;
+  std::vector<std::byte> expected;
+  constexpr int num_frames = 64;
+  for (int i = 0; i < num_frames; ++i) {
+    auto frame = std::make_shared<std::vector<std::byte>>(100'000 + i);
+    for (std::size_t j = 0; j < frame->size(); ++j) {
+      (*frame)[j] = static_cast<std::byte>(j * 7 + i);
+    }
+    expected.insert(expected.end(), frame->cbegin(), frame->cend());
+    queue.push(std::move(frame));
+  }
+  REQUIRE(queue.size() == num_frames);
+  REQUIRE(queue.bytes() == expected.size());
+
+  std::vector<std::byte> received;
+  std::vector<std::byte> read_buffer(0x1'0000);
+  bool saw_would_block = false;
+  while (received.size() < expected.size()) {
+    const auto err = queue.flush(client, reactor);
+    REQUIRE((err == ConnectionError::no_error || err == ConnectionError::would_block));
+    saw_would_block |= err == ConnectionError::would_block;
+    // read_message doesn't say how much was read, so go to the socket directly
+    ssize_t amount;
+    while ((amount = recv(accepted->native_handle(), read_buffer.data(), read_buffer.size(), 0)) > 0) {
+      received.insert(received.end(), read_buffer.cbegin(), read_buffer.cbegin() + amount);
+    }
+  }
+  REQUIRE(saw_would_block);
+  REQUIRE(queue.empty());
+  REQUIRE(queue.bytes() == 0);
+  REQUIRE(received == expected);
+}
+
+TEST_CASE("Send queue replaces unsent frames with the same key", "[Skywing_SendQueue]")
+{
+  // The first test case may still hold its port
+  const auto port = get_starting_port() + 1;
+  SocketCommunicator server;
+  REQUIRE(server.set_to_listen(port) == ConnectionError::no_error);
+  SocketCommunicator client;
+  REQUIRE(client.connect_to_server("127.0.0.1", port) == ConnectionError::no_error);
+  std::optional<SocketCommunicator> accepted;
+  while (!accepted) {
+    accepted = server.accept();
+  }
+  const auto make_frame = [](const std::size_t size, const std::uint8_t fill) {
+    return std::make_shared<const std::vector<std::byte>>(size, std::byte{fill});
+  };
+
+  // Too large for the socket to take at once, so it is left partly written
+  Reactor reactor;
+  SendQueue queue;
+  const auto first = make_frame(std::size_t{1} << 24, 1);
+  REQUIRE(!queue.push_replacing("a", first));
+  REQUIRE(queue.flush(client, reactor) == ConnectionError::would_block);
+
+  const auto second = make_frame(100, 2);
+  const auto third = make_frame(200, 3);
+  const auto fourth = make_frame(300, 4);
+  const auto fifth = make_frame(400, 5);
+  REQUIRE(!queue.push_replacing("a", second));
+  REQUIRE(!queue.push_replacing("b", third));
+  queue.push(make_frame(50, 6));
+  REQUIRE(queue.push_replacing("a", fourth));
+  REQUIRE(queue.push_replacing("b", fifth));
+  REQUIRE(queue.size() == 4);
+  REQUIRE(queue.replaced_frames() == 2);
+
+  std::vector<std::byte> expected(*first);
+  expected.insert(expected.end(), fourth->cbegin(), fourth->cend());
+  expected.insert(expected.end(), fifth->cbegin(), fifth->cend());
+  expected.insert(expected.end(), 50, std::byte{6});
+  std::vector<std::byte> received;
+  std::vector<std::byte> read_buffer(0x1'0000);
+  while (received.size() < expected.size()) {
+    const auto err = queue.flush(client, reactor);
+    REQUIRE((err == ConnectionError::no_error || err == ConnectionError::would_block));
+    ssize_t amount;
+    while ((amount = recv(accepted->native_handle(), read_buffer.data(), read_buffer.size(), 0)) > 0) {
+      received.insert(received.end(), read_buffer.cbegin(), read_buffer.cbegin() + amount);
+    }
+  }
+  REQUIRE(queue.empty());
+  REQUIRE(received == expected);
+
+  // Once sent, a key starts a new frame
+  REQUIRE(!queue.push_replacing("a", second));
+  REQUIRE(queue.size() == 1);
+}
+
+TEST_CASE("Send queue holds back rate limited frames", "[Skywing_SendQueue]")
+{
+  const auto port = get_starting_port() + 2;
+  SocketCommunicator server;
+  REQUIRE(server.set_to_listen(port) == ConnectionError::no_error);
+  SocketCommunicator client;
+  REQUIRE(client.connect_to_server("127.0.0.1", port) == ConnectionError::no_error);
+  std::optional<SocketCommunicator> accepted;
+  while (!accepted) {
+    accepted = server.accept();
+  }
+  const auto make_frame = [](const std::size_t size, const std::uint8_t fill) {
+    return std::make_shared<const std::vector<std::byte>>(size, std::byte{fill});
+  };
+  std::vector<std::byte> read_buffer(0x1'0000);
+  const auto receive = [&](const std::size_t expected_size) {
+    std::vector<std::byte> received;
+    while (received.size() < expected_size) {
+      const auto amount = recv(accepted->native_handle(), read_buffer.data(), read_buffer.size(), 0);
+      if (amount > 0) { received.insert(received.end(), read_buffer.cbegin(), read_buffer.cbegin() + amount); }
+    }
+    return received;
+  };
+
+  Reactor reactor;
+  SendQueue queue;
+  REQUIRE(!queue.push_replacing("a", make_frame(10, 1)));
+  REQUIRE(!queue.push_replacing("b", make_frame(20, 2)));
+  queue.push(make_frame(30, 3), std::chrono::steady_clock::now(), true);
+  queue.push(make_frame(40, 4));
+  // Nothing has been let through yet, though no flush has held anything back
+  REQUIRE(queue.held_frames() == 0);
+  REQUIRE(queue.unadmitted_frames() == 3);
+
+  // Only the first limited frame is let through; the other frame goes past the rest
+  std::vector<std::size_t> asked;
+  const auto admit_first = [&](const std::size_t size) {
+    asked.push_back(size);
+    return asked.size() == 1;
+  };
+  REQUIRE(queue.flush(client, reactor, admit_first) == ConnectionError::no_error);
+  REQUIRE(asked == std::vector<std::size_t>{10, 20});
+  REQUIRE(queue.size() == 2);
+  REQUIRE(queue.held_frames() == 2);
+  REQUIRE(queue.unadmitted_frames() == 2);
+  std::vector<std::byte> expected(10, std::byte{1});
+  expected.insert(expected.end(), 40, std::byte{4});
+  REQUIRE(receive(expected.size()) == expected);
+
+  // Held frames can still be replaced, and keep their order once allowed through
+  REQUIRE(queue.push_replacing("b", make_frame(25, 5)));
+  REQUIRE(queue.unadmitted_frames() == 2);
+  queue.push(make_frame(50, 6));
+  REQUIRE(queue.unadmitted_frames() == 2);
+  REQUIRE(queue.flush(client, reactor, [](std::size_t) { return true; }) == ConnectionError::no_error);
+  REQUIRE(queue.empty());
+  REQUIRE(queue.held_frames() == 0);
+  REQUIRE(queue.unadmitted_frames() == 0);
+  expected.assign(25, std::byte{5});
+  expected.insert(expected.end(), 30, std::byte{3});
+  expected.insert(expected.end(), 50, std::byte{6});
+  REQUIRE(receive(expected.size()) == expected);
+}
@@ -0,0 +1,171 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/devices/receive_buffer.hpp"
+#include "skywing_core/internal/devices/send_queue.hpp"
+#include "skywing_core/internal/devices/shared_memory_ring.hpp"
+#include "skywing_core/internal/utility/network_conv.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace skywing;
+using namespace skywing::internal;
+
+namespace {
+std::vector<std::byte> make_frame(const std::size_t payload_size, const int seed)
+{
+  std::vector<std::byte> frame(frame_header_size + payload_size);
+  const auto size_bytes = to_network_bytes(static_cast<NetworkSizeType>(payload_size));
+  std::memcpy(frame.data(), size_bytes.data(), size_bytes.size());
+  for (std::size_t i = 0; i < payload_size; ++i) {
+    frame[frame_header_size + i] = static_cast<std::byte>(i * 3 + seed);
+  }
+  return frame;
+}
+} // namespace
+
+TEST_CASE("Shared memory rings carry frames between two sides", "[Skywing_SharedMemoryRing]")
+{
+  auto writer = SharedMemoryRing::create(0x1000);
+  REQUIRE(writer);
+  REQUIRE(writer->capacity() == 0x1000);
+  auto reader = SharedMemoryRing::open(writer->name(), writer->capacity());
+  REQUIRE(reader);
+  writer->unlink();
+  // Can't be opened again once unlinked
+  REQUIRE(!SharedMemoryRing::open(writer->name(), writer->capacity()));
+
+  // Write far more than the ring holds so that it fills up and wraps around
+  SendQueue queue;
+  std::vector<std::vector<std::byte>> expected;
+  constexpr int num_frames = 100;
+  for (int i = 0; i < num_frames; ++i) {
+    auto frame = make_frame(8 * (i % 50 + 1), i);
+    expected.emplace_back(frame.cbegin() + frame_header_size, frame.cend());
+    queue.push(std::make_shared<const std::vector<std::byte>>(std::move(frame)));
+  }
+
+  ReceiveBuffer received;
+  std::vector<std::vector<std::byte>> frames;
+  bool saw_would_block = false;
+  while (frames.size() < expected.size()) {
+    const auto err = queue.flush(*writer);
+    REQUIRE((err == ConnectionError::no_error || err == ConnectionError::would_block));
+    saw_would_block |= err == ConnectionError::would_block;
+    REQUIRE(queue.is_blocked() == (err == ConnectionError::would_block));
+    REQUIRE(received.fill(*reader) == ConnectionError::no_error);
+    while (const auto frame = received.next_frame()) {
+      frames.emplace_back(frame->begin(), frame->end());
+    }
+  }
+  REQUIRE(saw_would_block);
+  REQUIRE(queue.empty());
+  REQUIRE(frames == expected);
+  REQUIRE(received.fill(*reader) == ConnectionError::would_block);
+
+  // The writer is only asked to notify the reader once it goes to sleep
+  REQUIRE(!writer->take_wakeup_request());
+  REQUIRE(reader->prepare_to_sleep());
+  REQUIRE(writer->take_wakeup_request());
+  REQUIRE(!writer->take_wakeup_request());
+  REQUIRE(reader->prepare_to_sleep());
+  queue.push(std::make_shared<const std::vector<std::byte>>(make_frame(8, 0)));
+  REQUIRE(queue.flush(*writer) == ConnectionError::no_error);
+  REQUIRE(reader->has_data());
+  REQUIRE(!reader->prepare_to_sleep());
+
+  // Data written before closing can still be read
+  writer.reset();
+  REQUIRE(received.fill(*reader) == ConnectionError::no_error);
+  REQUIRE(received.next_frame());
+  REQUIRE(received.fill(*reader) == ConnectionError::closed);
+}
+
+TEST_CASE("Shared memory rings only take limited frames that are admitted", "[Skywing_SharedMemoryRing]")
+{
+  auto writer = SharedMemoryRing::create(0x1000);
+  REQUIRE(writer);
+  auto reader = SharedMemoryRing::open(writer->name(), writer->capacity());
+  REQUIRE(reader);
+  writer->unlink();
+
+  // Admits as many frames as there are credits, like a neighbor granting them
+  int credits = 1;
+  const AdmitFrame admit = [&](std::size_t) {
+    if (credits == 0) { return false; }
+    --credits;
+    return true;
+  };
+  SendQueue queue;
+  queue.push(std::make_shared<const std::vector<std::byte>>(make_frame(8, 0)), {}, true);
+  queue.push(std::make_shared<const std::vector<std::byte>>(make_frame(8, 1)), {}, true);
+  queue.push(std::make_shared<const std::vector<std::byte>>(make_frame(8, 2)));
+  REQUIRE(queue.flush(*writer, admit) == ConnectionError::no_error);
+  REQUIRE(queue.size() == 1);
+  REQUIRE(queue.held_frames() == 1);
+
+  ReceiveBuffer received;
+  const auto read_seeds = [&]() {
+    std::vector<int> seeds;
+    REQUIRE(received.fill(*reader) == ConnectionError::no_error);
+    while (const auto frame = received.next_frame()) {
+      seeds.push_back(static_cast<int>((*frame)[0]));
+    }
+    return seeds;
+  };
+  // Frames that aren't limited go past the held one
+  REQUIRE(read_seeds() == std::vector<int>{0, 2});
+
+  credits = 1;
+  REQUIRE(queue.flush(*writer, admit) == ConnectionError::no_error);
+  REQUIRE(queue.empty());
+  REQUIRE(queue.held_frames() == 0);
+  REQUIRE(read_seeds() == std::vector<int>{1});
+}
+
+TEST_CASE("Shared memory rings treat positions outside of them as broken", "[Skywing_SharedMemoryRing]")
+{
+  auto writer = SharedMemoryRing::create(0x1000);
+  REQUIRE(writer);
+  auto reader = SharedMemoryRing::open(writer->name(), writer->capacity());
+  REQUIRE(reader);
+
+  // Map the segment separately to act as a peer that scribbles over the
+  // positions; the head and tail are on the second and third cache lines
+  const int fd = ::shm_open(writer->name().c_str(), O_RDWR, 0);
+  REQUIRE(fd != -1);
+  writer->unlink();
+  void* const mapped = ::mmap(nullptr, 0x1000, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  REQUIRE(mapped != MAP_FAILED);
+  auto* const head = reinterpret_cast<std::atomic<std::uint64_t>*>(static_cast<std::byte*>(mapped) + 64);
+  auto* const tail = reinterpret_cast<std::atomic<std::uint64_t>*>(static_cast<std::byte*>(mapped) + 128);
+
+  const std::vector<std::byte> data(16, std::byte{1});
+  std::vector<gsl::span<const std::byte>> buffers{data};
+  std::size_t bytes_sent = 0;
+  REQUIRE(writer->send_buffers(buffers, bytes_sent) == ConnectionError::no_error);
+  REQUIRE(bytes_sent == data.size());
+  REQUIRE(head->load() == data.size());
+
+  std::vector<std::byte> buffer(0x2000);
+  std::size_t bytes_read = 0;
+  head->store(tail->load() + 0x1001);
+  REQUIRE(reader->read_available(buffer.data(), buffer.size(), bytes_read) == ConnectionError::closed);
+  REQUIRE(bytes_read == 0);
+
+  head->store(data.size());
+  tail->store(data.size() + 1);
+  REQUIRE(writer->send_buffers(buffers, bytes_sent) == ConnectionError::closed);
+  REQUIRE(bytes_sent == 0);
+
+  ::munmap(mapped, 0x1000);
+}
@@ -107,3 +107,36 @@ TEST_CASE("Communicating between sockets works", "[Skywing_SocketCommunicator]")
   s.join();
   c.join();
 }
+
+TEST_CASE("Local sockets work alongside TCP", "[Skywing_SocketCommunicator]")
+{
+  constexpr std::uint16_t local_port = port + 1;
+  const auto name = local_socket_name(local_port);
+  SocketCommunicator server{SocketFamily::local};
+  REQUIRE(server.set_to_listen_local(name) == ConnectionError::no_error);
+
+  SocketCommunicator client{SocketFamily::local};
+  const auto res = client.connect_local_non_blocking(name);
+  REQUIRE((res == ConnectionError::no_error || res == ConnectionError::connection_in_progress));
+  std::optional<SocketCommunicator> accepted;
+  while (!accepted) {
+    accepted = server.accept();
+  }
+  REQUIRE(accepted->is_local());
+  REQUIRE(accepted->ip_address_and_port() == AddrPortPair{"127.0.0.1", 0});
+
+  std::array<std::byte, sizeof(value_to_send)> int_buffer;
+  std::memcpy(int_buffer.data(), &value_to_send, sizeof(value_to_send));
+  REQUIRE(client.send_message(int_buffer.data(), int_buffer.size()) == ConnectionError::no_error);
+  int_buffer.fill(std::byte{0});
+  while (accepted->read_message(int_buffer.data(), int_buffer.size()) == ConnectionError::would_block) {
+    // empty
+  }
+  int read_value;
+  std::memcpy(&read_value, int_buffer.data(), sizeof(int));
+  REQUIRE(read_value == value_to_send);
+
+  // Nothing is listening on this one
+  SocketCommunicator unused{SocketFamily::local};
+  REQUIRE(unused.connect_local_non_blocking(local_socket_name(local_port + 1)) == ConnectionError::unrecoverable);
+}
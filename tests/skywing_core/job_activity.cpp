@@ -0,0 +1,86 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/devices/reactor.hpp"
+#include "skywing_core/internal/job_activity.hpp"
+#include "skywing_core/waiter.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace skywing;
+using namespace skywing::internal;
+using namespace std::chrono_literals;
+
+namespace {
+// Waits for the activity to reach a state; the job thread gets there on its own time
+bool becomes(JobActivity& activity, Reactor& reactor, const bool all_blocked)
+{
+  const auto give_up = std::chrono::steady_clock::now() + 10s;
+  while (activity.all_blocked() != all_blocked) {
+    if (std::chrono::steady_clock::now() > give_up) { return false; }
+    reactor.wait(10ms);
+  }
+  return true;
+}
+} // namespace
+
+TEST_CASE("Job activity knows when every job is blocked in a waiter", "[Skywing_JobActivity]")
+{
+  Reactor reactor;
+  JobActivity activity{reactor};
+  // Nothing is running
+  REQUIRE(activity.all_blocked());
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool ready = false;
+  bool keep_running = true;
+  activity.job_started();
+  // Counted as soon as it is started, before the thread does anything
+  REQUIRE(!activity.all_blocked());
+  std::thread job{[&]() {
+    const JobActivity::JobThread attached{&activity};
+    make_waiter(mutex, cv, [&]() { return ready; }).wait();
+    // Running outside of a waiter
+    while (true) {
+      std::lock_guard lock{mutex};
+      if (!keep_running) { break; }
+    }
+  }};
+  REQUIRE(becomes(activity, reactor, true));
+
+  // A waiter that is ready counts as running even before its thread wakes up
+  {
+    std::lock_guard lock{mutex};
+    ready = true;
+    REQUIRE(!activity.all_blocked());
+  }
+  cv.notify_all();
+  REQUIRE(!activity.all_blocked());
+  {
+    std::lock_guard lock{mutex};
+    keep_running = false;
+  }
+  job.join();
+  REQUIRE(activity.all_blocked());
+}
+
+TEST_CASE("Waiters on threads without a job activity are unaffected", "[Skywing_JobActivity]")
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool ready = false;
+  std::thread setter{[&]() {
+    std::this_thread::sleep_for(10ms);
+    {
+      std::lock_guard lock{mutex};
+      ready = true;
+    }
+    cv.notify_all();
+  }};
+  make_waiter(mutex, cv, [&]() { return ready; }).wait();
+  setter.join();
+  REQUIRE(ready);
+}
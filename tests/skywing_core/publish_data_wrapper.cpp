@@ -3,9 +3,18 @@
 #include <capnp/message.h>
 
 #include "skywing_core/internal/capn_proto_wrapper.hpp"
+#include "skywing_core/internal/message_creators.hpp"
+#include "skywing_core/internal/typed_publish_serializer.hpp"
+#include "skywing_core/internal/utility/network_conv.hpp"
 
 #include "skywing_core/include/publish_value_handler.hpp"
 
+#include <array>
+#include <cstring>
+#include <string>
+#include <tuple>
+
+using namespace skywing;
 using namespace skywing::internal;
 
 template<typename T>
@@ -34,3 +43,268 @@ TEST_CASE("Cap'n Proto Wrappers Work", "[Skywing_CapnProto_Wrappers]")
   REQUIRE(roundtrip_value(std::vector<std::string>{"str1", "str2"}));
   REQUIRE(roundtrip_value(std::vector<std::byte>{std::byte{0x10}, std::byte{0x80}, std::byte{0x7F}}));
 }
+
+TEST_CASE("Messages can be read in place", "[Skywing_CapnProto_Wrappers]")
+{
+  const std::vector<PublishValueVariant> to_send{1.0, std::vector<double>{2.0, 3.0}, std::int32_t{4}};
+  const auto frame = make_publish(7, "tag", to_send);
+  REQUIRE(frame.size() > frame_header_size);
+  REQUIRE((frame.size() - frame_header_size) % sizeof(capnp::word) == 0);
+
+  // Put the message into word-aligned storage, as the receive buffer would
+  std::vector<capnp::word> storage((frame.size() - frame_header_size) / sizeof(capnp::word));
+  std::memcpy(storage.data(), frame.data() + frame_header_size, frame.size() - frame_header_size);
+  const gsl::span<const std::byte> bytes{
+    reinterpret_cast<const std::byte*>(storage.data()), static_cast<gsl::index>(storage.size() * sizeof(capnp::word))};
+
+  const auto check_message = [&](const MessageHandler& handler) {
+    return handler.do_callback(
+      [&](const PublishData& msg) {
+        const auto value = msg.value();
+        return msg.version() == 7 && msg.tag_id() == "tag" && value && *value == to_send;
+      },
+      [](...) { return false; });
+  };
+  const auto viewed = MessageHandler::try_to_view(bytes);
+  REQUIRE(viewed);
+  REQUIRE(check_message(*viewed));
+  const auto copied = MessageHandler::try_to_create(bytes);
+  REQUIRE(copied);
+  REQUIRE(check_message(*copied));
+}
+
+TEST_CASE("Publish data decodes directly into typed storage", "[Skywing_CapnProto_Wrappers]")
+{
+  const std::vector<PublishValueVariant> to_send{std::vector<double>{1.0, 2.0, 3.0}, std::string{"str"}};
+  const auto frame = make_publish(3, "tag", to_send);
+  const auto handler = MessageHandler::try_to_create(gsl::span<const std::byte>{
+    frame.data() + frame_header_size, static_cast<gsl::index>(frame.size() - frame_header_size)});
+  REQUIRE(handler);
+  REQUIRE(handler->do_callback(
+    [&](const PublishData& msg) {
+      constexpr std::array<std::uint8_t, 2> matching_types{
+        index_of<std::vector<double>, PublishValueTypeList>, index_of<std::string, PublishValueTypeList>};
+      constexpr std::array<std::uint8_t, 2> wrong_types{
+        index_of<std::vector<float>, PublishValueTypeList>, index_of<std::string, PublishValueTypeList>};
+      constexpr std::array<std::uint8_t, 1> too_few_types{index_of<std::vector<double>, PublishValueTypeList>};
+      REQUIRE(msg.types_match(matching_types));
+      REQUIRE(!msg.types_match(wrong_types));
+      REQUIRE(!msg.types_match(too_few_types));
+
+      // Existing storage is overwritten, not appended to
+      std::tuple<std::vector<double>, std::string> values{std::vector<double>(10, 5.0), "old"};
+      REQUIRE(msg.value_into<std::vector<double>, std::string>(values));
+      REQUIRE(std::get<0>(values) == std::vector<double>{1.0, 2.0, 3.0});
+      REQUIRE(std::get<1>(values) == "str");
+
+      std::tuple<std::vector<float>, std::string> wrong_values;
+      REQUIRE(!msg.value_into<std::vector<float>, std::string>(wrong_values));
+      return true;
+    },
+    [](...) { return false; }));
+}
+
+TEST_CASE("Numeric vectors can be sent as raw arrays", "[Skywing_CapnProto_Wrappers]")
+{
+  const std::vector<PublishValueVariant> to_send{
+    std::vector<double>{1.5, -2.0, 3.25}, std::vector<std::uint16_t>{1, 2, 65535}, std::vector<bool>{true, false}};
+  const auto raw_frame = make_publish(1, "tag", to_send, wire_feature::raw_arrays);
+  const auto list_frame = make_publish(1, "tag", to_send, 0);
+  REQUIRE(raw_frame != list_frame);
+
+  const auto handler = MessageHandler::try_to_create(gsl::span<const std::byte>{
+    raw_frame.data() + frame_header_size, static_cast<gsl::index>(raw_frame.size() - frame_header_size)});
+  REQUIRE(handler);
+  REQUIRE(handler->do_callback(
+    [&](const PublishData& msg) {
+      const auto value = msg.value();
+      REQUIRE(value);
+      REQUIRE(*value == to_send);
+
+      constexpr std::array<std::uint8_t, 3> expected_types{
+        index_of<std::vector<double>, PublishValueTypeList>,
+        index_of<std::vector<std::uint16_t>, PublishValueTypeList>,
+        index_of<std::vector<bool>, PublishValueTypeList>};
+      REQUIRE(msg.types_match(expected_types));
+      constexpr std::array<std::uint8_t, 3> wrong_element_type{
+        index_of<std::vector<float>, PublishValueTypeList>,
+        index_of<std::vector<std::uint16_t>, PublishValueTypeList>,
+        index_of<std::vector<bool>, PublishValueTypeList>};
+      REQUIRE(!msg.types_match(wrong_element_type));
+
+      std::tuple<std::vector<double>, std::vector<std::uint16_t>, std::vector<bool>> typed;
+      REQUIRE(msg.value_into<std::vector<double>, std::vector<std::uint16_t>, std::vector<bool>>(typed));
+      REQUIRE(std::get<0>(typed) == std::vector<double>{1.5, -2.0, 3.25});
+      REQUIRE(std::get<1>(typed) == std::vector<std::uint16_t>{1, 2, 65535});
+      REQUIRE(std::get<2>(typed) == std::vector<bool>{true, false});
+      return true;
+    },
+    [](...) { return false; }));
+}
+
+TEST_CASE("Floating point vectors can be sent quantized", "[Skywing_CapnProto_Wrappers]")
+{
+  const std::vector<PublishValueVariant> to_send{
+    std::vector<double>{1.5, -2.0, 3.25}, std::vector<float>{0.0f, 0.3f, 1.0f}, std::vector<std::int32_t>{1, 2, 3}};
+  const auto exact_frame = make_publish(1, "tag", to_send, wire_feature::raw_arrays, Quantization::float16);
+  REQUIRE(exact_frame == make_publish(1, "tag", to_send, wire_feature::raw_arrays));
+  const auto frame = make_publish(
+    1, "tag", to_send, wire_feature::raw_arrays | wire_feature::quantized_arrays, Quantization::scaled_int8);
+  REQUIRE(frame != exact_frame);
+
+  const auto handler = MessageHandler::try_to_create(gsl::span<const std::byte>{
+    frame.data() + frame_header_size, static_cast<gsl::index>(frame.size() - frame_header_size)});
+  REQUIRE(handler);
+  REQUIRE(handler->do_callback(
+    [&](const PublishData& msg) {
+      constexpr std::array<std::uint8_t, 3> expected_types{
+        index_of<std::vector<double>, PublishValueTypeList>,
+        index_of<std::vector<float>, PublishValueTypeList>,
+        index_of<std::vector<std::int32_t>, PublishValueTypeList>};
+      REQUIRE(msg.types_match(expected_types));
+      constexpr std::array<std::uint8_t, 3> wrong_element_type{
+        index_of<std::vector<float>, PublishValueTypeList>,
+        index_of<std::vector<float>, PublishValueTypeList>,
+        index_of<std::vector<std::int32_t>, PublishValueTypeList>};
+      REQUIRE(!msg.types_match(wrong_element_type));
+
+      std::tuple<std::vector<double>, std::vector<float>, std::vector<std::int32_t>> typed;
+      REQUIRE(msg.value_into<std::vector<double>, std::vector<float>, std::vector<std::int32_t>>(typed));
+      const std::vector<double> expected_doubles{1.5, -2.0, 3.25};
+      const std::vector<float> expected_floats{0.0f, 0.3f, 1.0f};
+      REQUIRE(std::get<0>(typed).size() == expected_doubles.size());
+      REQUIRE(std::get<1>(typed).size() == expected_floats.size());
+      for (std::size_t i = 0; i < expected_doubles.size(); ++i) {
+        // Within half of one of the 254 steps across the range
+        REQUIRE(std::get<0>(typed)[i] == Approx(expected_doubles[i]).margin(5.25 / 254 / 2 + 1e-9));
+        REQUIRE(std::get<1>(typed)[i] == Approx(expected_floats[i]).margin(1.0 / 254 / 2 + 1e-6));
+      }
+      REQUIRE(std::get<2>(typed) == std::vector<std::int32_t>{1, 2, 3});
+      return true;
+    },
+    [](...) { return false; }));
+}
+
+TEST_CASE("Values published from views encode the same as copies", "[Skywing_CapnProto_Wrappers]")
+{
+  std::vector<double> large(5000);
+  for (std::size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<double>(i) / 3;
+  }
+  const std::vector<std::int16_t> small{1, -2, 3};
+  const std::vector<PublishValueVariant> copied{large, small, std::string{"str"}};
+  const std::array<PublishValueView, 3> views{
+    make_publish_value_view<std::vector<double>>(large),
+    make_publish_value_view<std::vector<std::int16_t>>(gsl::span<const std::int16_t>{small}),
+    make_publish_value_view<std::string>("str")};
+  REQUIRE(std::holds_alternative<gsl::span<const double>>(views[0]));
+  REQUIRE(std::holds_alternative<PublishValueVariant>(views[2]));
+
+  for (const WireFeatures features : {WireFeatures{0}, WireFeatures{wire_feature::raw_arrays}}) {
+    const auto frame = make_publish(2, "tag", gsl::span<const PublishValueView>{views}, features);
+    REQUIRE(frame == make_publish(2, "tag", copied, features));
+    const auto handler = MessageHandler::try_to_create(gsl::span<const std::byte>{
+      frame.data() + frame_header_size, static_cast<gsl::index>(frame.size() - frame_header_size)});
+    REQUIRE(handler);
+    REQUIRE(handler->do_callback(
+      [&](const PublishData& msg) {
+        const auto value = msg.value();
+        return msg.version() == 2 && value && *value == copied;
+      },
+      [](...) { return false; }));
+  }
+}
+
+TEST_CASE("Values published with their types encode the same as variants", "[Skywing_CapnProto_Wrappers]")
+{
+  const std::vector<double> doubles{1.5, -2.0, 3.25};
+  const std::string str{"str"};
+  const std::vector<std::int32_t> ints{1, 2, 3};
+  using Serializer = TypedPublishSerializer<std::vector<double>, std::string, std::vector<std::int32_t>>;
+  const Serializer typed{doubles, str, ints};
+  const std::vector<PublishValueVariant> variants{doubles, str, ints};
+  REQUIRE(typed.size() == 3);
+  REQUIRE(typed.to_variants() == variants);
+
+  const std::array<std::pair<WireFeatures, Quantization>, 3> encodings{
+    std::pair{WireFeatures{0}, Quantization::none},
+    std::pair{WireFeatures{wire_feature::raw_arrays}, Quantization::none},
+    std::pair{WireFeatures{wire_feature::raw_arrays | wire_feature::quantized_arrays}, Quantization::float16}};
+  for (const auto& [features, quantization] : encodings) {
+    const auto frame = make_publish(5, "tag", typed, features, quantization);
+    REQUIRE(frame == make_publish(5, "tag", variants, features, quantization));
+
+    const auto handler = MessageHandler::try_to_create(gsl::span<const std::byte>{
+      frame.data() + frame_header_size, static_cast<gsl::index>(frame.size() - frame_header_size)});
+    REQUIRE(handler);
+    REQUIRE(handler->do_callback(
+      [&](const PublishData& msg) {
+        REQUIRE(msg.types_match(Serializer::type_indices));
+        std::tuple<std::vector<double>, std::string, std::vector<std::int32_t>> values;
+        REQUIRE(Serializer::read(msg, values));
+        // The doubles are exact in half precision
+        return values == std::tuple{doubles, str, ints};
+      },
+      [](...) { return false; }));
+  }
+}
+
+TEST_CASE("Publish templates reuse the buffers of sent frames", "[Skywing_CapnProto_Wrappers]")
+{
+  PublishTemplate tmpl;
+  const std::vector<PublishValueVariant> to_send{std::vector<double>(100, 1.0), std::string{"str"}};
+  auto first = make_publish(tmpl, 1, "tag", to_send, wire_feature::raw_arrays);
+  REQUIRE(*first == make_publish(1, "tag", to_send, wire_feature::raw_arrays));
+  // Everything after the header and the single segment table
+  REQUIRE(tmpl.size_hint(wire_feature::raw_arrays) == first->size() - frame_header_size - 8);
+  REQUIRE(tmpl.size_hint(0) == 0);
+
+  // The first frame is still held, so it can't be built into
+  const auto second = make_publish(tmpl, 2, "tag", to_send, wire_feature::raw_arrays);
+  REQUIRE(second.get() != first.get());
+  REQUIRE(tmpl.reused_buffers() == 0);
+
+  const auto* const first_data = first->data();
+  first.reset();
+  const auto third = make_publish(tmpl, 3, "tag", to_send, wire_feature::raw_arrays);
+  REQUIRE(tmpl.reused_buffers() == 1);
+  REQUIRE(tmpl.buffers() == 2);
+  // Built in the same storage without growing it
+  REQUIRE(third->data() == first_data);
+  REQUIRE(*third == make_publish(3, "tag", to_send, wire_feature::raw_arrays));
+}
+
+TEST_CASE("Publishes name their tag by index to receivers that support it", "[Skywing_CapnProto_Wrappers]")
+{
+  const auto read_frame = [](const std::vector<std::byte>& frame) {
+    return MessageHandler::try_to_create(gsl::span<const std::byte>{
+      frame.data() + frame_header_size, static_cast<gsl::index>(frame.size() - frame_header_size)});
+  };
+  const std::vector<PublishValueVariant> to_send{std::int32_t{3}};
+
+  const auto bind = read_frame(make_bind_tag("tag", 7));
+  REQUIRE(bind);
+  REQUIRE(bind->do_callback(
+    [](const BindTag& msg) { return msg.tag_id() == "tag" && msg.index() == 7; }, [](...) { return false; }));
+
+  PublishTemplate tmpl{7};
+  const auto by_index = make_publish(tmpl, 1, "tag", to_send, wire_feature::tag_indices);
+  const auto by_name = make_publish(tmpl, 1, "tag", to_send, 0);
+  REQUIRE(by_index->size() < by_name->size());
+  REQUIRE(*by_name == make_publish(1, "tag", to_send));
+  const auto names_tag = [&](const SharedFrame& frame, const std::uint32_t tag_index, const std::string& tag_id) {
+    const auto handler = read_frame(*frame);
+    return handler && handler->do_callback(
+             [&](const PublishData& msg) {
+               const auto value = msg.value();
+               return msg.tag_index() == tag_index && msg.tag_id_view() == tag_id && value && *value == to_send;
+             },
+             [](...) { return false; });
+  };
+  REQUIRE(names_tag(by_index, 7, ""));
+  REQUIRE(names_tag(by_name, 0, "tag"));
+
+  // Templates without an index always name the tag
+  PublishTemplate unindexed;
+  REQUIRE(*make_publish(unindexed, 1, "tag", to_send, wire_feature::tag_indices) == *by_name);
+}
@@ -0,0 +1,50 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/skywing.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace skywing;
+
+constexpr int num_machines = 16;
+// In-process ports don't need to be free for sockets
+constexpr std::uint16_t base_port = 20000;
+constexpr std::chrono::milliseconds latency{50};
+
+using ValueTag = PublishTag<int>;
+
+TEST_CASE("Simulated instances communicate on a virtual clock", "[Skywing_Simulator]")
+{
+  std::vector<ValueTag> tags;
+  for (int i = 0; i < num_machines; ++i) {
+    tags.emplace_back("tag " + std::to_string(i));
+  }
+  Simulator simulator{constant_latency(latency)};
+  for (int i = 0; i < num_machines; ++i) {
+    auto& manager = simulator.add_manager(static_cast<std::uint16_t>(base_port + i), std::to_string(i));
+    manager.submit_job("job", [&tags, i](Job& job, ManagerHandle handle) {
+      // Connect the instances in a line so that publishers have to be found through others
+      if (i != 0) {
+        while (!handle.connect_to_server("127.0.0.1", base_port + i - 1).get()) {}
+      }
+      const auto next = (i + 1) % num_machines;
+      job.declare_publication_intent(tags[i]);
+      job.subscribe(tags[next]).get();
+      // Waits in the simulation rather than on the other jobs, which would keep the clock still
+      handle.waiter_on_subscription_change([&]() { return handle.number_of_subscribers(tags[i]) > 0; }).wait();
+      job.publish(tags[i], i);
+      const auto value = job.get_waiter(tags[next]).get();
+      static std::mutex catch_mutex;
+      std::lock_guard lock{catch_mutex};
+      REQUIRE(value);
+      REQUIRE(*value == next);
+    });
+  }
+  simulator.run();
+  // Connecting, finding publishers, and publishing each take at least one trip
+  REQUIRE(simulator.elapsed() >= 3 * latency);
+}
@@ -0,0 +1,94 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/skywing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using namespace skywing;
+
+// In-process ports don't need to be free for sockets
+constexpr std::uint16_t base_port = 20300;
+constexpr std::size_t max_batch_messages = 8;
+constexpr std::chrono::milliseconds batch_delay{50};
+constexpr std::chrono::milliseconds latency{1};
+// Far longer than the batch delay, so that the heartbeat timer never flushes the batch
+constexpr std::chrono::milliseconds heartbeat_interval{10'000};
+
+namespace {
+std::size_t queued_messages_to(const ManagerHandle& handle, const MachineID& id)
+{
+  const auto stats = handle.neighbor_stats();
+  const auto iter
+    = std::find_if(stats.cbegin(), stats.cend(), [&](const NeighborStats& neighbor) { return neighbor.id == id; });
+  return iter == stats.cend() ? 0 : iter->queued_messages;
+}
+} // namespace
+
+TEST_CASE("Messages are batched until the batch is full or the delay passes", "[Skywing_TransportBatching]")
+{
+  const PublishTag<std::int32_t> values_tag{"values"};
+  Simulator simulator{constant_latency(latency)};
+  auto& publisher = simulator.add_manager(base_port, "publisher", heartbeat_interval);
+  auto& subscriber = simulator.add_manager(base_port + 1, "subscriber", heartbeat_interval);
+  TransportOptions options;
+  options.max_batch_messages = max_batch_messages;
+  options.batch_delay = batch_delay;
+  // Every value has to be queued rather than replacing the one before it
+  options.replace_unsent_publishes = false;
+  options.use_shared_memory = false;
+  publisher.set_transport_options(options);
+  subscriber.set_transport_options(options);
+
+  // Filled in by the jobs and checked once the simulation is done
+  std::size_t queued_before = 0;
+  std::vector<std::size_t> queued_after_publish;
+  std::chrono::nanoseconds last_published_at{0};
+  std::chrono::nanoseconds last_received_at{0};
+  // Read by the subscriber while the publisher is still running
+  std::atomic<std::int32_t> last_value{0};
+
+  publisher.submit_job("job", [&](Job& job, ManagerHandle handle) {
+    job.declare_publication_intent(values_tag);
+    handle.waiter_on_subscription_change([&]() { return handle.number_of_subscribers(values_tag) > 0; }).wait();
+    // The clock doesn't move while this job runs, so nothing queued is due
+    // until a full batch is queued
+    queued_before = queued_messages_to(handle, "subscriber");
+    std::int32_t value = 0;
+    for (std::size_t queued = queued_before; queued < max_batch_messages; ++queued) {
+      job.publish(values_tag, ++value);
+      queued_after_publish.push_back(queued_messages_to(handle, "subscriber"));
+    }
+    // Less than a full batch, so it's only written once the delay has passed
+    last_published_at = simulator.elapsed();
+    last_value = ++value;
+    job.publish(values_tag, value);
+  });
+  subscriber.submit_job("job", [&](Job& job, ManagerHandle handle) {
+    while (!handle.connect_to_server("127.0.0.1", base_port).get()) {}
+    job.subscribe(values_tag).get();
+    while (true) {
+      const auto value = job.get_waiter(values_tag).get();
+      if (!value) { return; }
+      if (*value == last_value.load()) {
+        last_received_at = simulator.elapsed();
+        return;
+      }
+    }
+  });
+  simulator.run();
+
+  REQUIRE(queued_before < max_batch_messages);
+  REQUIRE(!queued_after_publish.empty());
+  // Nothing is written until the batch is full, and then all of it is
+  for (std::size_t i = 0; i + 1 < queued_after_publish.size(); ++i) {
+    REQUIRE(queued_after_publish[i] == queued_before + i + 1);
+  }
+  REQUIRE(queued_after_publish.back() == 0);
+  // The manager wakes up for the batch deadline rather than the next heartbeat
+  REQUIRE(last_received_at >= last_published_at + batch_delay + latency);
+  REQUIRE(last_received_at <= last_published_at + batch_delay + 4 * latency);
+}
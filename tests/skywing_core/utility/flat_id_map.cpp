@@ -0,0 +1,62 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/utility/flat_id_map.hpp"
+
+#include <string>
+
+using namespace skywing::internal;
+
+TEST_CASE("Flat ID maps insert, find, and erase", "[Skywing_FlatIdMap]")
+{
+  FlatIdMap<std::string> map;
+  REQUIRE(map.find(0) == map.end());
+  REQUIRE(map.try_emplace(3, "three").second);
+  REQUIRE(!map.try_emplace(3, "again").second);
+  map[7] = "seven";
+  REQUIRE(map.size() == 2);
+  REQUIRE(map.find(3)->second == "three");
+  REQUIRE(map.find(7)->second == "seven");
+  REQUIRE(map.erase(3) == 1);
+  REQUIRE(map.erase(3) == 0);
+  REQUIRE(map.find(3) == map.end());
+  REQUIRE(map.size() == 1);
+  // The reserved keys are never found
+  REQUIRE(map.find(FlatIdMap<std::string>::empty_key) == map.end());
+  REQUIRE(map.find(FlatIdMap<std::string>::erased_key) == map.end());
+}
+
+TEST_CASE("Flat ID maps can be erased from while iterating", "[Skywing_FlatIdMap]")
+{
+  FlatIdMap<int> map;
+  for (std::uint32_t i = 0; i < 100; ++i) {
+    map[i] = static_cast<int>(i);
+  }
+  for (auto iter = map.begin(); iter != map.end();) {
+    if (iter->second % 2 == 0) { iter = map.erase(iter); }
+    else {
+      ++iter;
+    }
+  }
+  REQUIRE(map.size() == 50);
+  int count = 0;
+  for (const auto& [key, value] : map) {
+    REQUIRE(key % 2 == 1);
+    REQUIRE(value == static_cast<int>(key));
+    ++count;
+  }
+  REQUIRE(count == 50);
+}
+
+TEST_CASE("Flat ID maps reuse erased slots", "[Skywing_FlatIdMap]")
+{
+  FlatIdMap<int> map;
+  // Churning through keys shouldn't lose any or leave the table full of erased slots
+  for (std::uint32_t i = 0; i < 10000; ++i) {
+    map[i] = 1;
+    if (i >= 10) { REQUIRE(map.erase(i - 10) == 1); }
+  }
+  REQUIRE(map.size() == 10);
+  for (std::uint32_t i = 9990; i < 10000; ++i) {
+    REQUIRE(map.find(i) != map.end());
+  }
+}
@@ -0,0 +1,120 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/utility/frame_compression.hpp"
+#include "skywing_core/internal/utility/network_conv.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+using namespace skywing;
+using namespace skywing::internal;
+
+namespace {
+// Words that are mostly zero, like the pointers and small integers in most messages
+std::vector<std::byte> make_sparse_frame(const std::size_t num_words)
+{
+  std::vector<std::byte> frame(frame_header_size + num_words * 8);
+  const auto size_bytes = to_network_bytes(static_cast<NetworkSizeType>(num_words * 8));
+  std::memcpy(frame.data(), size_bytes.data(), size_bytes.size());
+  for (std::size_t i = 0; i < num_words; ++i) {
+    // Leave runs of zero words in between
+    if (i % 7 < 3) { frame[frame_header_size + i * 8] = static_cast<std::byte>(i % 251 + 1); }
+  }
+  return frame;
+}
+
+// Words with no zero bytes, which packing can't shrink
+std::vector<std::byte> make_dense_frame(const std::size_t num_words)
+{
+  std::vector<std::byte> frame(frame_header_size + num_words * 8);
+  const auto size_bytes = to_network_bytes(static_cast<NetworkSizeType>(num_words * 8));
+  std::memcpy(frame.data(), size_bytes.data(), size_bytes.size());
+  std::uint32_t state = 12345;
+  for (std::size_t i = frame_header_size; i < frame.size(); ++i) {
+    state = state * 1103515245 + 12345;
+    frame[i] = static_cast<std::byte>((state >> 16) % 255 + 1);
+  }
+  return frame;
+}
+
+gsl::span<const std::byte> payload_of(const std::vector<std::byte>& frame)
+{
+  return gsl::span<const std::byte>{frame}.subspan(frame_header_size);
+}
+
+bool matches(const std::vector<std::uint64_t>& message, const std::vector<std::byte>& frame)
+{
+  return message.size() * 8 + frame_header_size == frame.size()
+      && std::memcmp(message.data(), frame.data() + frame_header_size, message.size() * 8) == 0;
+}
+} // namespace
+
+TEST_CASE("Packed frames are smaller and decompress to the original", "[Skywing_FrameCompression]")
+{
+  const auto frame = make_sparse_frame(1000);
+  const auto compressed = compress_frame(frame, wire_feature::packed);
+  REQUIRE(compressed);
+  REQUIRE(compressed->size() < frame.size());
+  REQUIRE(compressed->size() % 8 == 0);
+  REQUIRE(frame_flags(*compressed) == frame_flag::packed);
+  std::array<std::byte, sizeof(NetworkSizeType)> size_bytes;
+  std::memcpy(size_bytes.data(), compressed->data(), size_bytes.size());
+  REQUIRE(from_network_bytes(size_bytes) + frame_header_size == compressed->size());
+
+  std::vector<std::uint64_t> message;
+  REQUIRE(decompress_payload(payload_of(*compressed), frame_flags(*compressed), message));
+  REQUIRE(matches(message, frame));
+}
+
+TEST_CASE("Frames are only compressed when it helps", "[Skywing_FrameCompression]")
+{
+  const auto frame = make_sparse_frame(100);
+  REQUIRE(!compress_frame(frame, wire_feature::raw_arrays | wire_feature::shared_memory));
+  REQUIRE(!compress_frame(make_dense_frame(100), wire_feature::packed));
+  REQUIRE(frame_flags(frame) == 0);
+}
+
+TEST_CASE("Every supported compression method round trips", "[Skywing_FrameCompression]")
+{
+  // Each method on its own, then together, with the flags each should set
+  std::vector<std::pair<WireFeatures, std::uint8_t>> methods{{wire_feature::packed, frame_flag::packed}};
+#ifdef SKYWING_HAVE_LZ4
+  methods.emplace_back(wire_feature::lz4, frame_flag::lz4);
+  methods.emplace_back(wire_feature::packed | wire_feature::lz4, frame_flag::packed | frame_flag::lz4);
+#endif
+  for (const auto& [features, flags] : methods) {
+    INFO("features " << static_cast<unsigned>(features));
+    // Too small for the size prefix to be made up for
+    REQUIRE(!compress_frame(make_sparse_frame(1), features));
+    for (const auto& frame : {make_sparse_frame(300), make_sparse_frame(5000)}) {
+      const auto compressed = compress_frame(frame, features);
+      REQUIRE(compressed);
+      REQUIRE(compressed->size() < frame.size());
+      REQUIRE(frame_flags(*compressed) == flags);
+      std::vector<std::uint64_t> message{1, 2, 3};
+      REQUIRE(decompress_payload(payload_of(*compressed), frame_flags(*compressed), message));
+      REQUIRE(matches(message, frame));
+    }
+  }
+}
+
+TEST_CASE("Malformed compressed payloads are rejected", "[Skywing_FrameCompression]")
+{
+  const auto frame = make_sparse_frame(1000);
+  auto compressed = *compress_frame(frame, wire_feature::packed);
+  std::vector<std::uint64_t> message;
+  const auto payload = payload_of(compressed);
+  // Cut short
+  REQUIRE(!decompress_payload(payload.subspan(0, payload.size() / 2), frame_flag::packed, message));
+  REQUIRE(!decompress_payload(payload.subspan(0, 8), frame_flag::packed, message));
+  // Unknown flags
+  REQUIRE(!decompress_payload(payload, 0x80, message));
+  // Claims to be bigger than it is
+  const auto size_bytes = to_network_bytes(static_cast<NetworkSizeType>(frame.size()));
+  std::memcpy(compressed.data() + frame_header_size, size_bytes.data(), size_bytes.size());
+  REQUIRE(!decompress_payload(payload_of(compressed), frame_flag::packed, message));
+}
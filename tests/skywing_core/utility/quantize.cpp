@@ -0,0 +1,71 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/utility/quantize.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace skywing;
+using namespace skywing::internal;
+
+TEST_CASE("Half precision conversions round trip", "[Skywing_Quantize]")
+{
+  // Every half other than NaN converts to a float and back unchanged
+  for (std::uint32_t bits = 0; bits <= 0xffff; ++bits) {
+    const auto half = static_cast<std::uint16_t>(bits);
+    const auto value = from_float16(half);
+    if (std::isnan(value)) { continue; }
+    REQUIRE(to_float16(value) == half);
+  }
+  REQUIRE(from_float16(to_float16(65504.0f)) == 65504.0f);
+  REQUIRE(std::isinf(from_float16(to_float16(70000.0f))));
+  REQUIRE(std::isnan(from_float16(to_float16(std::numeric_limits<float>::quiet_NaN()))));
+  REQUIRE(from_bfloat16(to_bfloat16(-2.5f)) == -2.5f);
+  REQUIRE(std::isnan(from_bfloat16(to_bfloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST_CASE("Quantized vectors expand to within the precision of the encoding", "[Skywing_Quantize]")
+{
+  std::vector<double> values;
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(std::sin(i * 0.01) * 10.0);
+  }
+  const std::pair<Quantization, double> encodings[]
+    = {{Quantization::float16, 1e-2}, {Quantization::bfloat16, 1e-1}, {Quantization::scaled_int8, 1e-1},
+       {Quantization::scaled_int16, 1e-3}};
+  for (const auto& [quantization, tolerance] : encodings) {
+    const auto encoded = quantize(values, quantization);
+    REQUIRE(encoded);
+    REQUIRE(encoded->data.size() == values.size() * quantized_element_size(quantization));
+    std::vector<double> decoded;
+    REQUIRE(dequantize(encoded->data, quantization, encoded->scale, encoded->offset, decoded));
+    REQUIRE(decoded.size() == values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      REQUIRE(std::abs(decoded[i] - values[i]) <= tolerance);
+    }
+  }
+}
+
+TEST_CASE("Encodings refuse values they can't represent", "[Skywing_Quantize]")
+{
+  const std::vector<float> with_infinity{1.0f, std::numeric_limits<float>::infinity()};
+  REQUIRE(!quantize(with_infinity, Quantization::scaled_int8));
+  REQUIRE(!quantize(with_infinity, Quantization::none));
+  REQUIRE(quantize(with_infinity, Quantization::float16));
+  // Finite values too large for the encoding are sent exactly instead of as infinities
+  REQUIRE(!quantize(std::vector<float>{1.0f, 1e6f}, Quantization::float16));
+  REQUIRE(!quantize(std::vector<double>{1e300}, Quantization::bfloat16));
+  REQUIRE(quantize(std::vector<double>{1e30}, Quantization::bfloat16));
+
+  const std::vector<float> constant(10, 2.0f);
+  const auto encoded = quantize(constant, Quantization::scaled_int16);
+  REQUIRE(encoded);
+  std::vector<float> decoded;
+  REQUIRE(dequantize(encoded->data, Quantization::scaled_int16, encoded->scale, encoded->offset, decoded));
+  REQUIRE(decoded == constant);
+  // Not a whole number of elements
+  const auto partial = gsl::span<const std::byte>{encoded->data}.subspan(1);
+  REQUIRE(!dequantize(partial, Quantization::scaled_int16, 0.0, 0.0, decoded));
+}
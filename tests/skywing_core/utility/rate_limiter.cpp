@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/utility/rate_limiter.hpp"
+
+#include <chrono>
+
+using namespace skywing;
+using namespace skywing::internal;
+using namespace std::chrono_literals;
+
+TEST_CASE("Token buckets refill at their rate", "[Skywing_RateLimiter]")
+{
+  const std::chrono::steady_clock::time_point start{};
+  TokenBucket bucket{100.0, 10.0, start};
+  REQUIRE(bucket.available(start));
+  REQUIRE(bucket.utilization(start) == 0.0);
+
+  // Spending more than there is goes into debt that has to be paid off first
+  bucket.spend(15.0, start);
+  REQUIRE(!bucket.available(start));
+  REQUIRE(bucket.utilization(start) == 1.0);
+  const auto next = bucket.next_available(start);
+  REQUIRE(next > start + 50ms);
+  REQUIRE(next < start + 51ms);
+  REQUIRE(!bucket.available(start + 50ms));
+  REQUIRE(bucket.available(next));
+
+  // Never builds up past its capacity
+  REQUIRE(bucket.utilization(start + 10s) == 0.0);
+  bucket.spend(10.0, start + 10s);
+  REQUIRE(!bucket.available(start + 10s));
+
+  TokenBucket unlimited;
+  unlimited.spend(1e9, start);
+  REQUIRE(unlimited.available(start));
+  REQUIRE(unlimited.next_available(start) == start);
+}
+
+TEST_CASE("Rate limiters limit both bytes and messages", "[Skywing_RateLimiter]")
+{
+  const std::chrono::steady_clock::time_point start{};
+  RateLimiter by_messages{RateLimit{0.0, 10.0, 100ms}, start};
+  // The burst is less than one message but one still has to fit
+  REQUIRE(by_messages.can_send(start));
+  by_messages.record_send(1'000'000, start);
+  REQUIRE(!by_messages.can_send(start));
+  REQUIRE(by_messages.can_send(start + 101ms));
+
+  RateLimiter by_bytes{RateLimit{1000.0, 0.0, 1s}, start};
+  by_bytes.record_send(600, start);
+  REQUIRE(by_bytes.can_send(start));
+  by_bytes.record_send(600, start);
+  REQUIRE(!by_bytes.can_send(start));
+  by_bytes.record_throttled();
+  REQUIRE(by_bytes.next_available(start) > start + 200ms);
+
+  const auto stats = by_bytes.stats(start);
+  REQUIRE(stats.messages_sent == 2);
+  REQUIRE(stats.bytes_sent == 1200);
+  REQUIRE(stats.times_throttled == 1);
+  REQUIRE(stats.byte_utilization == 1.0);
+  REQUIRE(stats.message_utilization == 0.0);
+
+  RateLimiter unlimited;
+  unlimited.record_send(1'000'000, start);
+  REQUIRE(unlimited.can_send(start));
+}
@@ -0,0 +1,35 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/utility/symbol_table.hpp"
+
+#include <string>
+
+using namespace skywing::internal;
+
+TEST_CASE("Symbol tables give each string one symbol", "[Skywing_SymbolTable]")
+{
+  SymbolTable table;
+  REQUIRE(table.find("tag") == SymbolTable::no_symbol);
+  const auto tag = table.intern("tag");
+  const auto other = table.intern("other");
+  REQUIRE(tag == 0);
+  REQUIRE(other == 1);
+  REQUIRE(table.intern(std::string{"tag"}) == tag);
+  REQUIRE(table.find("other") == other);
+  REQUIRE(table.name(tag) == "tag");
+  REQUIRE(table.size() == 2);
+}
+
+TEST_CASE("Symbol tables keep their symbols as they grow", "[Skywing_SymbolTable]")
+{
+  SymbolTable table;
+  for (int i = 0; i < 1000; ++i) {
+    REQUIRE(table.intern("tag" + std::to_string(i)) == static_cast<SymbolTable::Symbol>(i));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    const auto name = "tag" + std::to_string(i);
+    REQUIRE(table.find(name) == static_cast<SymbolTable::Symbol>(i));
+    REQUIRE(table.name(i) == name);
+  }
+  REQUIRE(table.find("tag1000") == SymbolTable::no_symbol);
+}
@@ -0,0 +1,52 @@
+#include <catch2/catch.hpp>
+
+#include "skywing_core/internal/utility/tick_arena.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace skywing::internal;
+
+TEST_CASE("Tick arenas reuse their buffer after a reset", "[Skywing_TickArena]")
+{
+  TickArena arena{1024};
+  void* first = arena.resource()->allocate(100);
+  void* second = arena.resource()->allocate(100);
+  REQUIRE(first != second);
+  // Freeing doesn't give anything back until the reset
+  arena.resource()->deallocate(second, 100);
+  REQUIRE(arena.resource()->allocate(100) != second);
+  REQUIRE(arena.overflow_bytes() == 0);
+
+  arena.reset();
+  REQUIRE(arena.resource()->allocate(100) == first);
+  REQUIRE(arena.capacity() == 1024);
+}
+
+TEST_CASE("Tick arenas grow to fit what overflowed", "[Skywing_TickArena]")
+{
+  TickArena arena{1024};
+  {
+    std::pmr::vector<std::uint64_t> values{arena.resource()};
+    values.resize(1000);
+    REQUIRE(arena.overflow_bytes() >= 1000 * sizeof(std::uint64_t));
+  }
+  arena.reset();
+  REQUIRE(arena.overflow_bytes() == 0);
+  REQUIRE(arena.capacity() >= 1024 + 1000 * sizeof(std::uint64_t));
+
+  // The same amount now fits
+  std::pmr::vector<std::uint64_t> values{arena.resource()};
+  values.resize(1000);
+  REQUIRE(arena.overflow_bytes() == 0);
+}
+
+TEST_CASE("Tick arenas don't grow past the maximum", "[Skywing_TickArena]")
+{
+  TickArena arena{TickArena::max_capacity};
+  REQUIRE(arena.resource()->allocate(TickArena::max_capacity + 1) != nullptr);
+  REQUIRE(arena.overflow_bytes() > 0);
+  arena.reset();
+  REQUIRE(arena.capacity() == TickArena::max_capacity);
+  REQUIRE(arena.overflow_bytes() == 0);
+}
@@ -3,6 +3,8 @@
 #include "skywing_core/enable_logging.hpp"
 #include "skywing_mid/pubsub_converter.hpp"
 
+#include <array>
+
 using namespace skywing;
 
   struct Colin { std::int32_t age; };
@@ -27,6 +29,9 @@ using namespace skywing;
   };
 
 
+  struct PlainState { double x; std::int32_t n; std::array<float, 3> v; };
+
+
 TEST_CASE("PubSub Converter", "[Skywing_PubSubConverter]")
 {
   using myVec_t = std::vector<Colin>;
@@ -92,3 +97,35 @@ TEST_CASE("PubSub Converter", "[Skywing_PubSubConverter]")
   
 }
 
+TEST_CASE("PubSub Converter sends trivially copyable structs as bytes", "[Skywing_PubSubConverter]")
+{
+  using bytes_t = std::tuple<std::uint64_t, std::vector<std::byte>>;
+  static_assert(std::is_same_v<PubSub_t<PlainState>, bytes_t>);
+  static_assert(std::is_same_v<PubSub_t<std::vector<PlainState>>, bytes_t>);
+  // Types with their own converter keep using it
+  static_assert(std::is_same_v<PubSub_t<std::vector<Colin>>, std::vector<std::int32_t>>);
+
+  const PlainState state{1.5, 3, {1.0f, 2.0f, 3.0f}};
+  bytes_t ps = PubSubConverter<PlainState>::convert(state);
+  REQUIRE(std::get<1>(ps).size() == sizeof(PlainState));
+  const PlainState rs = PubSubConverter<PlainState>::deconvert(ps);
+  REQUIRE(rs.x == 1.5);
+  REQUIRE(rs.n == 3);
+  REQUIRE(rs.v == state.v);
+
+  const std::vector<PlainState> states{state, PlainState{2.5, 4, {4.0f, 5.0f, 6.0f}}};
+  bytes_t vps = PubSubConverter<std::vector<PlainState>>::convert(states);
+  REQUIRE(std::get<0>(vps) == std::get<0>(ps));
+  REQUIRE(std::get<1>(vps).size() == 2 * sizeof(PlainState));
+  const std::vector<PlainState> rvs = PubSubConverter<std::vector<PlainState>>::deconvert(vps);
+  REQUIRE(rvs.size() == 2);
+  REQUIRE(rvs[1].x == 2.5);
+  REQUIRE(rvs[1].n == 4);
+  REQUIRE(rvs[1].v == states[1].v);
+
+  // The layout hash and size are checked
+  std::get<0>(ps) ^= 1;
+  REQUIRE_THROWS_AS(PubSubConverter<PlainState>::deconvert(ps), std::runtime_error);
+  std::get<1>(vps).pop_back();
+  REQUIRE_THROWS_AS(PubSubConverter<std::vector<PlainState>>::deconvert(vps), std::runtime_error);
+}